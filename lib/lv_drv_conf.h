@@ -23,4 +23,14 @@
 #ifndef USE_KEYBOARD
 # define USE_KEYBOARD 1
 #endif
+
+/* Táctil del panel para el backend DRM (src/hal/hal_drm.c) */
+#ifndef USE_EVDEV
+# define USE_EVDEV 0
+#endif
+#if USE_EVDEV
+    #define EVDEV_NAME      "/dev/input/event0"
+    #define EVDEV_SWAP_AXES 0
+    #define EVDEV_CALIBRATE 0
+#endif
 #endif
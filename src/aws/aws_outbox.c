@@ -0,0 +1,327 @@
+#include "aws_outbox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "../logger/logger.h"
+
+static pthread_mutex_t outbox_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static char outbox_dir[128] = OUTBOX_DIR;
+static unsigned int seg_primero = 0;   // Segmento más viejo en disco
+static unsigned int seg_activo = 0;    // Segmento donde se escribe
+static int fd_activo = -1;
+static long bytes_activo = 0;
+static long bytes_total = 0;
+
+static OutboxCursor cursor = {0, 0};
+
+// fsync agrupado
+static int sin_sync = 0;
+static struct timespec primer_sin_sync;
+
+// --------------------------------------------------------------------------
+// Helpers
+// --------------------------------------------------------------------------
+static void ruta_segmento(unsigned int seg, char *out, size_t cap) {
+    snprintf(out, cap, "%s/%08u.seg", outbox_dir, seg);
+}
+
+static long tam_archivo(const char *ruta) {
+    struct stat st;
+    if (stat(ruta, &st) != 0) return -1;
+    return (long)st.st_size;
+}
+
+static long ms_desde(const struct timespec *t0) {
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (ahora.tv_sec - t0->tv_sec) * 1000L + (ahora.tv_nsec - t0->tv_nsec) / 1000000L;
+}
+
+static void guardar_cursor(void) {
+    char ruta[160], tmp[168];
+    snprintf(ruta, sizeof(ruta), "%s/cursor", outbox_dir);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ruta);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    char linea[64];
+    int n = snprintf(linea, sizeof(linea), "%u %ld\n", cursor.segmento, cursor.offset);
+    if (write(fd, linea, n) == n) fsync(fd);
+    close(fd);
+    rename(tmp, ruta); // Atómico: nunca queda un cursor a medias
+}
+
+static void cargar_cursor(void) {
+    char ruta[160];
+    snprintf(ruta, sizeof(ruta), "%s/cursor", outbox_dir);
+    cursor.segmento = 0;
+    cursor.offset = 0;
+    FILE *f = fopen(ruta, "r");
+    if (!f) return;
+    if (fscanf(f, "%u %ld", &cursor.segmento, &cursor.offset) != 2) {
+        cursor.segmento = 0;
+        cursor.offset = 0;
+    }
+    fclose(f);
+}
+
+static int abrir_segmento_nuevo(void) {
+    if (fd_activo >= 0) {
+        fsync(fd_activo);
+        close(fd_activo);
+    }
+    seg_activo++;
+    char ruta[160];
+    ruta_segmento(seg_activo, ruta, sizeof(ruta));
+    fd_activo = open(ruta, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    bytes_activo = 0;
+    sin_sync = 0;
+    if (fd_activo < 0) {
+        printf("[OUTBOX ERROR] No se pudo crear %s: %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    if (seg_primero == 0) seg_primero = seg_activo;
+    return 0;
+}
+
+// Borra el segmento más viejo (ya enviado o por falta de espacio)
+static void borrar_segmento_viejo(void) {
+    if (seg_primero == 0 || seg_primero >= seg_activo) return;
+    char ruta[160];
+    ruta_segmento(seg_primero, ruta, sizeof(ruta));
+    long tam = tam_archivo(ruta);
+    unlink(ruta);
+    if (tam > 0) bytes_total -= tam;
+    seg_primero++;
+    if (cursor.segmento < seg_primero) {
+        cursor.segmento = seg_primero;
+        cursor.offset = 0;
+    }
+}
+
+// El cursor tiene que caer en lo que hay en disco: uno más nuevo que el
+// último segmento (directorio restaurado de un backup, cursor de otra
+// instalación) haría que outbox_commit borre segmentos sin enviar. Ante la
+// duda se reenvía desde el principio: el servidor ya tolera duplicados.
+static void validar_cursor(void) {
+    OutboxCursor leido = cursor;
+    if (seg_primero == 0) {
+        cursor.segmento = 0;            // Nada en disco
+        cursor.offset = 0;
+    } else if (cursor.segmento < seg_primero || cursor.segmento > seg_activo) {
+        cursor.segmento = seg_primero;
+        cursor.offset = 0;
+    } else if (cursor.offset < 0) {
+        cursor.offset = 0;
+    } else {
+        char ruta[160];
+        ruta_segmento(cursor.segmento, ruta, sizeof(ruta));
+        long tam = tam_archivo(ruta);
+        if (tam >= 0 && cursor.offset > tam) cursor.offset = 0;
+    }
+
+    if (leido.segmento != 0 && (leido.segmento != cursor.segmento || leido.offset != cursor.offset)) {
+        char msg[160];
+        snprintf(msg, sizeof(msg), "Cursor %u:%ld fuera de los segmentos en disco (%u..%u), se reenvia desde %u:%ld",
+                 leido.segmento, leido.offset, seg_primero, seg_activo, cursor.segmento, cursor.offset);
+        logger_log("AWS", msg);
+    }
+}
+
+// --------------------------------------------------------------------------
+// API
+// --------------------------------------------------------------------------
+int outbox_init(const char *dir) {
+    pthread_mutex_lock(&outbox_mutex);
+    if (dir) snprintf(outbox_dir, sizeof(outbox_dir), "%s", dir);
+    mkdir(outbox_dir, 0755);
+
+    DIR *d = opendir(outbox_dir);
+    if (!d) {
+        printf("[OUTBOX ERROR] No se pudo abrir '%s'\n", outbox_dir);
+        pthread_mutex_unlock(&outbox_mutex);
+        return -1;
+    }
+
+    // Descubrir los segmentos existentes (de una sesión anterior)
+    seg_primero = 0;
+    seg_activo = 0;
+    bytes_total = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        unsigned int seg;
+        char ext[8];
+        if (sscanf(e->d_name, "%8u.%3s", &seg, ext) == 2 && strcmp(ext, "seg") == 0) {
+            char ruta[160];
+            ruta_segmento(seg, ruta, sizeof(ruta));
+            long tam = tam_archivo(ruta);
+            if (tam > 0) bytes_total += tam;
+            if (seg_primero == 0 || seg < seg_primero) seg_primero = seg;
+            if (seg > seg_activo) seg_activo = seg;
+        }
+    }
+    closedir(d);
+
+    cargar_cursor();
+    validar_cursor();
+
+    // Siempre se escribe en un segmento nuevo: si el anterior quedó con una
+    // línea cortada por un apagón, el lector simplemente la ignora.
+    int ret = abrir_segmento_nuevo();
+    if (cursor.segmento == 0) cursor.segmento = seg_primero;
+
+    if (bytes_total > 0) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "Outbox en disco: %ld bytes de la sesion anterior", bytes_total);
+        logger_log("AWS", msg);
+    }
+    pthread_mutex_unlock(&outbox_mutex);
+    return ret;
+}
+
+int outbox_append(const char *registro) {
+    char linea[OUTBOX_RECORD_MAX + 1];
+    int n = snprintf(linea, sizeof(linea), "%s\n", registro);
+    if (n <= 1 || n >= (int)sizeof(linea)) return -1;
+
+    pthread_mutex_lock(&outbox_mutex);
+
+    if (fd_activo < 0 || bytes_activo + n > OUTBOX_SEGMENT_MAX) {
+        if (abrir_segmento_nuevo() != 0) {
+            pthread_mutex_unlock(&outbox_mutex);
+            return -1;
+        }
+    }
+
+    if (write(fd_activo, linea, n) != n) {
+        pthread_mutex_unlock(&outbox_mutex);
+        return -1;
+    }
+    bytes_activo += n;
+    bytes_total += n;
+
+    if (sin_sync == 0) clock_gettime(CLOCK_MONOTONIC, &primer_sin_sync);
+    sin_sync++;
+    if (sin_sync >= OUTBOX_FSYNC_BATCH) {
+        fdatasync(fd_activo);
+        sin_sync = 0;
+    }
+
+    // Límite de disco: se sacrifica lo más viejo, nunca lo nuevo
+    while (bytes_total > OUTBOX_MAX_BYTES && seg_primero < seg_activo) {
+        printf("[OUTBOX] Limite alcanzado, descartando segmento %u\n", seg_primero);
+        borrar_segmento_viejo();
+        guardar_cursor();
+    }
+
+    pthread_mutex_unlock(&outbox_mutex);
+    return 0;
+}
+
+void outbox_tick(void) {
+    pthread_mutex_lock(&outbox_mutex);
+    if (sin_sync > 0 && fd_activo >= 0 && ms_desde(&primer_sin_sync) >= OUTBOX_FSYNC_MS) {
+        fdatasync(fd_activo);
+        sin_sync = 0;
+    }
+    pthread_mutex_unlock(&outbox_mutex);
+}
+
+int outbox_peek_batch(char *buf, size_t cap, int max_registros, OutboxCursor *siguiente) {
+    if (!buf || cap < 3 || !siguiente) return 0;
+
+    pthread_mutex_lock(&outbox_mutex);
+
+    // Saltar segmentos ya leídos por completo
+    OutboxCursor pos = cursor;
+    char ruta[160];
+    while (pos.segmento < seg_activo) {
+        ruta_segmento(pos.segmento, ruta, sizeof(ruta));
+        long tam = tam_archivo(ruta);
+        if (tam > pos.offset) break;
+        pos.segmento++;
+        pos.offset = 0;
+    }
+
+    // El segmento activo puede tener datos sin fsync; el kernel igual los ve
+    ruta_segmento(pos.segmento, ruta, sizeof(ruta));
+    FILE *f = fopen(ruta, "r");
+    if (!f) {
+        *siguiente = pos;
+        pthread_mutex_unlock(&outbox_mutex);
+        return 0;
+    }
+    fseek(f, pos.offset, SEEK_SET);
+
+    size_t usado = 0;
+    buf[usado++] = '[';
+    int n = 0;
+    char linea[OUTBOX_RECORD_MAX + 2];
+
+    while (n < max_registros && fgets(linea, sizeof(linea), f)) {
+        size_t len = strlen(linea);
+        if (len == 0 || linea[len - 1] != '\n') break; // Línea cortada (apagón): se ignora
+        len--;
+        if (usado + len + 2 >= cap) break;             // No cabe: va en el próximo lote
+        if (n > 0) buf[usado++] = ',';
+        memcpy(buf + usado, linea, len);
+        usado += len;
+        pos.offset += (long)len + 1;
+        n++;
+    }
+    fclose(f);
+
+    buf[usado++] = ']';
+    buf[usado] = '\0';
+
+    // Segmento viejo que solo tiene una cola cortada: se da por consumido
+    if (n == 0 && pos.segmento < seg_activo) {
+        pos.segmento++;
+        pos.offset = 0;
+    }
+    *siguiente = pos;
+
+    pthread_mutex_unlock(&outbox_mutex);
+    return n;
+}
+
+int outbox_peek(char *registro, size_t cap, OutboxCursor *siguiente) {
+    if (!registro || cap == 0) return 0;
+    registro[0] = '\0';
+    char lote[OUTBOX_RECORD_MAX + 4];
+    if (outbox_peek_batch(lote, sizeof(lote), 1, siguiente) == 0) return 0;
+
+    size_t len = strlen(lote) - 2;      // Sin '[' y ']'
+    if (len >= cap) return 0;
+    memcpy(registro, lote + 1, len);
+    registro[len] = '\0';
+    return 1;
+}
+
+void outbox_commit(const OutboxCursor *siguiente) {
+    if (!siguiente) return;
+    pthread_mutex_lock(&outbox_mutex);
+    cursor = *siguiente;
+
+    // Borrar los segmentos que el servidor ya tiene completos (el activo nunca)
+    while (seg_primero != 0 && seg_primero < cursor.segmento && seg_primero < seg_activo) {
+        borrar_segmento_viejo();
+    }
+    guardar_cursor();
+    pthread_mutex_unlock(&outbox_mutex);
+}
+
+long outbox_bytes(void) {
+    pthread_mutex_lock(&outbox_mutex);
+    long b = bytes_total;
+    pthread_mutex_unlock(&outbox_mutex);
+    return b;
+}
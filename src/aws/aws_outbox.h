@@ -0,0 +1,74 @@
+#ifndef AWS_OUTBOX_H
+#define AWS_OUTBOX_H
+
+#include <stddef.h>
+
+// --- BUZÓN DE SALIDA EN DISCO (store-and-forward) ---
+// Los reportes para la nube se escriben primero aquí y un hilo los reenvía
+// en orden cuando hay conexión. Es un log append-only partido en segmentos:
+//   outbox/00000001.seg, outbox/00000002.seg, ...
+// Cada registro es una línea JSON terminada en '\n'. El archivo 'cursor'
+// guarda hasta dónde confirmó el servidor.
+
+#define OUTBOX_DIR            "outbox"
+#define OUTBOX_SEGMENT_MAX    (256 * 1024)        // Tamaño para rotar de segmento
+#define OUTBOX_MAX_BYTES      (16 * 1024 * 1024)  // Límite total; se borra lo más viejo
+#define OUTBOX_RECORD_MAX     512                 // Máximo por registro (una línea)
+#define OUTBOX_FSYNC_BATCH    32                  // fsync cada N registros...
+#define OUTBOX_FSYNC_MS       500                 // ...o cada N ms, lo que ocurra primero
+
+// Posición dentro del log (segmento + byte)
+typedef struct {
+    unsigned int segmento;
+    long offset;
+} OutboxCursor;
+
+/**
+ * @brief Abre (o crea) el buzón en el directorio indicado y recupera el cursor.
+ * @return 0 si está listo, -1 si no se pudo usar el directorio.
+ */
+int outbox_init(const char *dir);
+
+/**
+ * @brief Agrega un registro (una línea JSON sin '\n') al final del log.
+ * No hace fsync inmediato: se agrupa según OUTBOX_FSYNC_BATCH/OUTBOX_FSYNC_MS.
+ * @return 0 si se escribió, -1 si hubo error de E/S.
+ */
+int outbox_append(const char *registro);
+
+/**
+ * @brief Hace fsync si hay registros pendientes y ya toca por tiempo o cantidad.
+ * Llamar periódicamente desde el hilo dueño del buzón.
+ */
+void outbox_tick(void);
+
+/**
+ * @brief Arma un lote JSON "[r1,r2,...]" con hasta max_registros desde el cursor.
+ * @param buf Buffer de salida.
+ * @param cap Capacidad del buffer.
+ * @param max_registros Máximo de registros en el lote.
+ * @param siguiente Posición a confirmar con outbox_commit() si el envío sale bien.
+ * @return Cantidad de registros en el lote (0 si no hay nada pendiente).
+ */
+int outbox_peek_batch(char *buf, size_t cap, int max_registros, OutboxCursor *siguiente);
+
+/**
+ * @brief Un solo registro desde el cursor, tal cual se guardó (sin corchetes).
+ * @param registro Buffer de salida (OUTBOX_RECORD_MAX alcanza).
+ * @param siguiente Posición a confirmar con outbox_commit() si el envío sale bien.
+ * @return 1 si hay registro, 0 si no hay nada pendiente.
+ */
+int outbox_peek(char *registro, size_t cap, OutboxCursor *siguiente);
+
+/**
+ * @brief Confirma que el servidor recibió todo hasta 'siguiente'.
+ * Persiste el cursor y borra los segmentos ya consumidos.
+ */
+void outbox_commit(const OutboxCursor *siguiente);
+
+/**
+ * @brief Bytes que siguen en disco (pendientes o no borrados aún).
+ */
+long outbox_bytes(void);
+
+#endif
@@ -1,8 +1,10 @@
 #include "aws_service.h"
+#include "aws_outbox.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include <curl/curl.h>
 #include "../logger/logger.h"
 #include "../mqtt/mqtt_service.h" // Necesitamos acceso al estado global
@@ -12,68 +14,155 @@ extern pthread_mutex_t state_mutex;
 
 static int force_update_flag = 0;
 
+// Última versión de cada máquina que quedó guardada en el buzón de salida.
+// Solo la toca el hilo AWS, no necesita mutex.
+static unsigned int version_reportada[MAX_MAQUINAS];
+
 void aws_trigger_update(void) {
     force_update_flag = 1;
 }
 
-// Función para enviar el estado de una máquina
-void reportar_maquina(int id, const char* estado) {
-    CURL *curl;
-    CURLcode res;
-
-    curl = curl_easy_init();
-    if(curl) {
-        char json_data[128];
-        // Construir JSON: {"id": 1, "estado": "TRABAJANDO"}
-        snprintf(json_data, sizeof(json_data), "{\"id\": %d, \"estado\": \"%s\"}", id, estado);
-
-        struct curl_slist *headers = NULL;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-
-        curl_easy_setopt(curl, CURLOPT_URL, AWS_ENDPOINT_STATUS);
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 2L); // Timeout corto
-
-        // Enviar
-        res = curl_easy_perform(curl);
-
-        if(res != CURLE_OK) {
-            // printf("[AWS ERROR] No se pudo reportar estado M%d: %s\n", id, curl_easy_strerror(res));
-        } else {
-            // printf("[AWS] Estado M%d -> %s reportado.\n", id, estado);
-        }
+// Guarda el estado de una máquina en el buzón de salida.
+// El envío real lo hace drenar_outbox(), así un corte de internet no pierde datos.
+// Devuelve 1 si quedó guardado, 0 si no.
+int reportar_maquina(const MaquinaData *m) {
+    char json_data[256];
+    // Construir JSON: {"id": 1, "estado": "TRABAJANDO", "ip": "...", "pos": [x, y, z], "ts": ...}
+    snprintf(json_data, sizeof(json_data),
+             "{\"id\": %d, \"estado\": \"%s\", \"ip\": \"%s\", \"pos\": [%.3f, %.3f, %.3f], \"ts\": %ld}",
+             m->id, m->estado, m->ip, m->pos_x, m->pos_y, m->pos_z, (long)time(NULL));
+
+    return outbox_append(json_data) == 0;
+}
+
+// POST de un reporte al endpoint de estado de la máquina.
+// Devuelve 1 si el servidor confirmó (HTTP 2xx), 0 si no.
+static int enviar_reporte(CURL *curl, const char *json, size_t len) {
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, AWS_ENDPOINT_STATUS);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)len);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 2L);
 
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+    CURLcode res = curl_easy_perform(curl);
+    long http_code = 0;
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    }
+    curl_slist_free_all(headers);
+
+    return (res == CURLE_OK && http_code >= 200 && http_code < 300);
+}
+
+// Vacía el buzón en orden mientras el servidor responda, hasta
+// AWS_REENVIO_MAX reportes por llamada. El cursor avanza con cada reporte
+// confirmado: un corte a mitad del reenvío no repite lo que ya llegó.
+// Devuelve 1 si todo salió bien (o no había nada), 0 si falló un envío.
+static int drenar_outbox(CURL *curl) {
+    char registro[OUTBOX_RECORD_MAX];
+    OutboxCursor siguiente;
+    for (int i = 0; i < AWS_REENVIO_MAX; i++) {
+        if (!outbox_peek(registro, sizeof(registro), &siguiente)) {
+            // Puede que el lector solo haya saltado segmentos vacíos/cortados
+            outbox_commit(&siguiente);
+            return 1;
+        }
+        if (!enviar_reporte(curl, registro, strlen(registro))) {
+            return 0;
+        }
+        outbox_commit(&siguiente);
     }
+    return 1;
 }
 
 void* thread_aws_loop(void* arg) {
     printf("[AWS] Hilo de Nube Iniciado.\n");
-    curl_global_init(CURL_GLOBAL_ALL);
+    outbox_init(OUTBOX_DIR);
+
+    // Un solo handle reutilizado: mantiene la conexión HTTP viva entre reportes
+    CURL *curl = curl_easy_init();
+
+    time_t ultimo_heartbeat = 0;
+    long backoff_ms = 0;            // 0 = sin fallos pendientes
+    long espera_reintento_ms = 0;
+    int sin_conexion = 0;
 
     while(1) {
         // Dormir pero revisar el flag de forzado cada 100ms
         for(int i=0; i < AWS_STATUS_INTERVAL * 10; i++) {
+            outbox_tick();
             if (force_update_flag) {
                 force_update_flag = 0;
                 break;
             }
             usleep(100000);
+            if (espera_reintento_ms > 0) espera_reintento_ms -= 100;
         }
 
-        // Reportar estado de TODAS las máquinas activas
+        // Heartbeat: cada AWS_HEARTBEAT_INTERVAL se manda todo aunque no haya cambios
+        time_t ahora = time(NULL);
+        int heartbeat = (ahora - ultimo_heartbeat >= AWS_HEARTBEAT_INTERVAL);
+
+        // Copiar solo las máquinas sucias y soltar el mutex antes de tocar disco/red,
+        // así un servidor lento no bloquea la UI ni el hilo MQTT.
+        // El slot de global_state es la clave de version_reportada, también al guardar
+        MaquinaData pendientes[MAX_MAQUINAS];
+        int slot[MAX_MAQUINAS];
+        int n = 0;
+
         pthread_mutex_lock(&state_mutex);
         for(int i=0; i < MAX_MAQUINAS; i++) {
-            if (global_state.maquinas[i].activa) {
-                reportar_maquina(global_state.maquinas[i].id, global_state.maquinas[i].estado);
+            MaquinaData *m = &global_state.maquinas[i];
+            // Una máquina que pasó a OFFLINE se reporta una vez (subió la versión)
+            if ((m->activa && heartbeat) || m->version != version_reportada[i]) {
+                slot[n] = i;
+                pendientes[n] = *m;
+                pendientes[n].id = i + 1;
+                n++;
             }
         }
         pthread_mutex_unlock(&state_mutex);
+
+        int fallos = 0;
+        for(int i=0; i < n; i++) {
+            if (reportar_maquina(&pendientes[i])) {
+                // Guardamos la versión que se encoló, no la actual: si cambió
+                // mientras tanto, se vuelve a mandar en el siguiente ciclo.
+                version_reportada[slot[i]] = pendientes[i].version;
+            } else {
+                fallos++;
+            }
+        }
+        if (heartbeat && fallos == 0) {
+            ultimo_heartbeat = ahora;
+        }
+
+        // Reenvío con backoff exponencial mientras no haya internet
+        if (curl && espera_reintento_ms <= 0) {
+            if (drenar_outbox(curl)) {
+                if (sin_conexion) {
+                    logger_log("AWS", "Conexion con la nube restablecida, buzon reenviado");
+                    sin_conexion = 0;
+                }
+                backoff_ms = 0;
+            } else {
+                if (!sin_conexion) {
+                    logger_log("AWS", "Nube inalcanzable, guardando reportes en el buzon");
+                    sin_conexion = 1;
+                }
+                backoff_ms = (backoff_ms == 0) ? AWS_BACKOFF_MIN_MS : backoff_ms * 2;
+                if (backoff_ms > AWS_BACKOFF_MAX_MS) backoff_ms = AWS_BACKOFF_MAX_MS;
+                espera_reintento_ms = backoff_ms;
+            }
+        }
     }
 
-    curl_global_cleanup();
+    if (curl) curl_easy_cleanup(curl);
     return NULL;
 }
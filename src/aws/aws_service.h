@@ -6,9 +6,21 @@
 // Asegúrate de cambiar la IP por la IP pública de tu servidor EC2
 #define AWS_ENDPOINT_STATUS "http://54.123.45.67:3000/api/maquina/estado"
 
+// Reenvío del buzón de salida (outbox) cuando vuelve la conexión: cada
+// reporte va a AWS_ENDPOINT_STATUS, de a uno y en orden
+#define AWS_REENVIO_MAX         200   // Reportes por ciclo, así el hilo vuelve a encolar
+#define AWS_BACKOFF_MIN_MS      1000  // Primer reintento tras un fallo
+#define AWS_BACKOFF_MAX_MS      60000 // Tope del backoff exponencial
+
 // Intervalo de reporte de estado en segundos (ej: cada 5 segundos)
+// En cada ciclo solo se encolan las máquinas que cambiaron desde el último
+// reporte guardado en el buzón de salida (ver aws_outbox.h).
 #define AWS_STATUS_INTERVAL 5
 
+// Cada cuántos segundos se manda el estado COMPLETO de todas las máquinas
+// activas aunque no hayan cambiado (heartbeat para el servidor).
+#define AWS_HEARTBEAT_INTERVAL 60
+
 // --- FUNCIONES PÚBLICAS ---
 void* thread_aws_loop(void* arg);
 void aws_trigger_update(void); // Forzar actualización inmediata
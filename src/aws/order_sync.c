@@ -0,0 +1,649 @@
+#include "order_sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <curl/curl.h>
+#include <json-c/json.h>
+#include "../logger/logger.h"
+#include "../files/sha256.h"
+
+// Lista publicada. El mutex solo se toma para copiar la estructura.
+static OrdenesSnapshot publicado;
+static pthread_mutex_t sync_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static volatile int trigger_flag = 0;
+
+// Validadores de la última respuesta 200 (para la petición condicional)
+static char etag[128] = "";
+static long last_modified = -1;
+
+// --------------------------------------------------------------------------
+// API pública
+// --------------------------------------------------------------------------
+void order_sync_trigger(void) {
+    trigger_flag = 1;
+}
+
+void order_sync_get(OrdenesSnapshot *out) {
+    if (!out) return;
+    pthread_mutex_lock(&sync_mutex);
+    *out = publicado;
+    pthread_mutex_unlock(&sync_mutex);
+}
+
+unsigned int order_sync_version(void) {
+    pthread_mutex_lock(&sync_mutex);
+    unsigned int v = publicado.version;
+    pthread_mutex_unlock(&sync_mutex);
+    return v;
+}
+
+int order_sync_db_ok(void) {
+    pthread_mutex_lock(&sync_mutex);
+    int ok = publicado.db_ok;
+    pthread_mutex_unlock(&sync_mutex);
+    return ok;
+}
+
+static void publicar_estado_db(int ok) {
+    pthread_mutex_lock(&sync_mutex);
+    publicado.db_ok = ok;
+    if (ok) publicado.ultima_sync = time(NULL);
+    pthread_mutex_unlock(&sync_mutex);
+}
+
+// --------------------------------------------------------------------------
+// Helpers HTTP
+// --------------------------------------------------------------------------
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} BufferHttp;
+
+static size_t escribir_buffer(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    BufferHttp *b = (BufferHttp*)userdata;
+    size_t n = size * nmemb;
+    if (b->len + n + 1 > b->cap) {
+        size_t nueva = b->cap ? b->cap * 2 : 4096;
+        while (nueva < b->len + n + 1) nueva *= 2;
+        char *p = realloc(b->data, nueva);
+        if (!p) return 0; // curl aborta la transferencia
+        b->data = p;
+        b->cap = nueva;
+    }
+    memcpy(b->data + b->len, ptr, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+    return n;
+}
+
+// Captura el ETag de la respuesta
+static size_t leer_cabecera(char *linea, size_t size, size_t nitems, void *userdata) {
+    size_t n = size * nitems;
+    char *destino = (char*)userdata;
+    if (n > 5 && strncasecmp(linea, "ETag:", 5) == 0) {
+        const char *v = linea + 5;
+        while (*v == ' ') v++;
+        size_t len = n - (size_t)(v - linea);
+        while (len > 0 && (v[len - 1] == '\r' || v[len - 1] == '\n')) len--;
+        if (len >= 128) len = 127;
+        memcpy(destino, v, len);
+        destino[len] = '\0';
+    }
+    return n;
+}
+
+// Reemplaza caracteres inválidos para nombres de archivo (igual que el script Python)
+static void limpiar_nombre(const char *in, char *out, size_t cap) {
+    size_t i = 0;
+    for (; in[i] && i < cap - 1; i++) {
+        char c = in[i];
+        out[i] = (isalnum((unsigned char)c) || c == '_' || c == '.' || c == '-') ? c : '_';
+    }
+    out[i] = '\0';
+}
+
+static void copiar_json_str(struct json_object *obj, const char *clave, char *out, size_t cap) {
+    struct json_object *val;
+    out[0] = '\0';
+    if (json_object_object_get_ex(obj, clave, &val) && json_object_get_string(val)) {
+        snprintf(out, cap, "%s", json_object_get_string(val));
+    }
+}
+
+static int parsear_ordenes(const char *json, OrdenesSnapshot *out) {
+    struct json_object *raiz = json_tokener_parse(json);
+    if (!raiz || !json_object_is_type(raiz, json_type_array)) {
+        if (raiz) json_object_put(raiz);
+        return -1;
+    }
+
+    out->count = 0;
+    int total = json_object_array_length(raiz);
+    for (int i = 0; i < total && out->count < MAX_ORDENES; i++) {
+        struct json_object *o = json_object_array_get_idx(raiz, i);
+        struct json_object *val;
+        Orden *ord = &out->ordenes[out->count];
+        memset(ord, 0, sizeof(*ord));
+
+        if (json_object_object_get_ex(o, "id", &val)) ord->id = json_object_get_int(val);
+        if (json_object_object_get_ex(o, "cantidad", &val)) ord->cantidad = json_object_get_int(val);
+        copiar_json_str(o, "producto", ord->producto, sizeof(ord->producto));
+        copiar_json_str(o, "maquina", ord->maquina, sizeof(ord->maquina));
+
+        // Opcionales: si el servidor los manda, la descarga se verifica contra ellos
+        if (json_object_object_get_ex(o, "archivo_tamano", &val)) ord->tamano = (long)json_object_get_int64(val);
+        copiar_json_str(o, "archivo_sha256", ord->sha256, sizeof(ord->sha256));
+
+        char crudo[256];
+        copiar_json_str(o, "archivo_nombre", crudo, sizeof(crudo));
+        if (crudo[0] == '\0') snprintf(crudo, sizeof(crudo), "sin_nombre.gcode");
+        limpiar_nombre(crudo, ord->archivo_nombre, sizeof(ord->archivo_nombre));
+
+        out->count++;
+    }
+
+    json_object_put(raiz);
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+// Consulta condicional de la lista
+// Devuelve 200 si llegó una lista nueva, 304 si no cambió, -1 si falló.
+// --------------------------------------------------------------------------
+static int consultar_lista(CURL *curl, OrdenesSnapshot *nueva) {
+    BufferHttp cuerpo = {0};
+    char etag_nuevo[128] = "";
+    struct curl_slist *headers = NULL;
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, ORDER_SYNC_API_LISTA);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, escribir_buffer);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &cuerpo);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, leer_cabecera);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, etag_nuevo);
+    curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, ""); // gzip si el servidor lo ofrece
+
+    if (etag[0]) {
+        char h[160];
+        snprintf(h, sizeof(h), "If-None-Match: %s", etag);
+        headers = curl_slist_append(headers, h);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    if (last_modified > 0) {
+        curl_easy_setopt(curl, CURLOPT_TIMECONDITION, (long)CURL_TIMECOND_IFMODSINCE);
+        curl_easy_setopt(curl, CURLOPT_TIMEVALUE, last_modified);
+    }
+
+    CURLcode res = curl_easy_perform(curl);
+    long http_code = 0;
+    long unmet = 0;
+    int ret = -1;
+
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        curl_easy_getinfo(curl, CURLINFO_CONDITION_UNMET, &unmet);
+
+        if (http_code == 304 || unmet) {
+            ret = 304;
+        } else if (http_code == 200 && cuerpo.data && parsear_ordenes(cuerpo.data, nueva) == 0) {
+            snprintf(etag, sizeof(etag), "%s", etag_nuevo);
+            long ft = -1;
+            curl_easy_getinfo(curl, CURLINFO_FILETIME, &ft);
+            last_modified = ft;
+            ret = 200;
+        } else {
+            printf("[SYNC ERROR] Respuesta inválida del servidor (HTTP %ld)\n", http_code);
+        }
+    } else {
+        printf("[SYNC ERROR] %s\n", curl_easy_strerror(res));
+    }
+
+    if (headers) curl_slist_free_all(headers);
+    free(cuerpo.data);
+    return ret;
+}
+
+// --------------------------------------------------------------------------
+// Descargas paralelas y reanudables
+// Cada archivo baja a gcode_files/.<nombre>.part (fm_scan_directory ignora los
+// ocultos). Si la descarga se corta, la próxima pasada pide solo lo que falta
+// con un Range (e If-Range con el ETag del .part, para no pegar dos versiones);
+// al terminar se verifica tamaño y SHA-256 y se renombra.
+//
+// Junto a cada archivo queda un manifiesto .<nombre>.meta con lo que se
+// instaló (tamaño, mtime, hash y ETag). Un archivo que ya está en disco se
+// vuelve a bajar si no coincide con el tamaño o el hash de la orden; si el
+// servidor no manda ninguno de los dos, cuando cambia la lista se revalida con
+// If-None-Match contra el ETag guardado.
+// --------------------------------------------------------------------------
+typedef struct {
+    FILE *f;
+    char ruta[300];         // Destino final
+    char ruta_part[300];    // Archivo temporal
+    int id_orden;
+    long offset_inicio;     // Bytes que ya había de un intento anterior
+    long tamano_esperado;   // -1 si el servidor no lo informa
+    char sha256[SHA256_HEX_LEN];  // Vacío si no hay hash para comparar
+    char etag[128];         // ETag de la respuesta (o el del .part al reanudar)
+    int condicional;        // If-None-Match: el archivo local puede seguir al día
+    struct curl_slist *headers;
+    int respuesta_revisada;
+    long http_code;
+} Descarga;
+
+typedef struct {
+    long tamano;
+    long mtime;
+    char sha256[SHA256_HEX_LEN];    // "" si no se calculó
+    char etag[128];                 // "" si el servidor no lo mandó
+} Manifiesto;
+
+static long tam_archivo(const char *ruta) {
+    struct stat st;
+    if (stat(ruta, &st) != 0) return -1;
+    return (long)st.st_size;
+}
+
+// gcode_files/<nombre> -> gcode_files/.<nombre><sufijo>
+static void ruta_oculta(const char *nombre, const char *sufijo, char *out, size_t cap) {
+    snprintf(out, cap, "%s/.%s%s", GCODE_DIR, nombre, sufijo);
+}
+
+static int leer_manifiesto(const char *ruta, Manifiesto *m) {
+    memset(m, 0, sizeof(*m));
+    FILE *f = fopen(ruta, "r");
+    if (!f) return -1;
+    char sha[SHA256_HEX_LEN], et[128];
+    int n = fscanf(f, "%ld %ld %64s %127s", &m->tamano, &m->mtime, sha, et);
+    fclose(f);
+    if (n != 4) return -1;
+    if (strcmp(sha, "-") != 0) snprintf(m->sha256, sizeof(m->sha256), "%s", sha);
+    if (strcmp(et, "-") != 0) snprintf(m->etag, sizeof(m->etag), "%s", et);
+    return 0;
+}
+
+// Temporal + rename, como los G-code
+static void escribir_manifiesto(const char *ruta, const Manifiesto *m) {
+    char tmp[320];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ruta);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return;
+    fprintf(f, "%ld %ld %s %s\n", m->tamano, m->mtime,
+            m->sha256[0] ? m->sha256 : "-", m->etag[0] ? m->etag : "-");
+    if (fclose(f) != 0 || rename(tmp, ruta) != 0) unlink(tmp);
+}
+
+// Anota cómo quedó en disco el archivo recién instalado
+static void manifiesto_instalado(const char *nombre, const char *ruta, const char *sha256, const char *etag) {
+    struct stat st;
+    if (stat(ruta, &st) != 0) return;
+    Manifiesto m = { .tamano = (long)st.st_size, .mtime = (long)st.st_mtime };
+    snprintf(m.sha256, sizeof(m.sha256), "%s", sha256);
+    snprintf(m.etag, sizeof(m.etag), "%s", etag);
+    char meta[300];
+    ruta_oculta(nombre, ".meta", meta, sizeof(meta));
+    escribir_manifiesto(meta, &m);
+}
+
+// 0 = al día, 1 = hay que bajarlo, 2 = preguntarle al servidor (condicional)
+static int revisar_local(const Orden *o, int revalidar) {
+    char ruta[300], meta[300];
+    snprintf(ruta, sizeof(ruta), "%s/%s", GCODE_DIR, o->archivo_nombre);
+    ruta_oculta(o->archivo_nombre, ".meta", meta, sizeof(meta));
+
+    struct stat st;
+    if (stat(ruta, &st) != 0) return 1;
+    if (o->tamano > 0 && (long)st.st_size != o->tamano) return 1;
+
+    Manifiesto m;
+    int hay_meta = leer_manifiesto(meta, &m) == 0;
+    // Si lo tocaron a mano desde que se instaló, lo guardado ya no vale
+    int vigente = hay_meta && m.tamano == (long)st.st_size && m.mtime == (long)st.st_mtime;
+
+    if (o->sha256[0]) {
+        if (!vigente || !m.sha256[0]) {
+            // Una sola vez por archivo: el hash queda en el manifiesto
+            char hex[SHA256_HEX_LEN];
+            if (sha256_archivo(ruta, hex) != 0) return 1;
+            manifiesto_instalado(o->archivo_nombre, ruta, hex, hay_meta ? m.etag : "");
+            snprintf(m.sha256, sizeof(m.sha256), "%s", hex);
+        }
+        return strcasecmp(m.sha256, o->sha256) == 0 ? 0 : 1;
+    }
+    if (o->tamano > 0) return 0;
+
+    // Nada con qué comparar: solo el servidor sabe si cambió
+    if (!revalidar) return 0;
+    return (vigente && m.etag[0]) ? 2 : 1;
+}
+
+static int orden_es_mia(const Orden *o) {
+    return ORDER_SYNC_MI_MAQUINA[0] == '\0' || strcmp(o->maquina, ORDER_SYNC_MI_MAQUINA) == 0;
+}
+
+// Escribe al .part. En el primer bloque revisa si el servidor respetó el Range.
+static size_t escribir_part(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    Descarga *d = (Descarga*)userdata;
+    size_t n = size * nmemb;
+
+    if (!d->respuesta_revisada) {
+        d->respuesta_revisada = 1;
+        if (d->http_code == 200 && d->offset_inicio > 0) {
+            // El servidor ignoró el Range y manda todo: empezar de cero
+            fflush(d->f);
+            if (ftruncate(fileno(d->f), 0) != 0) return 0;
+            fseek(d->f, 0, SEEK_SET);
+            d->offset_inicio = 0;
+        } else if (d->http_code != 200 && d->http_code != 206) {
+            return 0; // Error HTTP: abortar sin tocar lo ya descargado
+        }
+    }
+    return fwrite(ptr, 1, n, d->f);
+}
+
+// Toma el código HTTP y el hash que el servidor pueda mandar en cabeceras
+static size_t cabecera_descarga(char *linea, size_t size, size_t nitems, void *userdata) {
+    Descarga *d = (Descarga*)userdata;
+    size_t n = size * nitems;
+    long code;
+
+    if (n > 5 && strncmp(linea, "HTTP/", 5) == 0) {
+        const char *sp = strchr(linea, ' ');
+        if (sp && sscanf(sp, "%ld", &code) == 1) d->http_code = code;
+    } else if (n > 5 && strncasecmp(linea, "ETag:", 5) == 0) {
+        leer_cabecera(linea, size, nitems, d->etag);
+    } else if (n > 18 && strncasecmp(linea, "X-Checksum-Sha256:", 18) == 0 && d->sha256[0] == '\0') {
+        const char *v = linea + 18;
+        while (*v == ' ') v++;
+        size_t len = 0;
+        while (len < 64 && isxdigit((unsigned char)v[len])) len++;
+        if (len == 64) {
+            for (size_t i = 0; i < 64; i++) d->sha256[i] = (char)tolower((unsigned char)v[i]);
+            d->sha256[64] = '\0';
+        }
+    }
+    return n;
+}
+
+static CURL* iniciar_descarga(const Orden *o, Descarga *d, int condicional) {
+    memset(d, 0, sizeof(*d));
+    snprintf(d->ruta, sizeof(d->ruta), "%s/%s", GCODE_DIR, o->archivo_nombre);
+    ruta_oculta(o->archivo_nombre, ".part", d->ruta_part, sizeof(d->ruta_part));
+    d->id_orden = o->id;
+    d->tamano_esperado = o->tamano > 0 ? o->tamano : -1;
+    snprintf(d->sha256, sizeof(d->sha256), "%s", o->sha256);
+
+    // Reanudar si quedó un .part de un intento anterior
+    d->offset_inicio = tam_archivo(d->ruta_part);
+    if (d->offset_inicio < 0) d->offset_inicio = 0;
+
+    char meta[300];
+    Manifiesto m;
+    if (d->offset_inicio > 0) {
+        // If-Range: si el archivo cambió desde el corte, el servidor manda todo
+        ruta_oculta(o->archivo_nombre, ".part.meta", meta, sizeof(meta));
+        if (leer_manifiesto(meta, &m) == 0 && m.etag[0]) {
+            char h[160];
+            snprintf(h, sizeof(h), "If-Range: %s", m.etag);
+            d->headers = curl_slist_append(d->headers, h);
+            snprintf(d->etag, sizeof(d->etag), "%s", m.etag);
+        }
+    } else if (condicional) {
+        ruta_oculta(o->archivo_nombre, ".meta", meta, sizeof(meta));
+        if (leer_manifiesto(meta, &m) == 0 && m.etag[0]) {
+            char h[160];
+            snprintf(h, sizeof(h), "If-None-Match: %s", m.etag);
+            d->headers = curl_slist_append(d->headers, h);
+            d->condicional = 1;
+        }
+    }
+
+    d->f = fopen(d->ruta_part, "ab");
+    if (!d->f) {
+        printf("[SYNC ERROR] No se pudo crear %s\n", d->ruta_part);
+        return NULL;
+    }
+
+    char url[256];
+    snprintf(url, sizeof(url), ORDER_SYNC_API_ARCHIVO, o->id);
+
+    CURL *h = curl_easy_init();
+    if (!h) {
+        fclose(d->f);
+        if (d->headers) curl_slist_free_all(d->headers);
+        return NULL;
+    }
+    // Se escribe directo al archivo a medida que llega (memoria acotada)
+    curl_easy_setopt(h, CURLOPT_URL, url);
+    curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, escribir_part);
+    curl_easy_setopt(h, CURLOPT_WRITEDATA, d);
+    curl_easy_setopt(h, CURLOPT_HEADERFUNCTION, cabecera_descarga);
+    curl_easy_setopt(h, CURLOPT_HEADERDATA, d);
+    curl_easy_setopt(h, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(h, CURLOPT_LOW_SPEED_LIMIT, 1L);   // Abortar si se cuelga
+    curl_easy_setopt(h, CURLOPT_LOW_SPEED_TIME, 30L);
+    curl_easy_setopt(h, CURLOPT_BUFFERSIZE, 64L * 1024L);
+    if (d->headers) curl_easy_setopt(h, CURLOPT_HTTPHEADER, d->headers);
+    if (d->offset_inicio > 0) {
+        curl_easy_setopt(h, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)d->offset_inicio);
+    }
+    curl_easy_setopt(h, CURLOPT_PRIVATE, d);
+    return h;
+}
+
+// Verifica el .part y lo mueve a su nombre final. Devuelve 1 si quedó listo,
+// 2 si el local seguía al día (304), 0 si hay que reintentar, -1 si estaba
+// corrupto.
+static int finalizar_descarga(CURL *h, Descarga *d, CURLcode res) {
+    fflush(d->f);
+    fsync(fileno(d->f));
+    fclose(d->f);
+    d->f = NULL;
+    if (d->headers) {
+        curl_slist_free_all(d->headers);
+        d->headers = NULL;
+    }
+
+    const char *nombre = d->ruta + strlen(GCODE_DIR) + 1;
+    char meta_part[300];
+    ruta_oculta(nombre, ".part.meta", meta_part, sizeof(meta_part));
+
+    if (res == CURLE_OK && d->condicional && d->http_code == 304) {
+        unlink(d->ruta_part);   // Quedó vacío: no cambió nada
+        return 2;
+    }
+
+    // 416 = pedimos desde el final: el .part ya estaba completo
+    int rango_completo = (d->http_code == 416 && d->offset_inicio > 0);
+    if (!rango_completo && (res != CURLE_OK || (d->http_code != 200 && d->http_code != 206))) {
+        if (d->http_code >= 400 && d->http_code < 500 && d->http_code != 416) {
+            unlink(d->ruta_part); // La orden ya no existe o no tiene archivo
+            unlink(meta_part);
+            return -1;
+        }
+        // Corte de red: el .part se conserva para reanudar, con su ETag
+        if (d->etag[0]) {
+            Manifiesto m = { .tamano = tam_archivo(d->ruta_part) };
+            snprintf(m.etag, sizeof(m.etag), "%s", d->etag);
+            escribir_manifiesto(meta_part, &m);
+        }
+        return 0;
+    }
+
+    if (d->tamano_esperado < 0 && !rango_completo) {
+        curl_off_t cl = -1;
+        curl_easy_getinfo(h, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &cl);
+        if (cl >= 0) d->tamano_esperado = d->offset_inicio + (long)cl;
+    }
+
+    long tam = tam_archivo(d->ruta_part);
+    if (d->tamano_esperado >= 0 && tam != d->tamano_esperado) {
+        printf("[SYNC ERROR] %s: tamaño %ld, esperado %ld\n", d->ruta, tam, d->tamano_esperado);
+        if (tam > d->tamano_esperado) {
+            unlink(d->ruta_part);
+            unlink(meta_part);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (d->sha256[0]) {
+        char hex[SHA256_HEX_LEN];
+        if (sha256_archivo(d->ruta_part, hex) != 0 || strcasecmp(hex, d->sha256) != 0) {
+            printf("[SYNC ERROR] %s: SHA-256 no coincide, se descarta\n", d->ruta);
+            unlink(d->ruta_part);
+            unlink(meta_part);
+            return -1;
+        }
+    }
+
+    // rename() es atómico: la UI nunca ve un G-code a medias
+    if (rename(d->ruta_part, d->ruta) != 0) {
+        printf("[SYNC ERROR] No se pudo renombrar %s\n", d->ruta_part);
+        return 0;
+    }
+    unlink(meta_part);
+    manifiesto_instalado(nombre, d->ruta, d->sha256, d->etag);
+    return 1;
+}
+
+// Devuelve cuántos archivos nuevos o cambiados quedaron en disco.
+// revalidar: la lista cambió, preguntar por los que no traen tamaño ni hash.
+static int descargar_nuevos(CURLM *multi, const OrdenesSnapshot *lista, int revalidar) {
+    const Orden *cola[MAX_ORDENES];
+    int condicional[MAX_ORDENES];
+    int n_cola = 0;
+
+    // Solo lo que falta o cambió en disco, sin repetir nombres
+    for (int i = 0; i < lista->count; i++) {
+        const Orden *o = &lista->ordenes[i];
+        if (!orden_es_mia(o)) continue;
+
+        int repetido = 0;
+        for (int j = 0; j < n_cola; j++) {
+            if (strcmp(cola[j]->archivo_nombre, o->archivo_nombre) == 0) { repetido = 1; break; }
+        }
+        if (repetido) continue;
+
+        int r = revisar_local(o, revalidar);
+        if (r == 0) continue;
+        condicional[n_cola] = (r == 2);
+        cola[n_cola++] = o;
+    }
+    if (n_cola == 0) return 0;
+
+    mkdir(GCODE_DIR, 0755);
+
+    static Descarga descargas[MAX_ORDENES];
+    int siguiente = 0, activas = 0, completas = 0;
+
+    while (siguiente < n_cola || activas > 0) {
+        // Llenar hasta el máximo de descargas simultáneas
+        while (activas < ORDER_SYNC_DESCARGAS_PARALELAS && siguiente < n_cola) {
+            CURL *h = iniciar_descarga(cola[siguiente], &descargas[siguiente], condicional[siguiente]);
+            if (h) {
+                // La revalidación condicional es de rutina: sin log
+                if (descargas[siguiente].offset_inicio > 0) {
+                    printf("[SYNC] Reanudando: %s desde %ld bytes\n",
+                           cola[siguiente]->archivo_nombre, descargas[siguiente].offset_inicio);
+                } else if (!descargas[siguiente].condicional) {
+                    printf("[SYNC] Descargando: %s\n", cola[siguiente]->archivo_nombre);
+                }
+                curl_multi_add_handle(multi, h);
+                activas++;
+            }
+            siguiente++;
+        }
+
+        int corriendo = 0;
+        curl_multi_perform(multi, &corriendo);
+        curl_multi_poll(multi, NULL, 0, 500, NULL);
+
+        CURLMsg *msg;
+        int pendientes;
+        while ((msg = curl_multi_info_read(multi, &pendientes))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            Descarga *d = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&d);
+
+            int r = finalizar_descarga(msg->easy_handle, d, msg->data.result);
+            char log_msg[350];
+            if (r == 1) {
+                snprintf(log_msg, sizeof(log_msg), "Orden %d descargada: %s", d->id_orden, d->ruta);
+                logger_log("SYNC", log_msg);
+                completas++;
+            } else if (r != 2) {    // 2: seguía al día
+                snprintf(log_msg, sizeof(log_msg), "Fallo descarga orden %d (%s, HTTP %ld)%s",
+                         d->id_orden, curl_easy_strerror(msg->data.result), d->http_code,
+                         r == 0 ? ", se reanudara" : "");
+                logger_log("SYNC", log_msg);
+            }
+            curl_multi_remove_handle(multi, msg->easy_handle);
+            curl_easy_cleanup(msg->easy_handle);
+            activas--;
+        }
+    }
+    return completas;
+}
+
+// --------------------------------------------------------------------------
+// Hilo principal
+// --------------------------------------------------------------------------
+void* thread_order_sync_loop(void* arg) {
+    printf("[SYNC] Hilo de sincronización de órdenes iniciado.\n");
+
+    CURL *curl = curl_easy_init();
+    CURLM *multi = curl_multi_init();
+    static OrdenesSnapshot nueva;
+
+    while (1) {
+        int r = curl ? consultar_lista(curl, &nueva) : -1;
+
+        if (r == 200) {
+            pthread_mutex_lock(&sync_mutex);
+            // Si el servidor no soporta ETag puede mandar la misma lista: no molestar a la UI
+            int cambio = nueva.count != publicado.count ||
+                         memcmp(nueva.ordenes, publicado.ordenes, sizeof(Orden) * nueva.count) != 0;
+            nueva.db_ok = 1;
+            nueva.ultima_sync = time(NULL);
+            nueva.version = publicado.version + (cambio ? 1 : 0);
+            publicado = nueva;
+            pthread_mutex_unlock(&sync_mutex);
+            if (cambio) printf("[SYNC] %d órdenes recibidas.\n", nueva.count);
+        } else {
+            publicar_estado_db(r == 304);
+        }
+
+        // Con 304 igual se revisa: puede faltar un archivo que falló antes o
+        // no coincidir con el tamaño/hash de su orden
+        if (r != -1 && multi) {
+            OrdenesSnapshot actual;
+            order_sync_get(&actual);
+            if (descargar_nuevos(multi, &actual, r == 200) > 0) {
+                // Archivos nuevos en gcode_files/: avisar a la UI
+                pthread_mutex_lock(&sync_mutex);
+                publicado.version++;
+                pthread_mutex_unlock(&sync_mutex);
+            }
+        }
+
+        // Esperar el intervalo, despertando antes si la UI lo pide
+        for (int i = 0; i < ORDER_SYNC_INTERVAL * 10 && !trigger_flag; i++) {
+            usleep(100000);
+        }
+        trigger_flag = 0;
+    }
+
+    if (multi) curl_multi_cleanup(multi);
+    if (curl) curl_easy_cleanup(curl);
+    return NULL;
+}
@@ -0,0 +1,69 @@
+#ifndef ORDER_SYNC_H
+#define ORDER_SYNC_H
+
+#include <time.h>
+#include "../files/file_manager.h"
+#include "../files/sha256.h"
+
+// --- SINCRONIZACIÓN DE ÓRDENES (reemplaza a sync_cloud.py) ---
+// Hilo en segundo plano que consulta /api/ordenes con peticiones condicionales
+// (ETag / If-Modified-Since), descarga en paralelo solo los archivos nuevos o
+// que cambiaron y publica la lista en memoria para que la UI la lea sin
+// archivos temporales ni procesos externos.
+
+#define ORDER_SYNC_SERVER      "http://18.223.169.118:80"
+#define ORDER_SYNC_API_LISTA   ORDER_SYNC_SERVER "/api/ordenes"
+#define ORDER_SYNC_API_ARCHIVO ORDER_SYNC_SERVER "/api/orden/archivo/%d"
+
+// ID de esta máquina en el servidor (solo se descargan sus archivos).
+// Cadena vacía = descargar los archivos de todas las órdenes (el planificador
+// reparte toda la flota desde este HMI).
+#define ORDER_SYNC_MI_MAQUINA  ""
+
+#define ORDER_SYNC_INTERVAL            10  // Segundos entre consultas
+#define ORDER_SYNC_DESCARGAS_PARALELAS 4   // Descargas simultáneas (reanudables con Range)
+
+#define MAX_ORDENES 64
+
+typedef struct {
+    int id;
+    char producto[32];
+    int cantidad;
+    char maquina[16];                        // "cnc1", "cnc2"...
+    char archivo_nombre[MAX_FILENAME_LEN];   // Ya saneado para usar como nombre local
+    long tamano;                             // Bytes esperados (0 si el servidor no lo manda)
+    char sha256[SHA256_HEX_LEN];             // Hash esperado en hex ("" si no se conoce)
+} Orden;
+
+typedef struct {
+    Orden ordenes[MAX_ORDENES];
+    int count;
+    int db_ok;              // 1 si la última consulta al servidor respondió bien
+    unsigned int version;   // Cambia cada vez que se publica una lista nueva
+    time_t ultima_sync;     // Hora de la última respuesta válida (200 o 304)
+} OrdenesSnapshot;
+
+void* thread_order_sync_loop(void* arg);
+
+/**
+ * @brief Pide una sincronización inmediata (no bloquea).
+ */
+void order_sync_trigger(void);
+
+/**
+ * @brief Copia la última lista publicada.
+ * @param out Destino de la copia.
+ */
+void order_sync_get(OrdenesSnapshot *out);
+
+/**
+ * @brief Versión de la lista publicada (para saber si hay que refrescar la UI).
+ */
+unsigned int order_sync_version(void);
+
+/**
+ * @brief 1 si la última consulta al servidor salió bien, 0 si no.
+ */
+int order_sync_db_ok(void);
+
+#endif
@@ -39,16 +39,22 @@ def limpiar_nombre(nombre):
 def descargar_archivo(id_orden, ruta_guardado):
     """Descarga un archivo de la orden desde el servidor."""
     url_descarga = f"{SERVER_URL}/api/orden/archivo/{id_orden}"
+    ruta_temporal = ruta_guardado + ".part"
     try:
-        r = requests.get(url_descarga, stream=True)
+        r = requests.get(url_descarga, stream=True, timeout=10)
         if r.status_code == 200:
-            with open(ruta_guardado, "wb") as f:
-                f.write(r.content)
+            # Escribir por bloques: no cargar el archivo entero en memoria
+            with open(ruta_temporal, "wb") as f:
+                for bloque in r.iter_content(chunk_size=64 * 1024):
+                    f.write(bloque)
+            os.replace(ruta_temporal, ruta_guardado)
             print(f"      ✅ Descarga completada: {ruta_guardado}")
         else:
             print(f"      ❌ Falló la descarga. Status: {r.status_code}")
     except Exception as e:
         print(f"      ❌ Error escribiendo archivo: {e}")
+        if os.path.exists(ruta_temporal):
+            os.remove(ruta_temporal)
 
 # -------------------------------
 #   FUNCION PRINCIPAL: SINCRONIZAR Y DESCARGAR
@@ -2,60 +2,212 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
 #include <json-c/json.h>
+#include "../logger/logger.h"
 
-int config_load(const char *filename, MachinesConfigList *config)
+// A published list plus its reference count. Being current holds one
+// reference; every reader holds one between config_acquire() and
+// config_release(). Whoever drops the last one frees it.
+typedef struct {
+    MachinesConfigList list;        // First member: readers get &snapshot->list
+    atomic_int refs;
+} Snapshot;
+
+// Published snapshot: swapped atomically, readers never lock
+static _Atomic(Snapshot *) current_snapshot = NULL;
+static Snapshot empty_snapshot;
+static pthread_once_t loaded_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t publish_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Readers between loading current_snapshot and taking their reference
+static atomic_int acquiring = 0;
+
+void config_jog_default(JogProfile *jog)
 {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        printf("[CONFIG] File not found: %s\n", filename);
-        config->count = 0;
-        return -1;
+    memset(jog, 0, sizeof(*jog));
+    jog->steps[0] = 0.1f;
+    jog->steps[1] = 1.0f;
+    jog->steps[2] = 10.0f;
+    jog->step_count = 3;
+    jog->feed = JOG_DEFAULT_FEED;
+    jog->feed_min = JOG_DEFAULT_FEED_MIN;
+    jog->feed_max = JOG_DEFAULT_FEED_MAX;
+}
+
+// "jog": { "steps": [0.1, 1, 10], "feed": 7000, "feed_min": 100, "feed_max": 10000,
+//          "limits": { "x": [-300, 0], "y": [-300, 0], "z": [-80, 0] } }
+static void parse_jog_profile(struct json_object *jog_obj, JogProfile *jog)
+{
+    struct json_object *v;
+
+    if (json_object_object_get_ex(jog_obj, "steps", &v) && json_object_is_type(v, json_type_array)) {
+        int n = 0;
+        int len = json_object_array_length(v);
+        for (int i = 0; i < len && n < MAX_JOG_STEPS; i++) {
+            double step = json_object_get_double(json_object_array_get_idx(v, i));
+            if (step > 0) jog->steps[n++] = (float)step;
+        }
+        if (n > 0) jog->step_count = n;
+    }
+    if (json_object_object_get_ex(jog_obj, "feed_min", &v)) jog->feed_min = json_object_get_int(v);
+    if (json_object_object_get_ex(jog_obj, "feed_max", &v)) jog->feed_max = json_object_get_int(v);
+    if (json_object_object_get_ex(jog_obj, "feed", &v)) jog->feed = json_object_get_int(v);
+
+    if (jog->feed_min < 1) jog->feed_min = 1;
+    if (jog->feed_max < jog->feed_min) jog->feed_max = jog->feed_min;
+    if (jog->feed < jog->feed_min) jog->feed = jog->feed_min;
+    if (jog->feed > jog->feed_max) jog->feed = jog->feed_max;
+
+    struct json_object *limits;
+    if (json_object_object_get_ex(jog_obj, "limits", &limits)) {
+        static const char *axes[3] = { "x", "y", "z" };
+        for (int a = 0; a < 3; a++) {
+            // Axes without limits are unbounded
+            jog->limit_min[a] = -1e9f;
+            jog->limit_max[a] = 1e9f;
+            if (json_object_object_get_ex(limits, axes[a], &v) &&
+                json_object_is_type(v, json_type_array) && json_object_array_length(v) == 2) {
+                float lo = (float)json_object_get_double(json_object_array_get_idx(v, 0));
+                float hi = (float)json_object_get_double(json_object_array_get_idx(v, 1));
+                jog->limit_min[a] = lo < hi ? lo : hi;
+                jog->limit_max[a] = lo < hi ? hi : lo;
+                jog->has_limits = 1;
+            }
+        }
+    }
+}
+
+// { "x": 500, "y": 500, "z": 200 }
+static void parse_xyz(struct json_object *obj, float *out)
+{
+    static const char *axes[3] = { "x", "y", "z" };
+    struct json_object *v;
+    for (int a = 0; a < 3; a++) {
+        out[a] = json_object_object_get_ex(obj, axes[a], &v) ? (float)json_object_get_double(v) : 0.0f;
+    }
+}
+
+static struct json_object *xyz_to_json(const float *v)
+{
+    struct json_object *obj = json_object_new_object();
+    json_object_object_add(obj, "x", json_object_new_double(v[0]));
+    json_object_object_add(obj, "y", json_object_new_double(v[1]));
+    json_object_object_add(obj, "z", json_object_new_double(v[2]));
+    return obj;
+}
+
+// "host" or "host:port" (the port is the HTTP one)
+static void set_host(MachineConfig *m, const char *host)
+{
+    snprintf(m->host, sizeof(m->host), "%s", host);
+    char *colon = strrchr(m->host, ':');
+    if (colon && strchr(m->host, ':') == colon) {
+        int port = atoi(colon + 1);
+        if (port > 0 && port < 65536) {
+            *colon = '\0';
+            m->http_port = port;
+        }
     }
+}
+
+static void machine_defaults(MachineConfig *m, int id)
+{
+    memset(m, 0, sizeof(*m));
+    m->id = id;
+    snprintf(m->name, sizeof(m->name), "Maquina %d", id);
+    m->http_port = CONFIG_DEFAULT_HTTP_PORT;
+    m->ws_port = CONFIG_DEFAULT_WS_PORT;
+    config_jog_default(&m->jog);
+}
 
-    // Read file content
-    char buffer[4096];
-    size_t size = fread(buffer, 1, sizeof(buffer) - 1, f);
+// Whole file in memory, no size limit
+static char *read_file(const char *filename, size_t *size)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f) return NULL;
+
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0 || st.st_size <= 0) {
+        fclose(f);
+        return NULL;
+    }
+    char *buffer = malloc((size_t)st.st_size + 1);
+    if (!buffer) {
+        fclose(f);
+        return NULL;
+    }
+    *size = fread(buffer, 1, (size_t)st.st_size, f);
     fclose(f);
-    
-    if (size == 0) {
-        config->count = 0;
+    buffer[*size] = '\0';
+    return buffer;
+}
+
+int config_load(const char *filename, MachinesConfigList *config)
+{
+    config->count = 0;
+
+    size_t size = 0;
+    char *buffer = read_file(filename, &size);
+    if (!buffer) {
+        printf("[CONFIG] File not found: %s\n", filename);
         return -1;
     }
 
-    buffer[size] = '\0';
-
     // Parse JSON
-    struct json_object *parsed_json = json_tokener_parse(buffer);
+    struct json_tokener *tok = json_tokener_new();
+    struct json_object *parsed_json = tok ? json_tokener_parse_ex(tok, buffer, (int)size) : NULL;
+    if (tok) json_tokener_free(tok);
+    free(buffer);
     if (!parsed_json) {
         printf("[CONFIG] Failed to parse JSON\n");
-        config->count = 0;
         return -1;
     }
 
-    config->count = 0;
     struct json_object *machines_array;
     
     if (json_object_object_get_ex(parsed_json, "machines", &machines_array)) {
         int array_len = json_object_array_length(machines_array);
         
-        for (int i = 0; i < array_len && i < MAX_MACHINES; i++) {
+        for (int i = 0; i < array_len && config->count < MAX_MACHINES; i++) {
             struct json_object *machine_obj = json_object_array_get_idx(machines_array, i);
-            struct json_object *id_obj, *ip_obj;
-            
-            if (json_object_object_get_ex(machine_obj, "id", &id_obj) &&
-                json_object_object_get_ex(machine_obj, "ip", &ip_obj)) {
-                
-                int id = json_object_get_int(id_obj);
-                const char *ip = json_object_get_string(ip_obj);
-                
-                config->machines[config->count].id = id;
-                strncpy(config->machines[config->count].ip_address, ip, MAX_IP_LEN - 1);
-                config->machines[config->count].ip_address[MAX_IP_LEN - 1] = '\0';
-                
-                config->count++;
-                printf("[CONFIG] Loaded M%d: %s\n", id, ip);
+            struct json_object *id_obj, *host_obj, *v;
+
+            if (!json_object_object_get_ex(machine_obj, "id", &id_obj)) continue;
+            int id = json_object_get_int(id_obj);
+            if (id < 1 || id > MAX_MACHINES) {
+                printf("[CONFIG] Ignoring machine with invalid id %d\n", id);
+                continue;
             }
+
+            MachineConfig *m = &config->machines[config->count];
+            machine_defaults(m, id);
+
+            if (json_object_object_get_ex(machine_obj, "host", &host_obj) ||
+                json_object_object_get_ex(machine_obj, "ip", &host_obj)) {
+                set_host(m, json_object_get_string(host_obj));
+            }
+            if (json_object_object_get_ex(machine_obj, "name", &v)) {
+                snprintf(m->name, sizeof(m->name), "%s", json_object_get_string(v));
+            }
+            if (json_object_object_get_ex(machine_obj, "http_port", &v)) m->http_port = json_object_get_int(v);
+            // FluidNC serves the WebSocket on HTTP port + 1 unless told otherwise
+            m->ws_port = m->http_port + 1;
+            if (json_object_object_get_ex(machine_obj, "ws_port", &v)) m->ws_port = json_object_get_int(v);
+            if (json_object_object_get_ex(machine_obj, "jog", &v)) parse_jog_profile(v, &m->jog);
+            if (json_object_object_get_ex(machine_obj, "accel", &v)) parse_xyz(v, m->accel);
+            if (json_object_object_get_ex(machine_obj, "bed", &v)) parse_xyz(v, m->bed);
+
+            config->count++;
+            printf("[CONFIG] Loaded M%d: %s (%s:%d)\n", id, m->name, m->host, m->ws_port);
         }
     }
 
@@ -63,6 +215,33 @@ int config_load(const char *filename, MachinesConfigList *config)
     return 0;
 }
 
+static struct json_object *jog_profile_to_json(const JogProfile *jog)
+{
+    struct json_object *obj = json_object_new_object();
+    struct json_object *steps = json_object_new_array();
+    for (int i = 0; i < jog->step_count; i++) {
+        json_object_array_add(steps, json_object_new_double(jog->steps[i]));
+    }
+    json_object_object_add(obj, "steps", steps);
+    json_object_object_add(obj, "feed", json_object_new_int(jog->feed));
+    json_object_object_add(obj, "feed_min", json_object_new_int(jog->feed_min));
+    json_object_object_add(obj, "feed_max", json_object_new_int(jog->feed_max));
+
+    if (jog->has_limits) {
+        static const char *axes[3] = { "x", "y", "z" };
+        struct json_object *limits = json_object_new_object();
+        for (int a = 0; a < 3; a++) {
+            if (jog->limit_min[a] <= -1e9f && jog->limit_max[a] >= 1e9f) continue;
+            struct json_object *range = json_object_new_array();
+            json_object_array_add(range, json_object_new_double(jog->limit_min[a]));
+            json_object_array_add(range, json_object_new_double(jog->limit_max[a]));
+            json_object_object_add(limits, axes[a], range);
+        }
+        json_object_object_add(obj, "limits", limits);
+    }
+    return obj;
+}
+
 int config_save(const char *filename, MachinesConfigList *config)
 {
     struct json_object *root = json_object_new_object();
@@ -70,8 +249,15 @@ int config_save(const char *filename, MachinesConfigList *config)
 
     for (int i = 0; i < config->count; i++) {
         struct json_object *machine_obj = json_object_new_object();
-        json_object_object_add(machine_obj, "id", json_object_new_int(config->machines[i].id));
-        json_object_object_add(machine_obj, "ip", json_object_new_string(config->machines[i].ip_address));
+        const MachineConfig *m = &config->machines[i];
+        json_object_object_add(machine_obj, "id", json_object_new_int(m->id));
+        json_object_object_add(machine_obj, "name", json_object_new_string(m->name));
+        json_object_object_add(machine_obj, "host", json_object_new_string(m->host));
+        json_object_object_add(machine_obj, "http_port", json_object_new_int(m->http_port));
+        json_object_object_add(machine_obj, "ws_port", json_object_new_int(m->ws_port));
+        json_object_object_add(machine_obj, "jog", jog_profile_to_json(&m->jog));
+        json_object_object_add(machine_obj, "accel", xyz_to_json(m->accel));
+        json_object_object_add(machine_obj, "bed", xyz_to_json(m->bed));
         json_object_array_add(machines_array, machine_obj);
     }
 
@@ -98,23 +284,178 @@ int config_add_machine(MachinesConfigList *config, int id, const char *ip)
         return -1;
     }
 
-    config->machines[config->count].id = id;
-    strncpy(config->machines[config->count].ip_address, ip, MAX_IP_LEN - 1);
-    config->machines[config->count].ip_address[MAX_IP_LEN - 1] = '\0';
+    MachineConfig *m = &config->machines[config->count];
+    machine_defaults(m, id);
+    set_host(m, ip);
     config->count++;
 
     return 0;
 }
 
-const char* config_get_machine_ip(MachinesConfigList *config, int id)
+const MachineConfig *config_find(const MachinesConfigList *config, int id)
 {
     if (!config) return NULL;
 
     for (int i = 0; i < config->count; i++) {
         if (config->machines[i].id == id) {
-            return config->machines[i].ip_address;
+            return &config->machines[i];
         }
     }
 
     return NULL;
 }
+
+const char* config_get_machine_ip(const MachinesConfigList *config, int id)
+{
+    const MachineConfig *m = config_find(config, id);
+    return m ? m->host : NULL;
+}
+
+// --------------------------------------------------------------------------
+// Snapshots
+// --------------------------------------------------------------------------
+// Makes snapshot current and drops the reference the old one held as
+// current. Returns the new version.
+static unsigned int publish(Snapshot *snapshot)
+{
+    pthread_mutex_lock(&publish_mutex);
+    Snapshot *old = atomic_load(&current_snapshot);
+    unsigned int version = old ? old->list.version + 1 : 1;
+    snapshot->list.version = version;
+    atomic_store(&snapshot->refs, 1);
+    atomic_store(&current_snapshot, snapshot);
+    pthread_mutex_unlock(&publish_mutex);
+
+    if (old) {
+        // A reader that loaded the old pointer takes its reference before it
+        // leaves acquiring; after that nobody new can reach it
+        while (atomic_load(&acquiring) > 0) sched_yield();
+        config_release(&old->list);
+    }
+    return version;
+}
+
+int config_reload(void)
+{
+    Snapshot *snapshot = calloc(1, sizeof(*snapshot));
+    if (!snapshot) return -1;
+
+    if (config_load(CONFIG_FILE, &snapshot->list) != 0) {
+        // The first load publishes an empty list so readers always get something
+        if (atomic_load(&current_snapshot) == NULL) {
+            memset(snapshot, 0, sizeof(*snapshot));
+            publish(snapshot);
+        } else {
+            free(snapshot);
+        }
+        return -1;
+    }
+    int count = snapshot->list.count;
+    unsigned int version = publish(snapshot);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "%s: %d maquinas (v%u)", CONFIG_FILE, count, version);
+    logger_log("CONFIG", msg);
+    return 0;
+}
+
+static void load_once(void)
+{
+    config_reload();
+}
+
+const MachinesConfigList *config_acquire(void)
+{
+    if (atomic_load(&current_snapshot) == NULL) pthread_once(&loaded_once, load_once);
+
+    atomic_fetch_add(&acquiring, 1);
+    Snapshot *snapshot = atomic_load(&current_snapshot);
+    if (snapshot) atomic_fetch_add(&snapshot->refs, 1);
+    atomic_fetch_sub(&acquiring, 1);
+    return snapshot ? &snapshot->list : &empty_snapshot.list;
+}
+
+void config_release(const MachinesConfigList *config)
+{
+    if (!config || config == &empty_snapshot.list) return;
+    Snapshot *snapshot = (Snapshot *)config;
+    if (atomic_fetch_sub(&snapshot->refs, 1) == 1) free(snapshot);
+}
+
+unsigned int config_version(void)
+{
+    const MachinesConfigList *config = config_acquire();
+    unsigned int version = config->version;
+    config_release(config);
+    return version;
+}
+
+void config_get_jog_profile(int id, JogProfile *out)
+{
+    const MachinesConfigList *config = config_acquire();
+    const MachineConfig *m = config_find(config, id);
+    if (m) *out = m->jog;
+    else config_jog_default(out);
+    config_release(config);
+}
+
+// --------------------------------------------------------------------------
+// Hot reload
+// --------------------------------------------------------------------------
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void* thread_config_watch_loop(void* arg)
+{
+    (void)arg;
+    config_release(config_acquire());
+
+    // The directory is watched, not the file: editors save by writing a
+    // temporary file and renaming it over the original
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        printf("[CONFIG] inotify unavailable (%s), hot reload disabled\n", strerror(errno));
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    printf("[CONFIG] Watching %s\n", CONFIG_FILE);
+
+    long reload_at = 0;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (1) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int timeout = reload_at ? (int)(reload_at - now_ms()) : -1;
+        if (reload_at && timeout < 0) timeout = 0;
+
+        if (poll(&pfd, 1, timeout) > 0) {
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) {
+                for (char *p = buf; p < buf + n; ) {
+                    struct inotify_event *ev = (struct inotify_event *)p;
+                    if (ev->len > 0 && strcmp(ev->name, CONFIG_FILE) == 0) {
+                        reload_at = now_ms() + CONFIG_RELOAD_DELAY_MS;
+                    }
+                    p += sizeof(struct inotify_event) + ev->len;
+                }
+            }
+        }
+
+        if (reload_at && now_ms() >= reload_at) {
+            reload_at = 0;
+            if (config_reload() != 0) {
+                logger_log("CONFIG", "machine_config.json invalido: se mantiene la configuracion anterior");
+            }
+        }
+    }
+    return NULL;
+}
+
+int config_jog_within_limits(const JogProfile *jog, int axis, float target)
+{
+    if (!jog || !jog->has_limits || axis < 0 || axis > 2) return 1;
+    return target >= jog->limit_min[axis] && target <= jog->limit_max[axis];
+}
@@ -1,21 +1,69 @@
 #ifndef MACHINE_CONFIG_H
 #define MACHINE_CONFIG_H
 
+#include <stddef.h>
+
 #define CONFIG_FILE "machine_config.json"
-#define MAX_MACHINES 10
-#define MAX_IP_LEN 16
+#define MAX_MACHINES 64
+#define MAX_HOST_LEN 64         // IP or hostname (e.g. "cnc1.local")
+#define MAX_NAME_LEN 48
+
+#define CONFIG_DEFAULT_HTTP_PORT 80
+#define CONFIG_DEFAULT_WS_PORT   81     // FluidNC: WebSocket on HTTP port + 1
+#define CONFIG_RELOAD_DELAY_MS   200    // Editors write in several steps: wait for the last one
+
+#define MAX_JOG_STEPS 8
+
+// Jog defaults (what the buttons used before profiles existed)
+#define JOG_DEFAULT_FEED     7000
+#define JOG_DEFAULT_FEED_MIN 10
+#define JOG_DEFAULT_FEED_MAX 10000
+
+// Per-machine jog profile ("jog" object in machine_config.json)
+typedef struct {
+    float steps[MAX_JOG_STEPS];     // Step sizes offered in the UI (mm)
+    int step_count;
+    int feed;                       // mm/min, clamped to [feed_min, feed_max]
+    int feed_min;
+    int feed_max;
+    int has_limits;                 // Soft limits in machine coordinates (MPos)
+    float limit_min[3];             // X, Y, Z
+    float limit_max[3];
+} JogProfile;
 
 typedef struct {
     int id;
-    char ip_address[MAX_IP_LEN];
+    char name[MAX_NAME_LEN];        // Shown in the machine roller ("CNC 01 (Fresadora)")
+    char host[MAX_HOST_LEN];
+    int http_port;                  // Uploads (/upload)
+    int ws_port;                    // Persistent WebSocket
+    JogProfile jog;
+    float accel[3];                 // mm/s^2 per axis, 0 = unknown
+    float bed[3];                   // Work area in mm, 0 = unknown
 } MachineConfig;
 
+// Immutable once published: readers take a reference with config_acquire()
+// and give it back with config_release(), never taking a lock. A reload
+// builds a new snapshot and swaps the pointer; the old one is freed when
+// the last reader releases it.
 typedef struct {
     MachineConfig machines[MAX_MACHINES];
     int count;
+    unsigned int version;           // Increases with every successful reload
 } MachinesConfigList;
 
-// Load configuration from file
+/*
+ * machine_config.json:
+ * { "machines": [ { "id": 1, "name": "CNC 01", "host": "192.168.1.50[:80]",
+ *                   "ws_port": 81, "http_port": 80,
+ *                   "jog": { "steps": [0.1, 1, 10], "feed": 7000, "feed_min": 100, "feed_max": 10000,
+ *                            "limits": { "x": [-600, 0], "y": [-400, 0], "z": [-80, 0] } },
+ *                   "accel": { "x": 500, "y": 500, "z": 200 },
+ *                   "bed":   { "x": 600, "y": 400, "z": 80 } } ] }
+ * "ip" is still accepted instead of "host". A port in "host" is the HTTP port.
+ */
+
+// Load configuration from file (any size)
 int config_load(const char *filename, MachinesConfigList *config);
 
 // Save configuration to file
@@ -24,7 +72,36 @@ int config_save(const char *filename, MachinesConfigList *config);
 // Add a machine to configuration
 int config_add_machine(MachinesConfigList *config, int id, const char *ip);
 
-// Get machine IP from configuration
-const char* config_get_machine_ip(MachinesConfigList *config, int id);
+// Get machine host from configuration
+const char* config_get_machine_ip(const MachinesConfigList *config, int id);
+
+// Machine entry by id, NULL if it is not configured
+const MachineConfig *config_find(const MachinesConfigList *config, int id);
+
+// Reference to the current snapshot (loads CONFIG_FILE on first use). Never
+// NULL. Every call must be paired with config_release().
+const MachinesConfigList *config_acquire(void);
+
+// Gives back a reference from config_acquire(); the pointer is invalid after this
+void config_release(const MachinesConfigList *config);
+
+// Version of the current snapshot, to notice reloads cheaply
+unsigned int config_version(void);
+
+// Re-read CONFIG_FILE and publish it. Keeps the old snapshot if the file is invalid.
+int config_reload(void);
+
+// Watches CONFIG_FILE with inotify and reloads it when it changes
+void* thread_config_watch_loop(void* arg);
+
+// Default jog profile (0.1 / 1 / 10 mm, F7000, no soft limits)
+void config_jog_default(JogProfile *jog);
+
+// Jog profile of a machine from the current snapshot.
+// Machines missing from the file get the default profile.
+void config_get_jog_profile(int id, JogProfile *out);
+
+// 1 if moving `axis` (0=X, 1=Y, 2=Z) to `target` (MPos) stays within the soft limits
+int config_jog_within_limits(const JogProfile *jog, int axis, float target);
 
 #endif // MACHINE_CONFIG_H
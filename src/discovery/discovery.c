@@ -0,0 +1,498 @@
+#define _GNU_SOURCE     // memmem
+#include "discovery.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include "../logger/logger.h"
+#include "../mqtt/mqtt_service.h"
+
+#define MDNS_GRUPO      "224.0.0.251"
+#define MDNS_PUERTO     5353
+#define MARCA_MDNS      0xFFFFFFFFu     // epoll data.u32 del socket mDNS (las sondas usan su índice)
+#define SONDA_BUF       512
+#define RECIENTES_MAX   64
+
+typedef enum {
+    SONDA_LIBRE = 0,
+    SONDA_CONECTANDO,   // connect() no bloqueante en curso
+    SONDA_ESPERANDO     // Handshake enviado: esperando 101 + saludo
+} SondaFase;
+
+typedef struct {
+    int fd;
+    SondaFase fase;
+    uint32_t ip;            // Orden de host
+    long limite_ms;
+    int len;
+    char buf[SONDA_BUF];
+} Sonda;
+
+// Un barrido en curso: cola de IPs por probar y las sondas abiertas
+typedef struct {
+    int ep;
+    int fd_mdns;            // -1 si no se escucha mDNS (barrido suelto)
+    int puerto;
+    int timeout_ms;
+    discovery_cb cb;
+    void *ctx;
+
+    Sonda sondas[DISCOVERY_SIMULTANEOS];
+    int activas;
+    uint32_t cola[DISCOVERY_MAX_HOSTS];     // Circular, orden de host
+    int cola_ini;
+    int cola_n;
+    int encontrados;
+
+    struct { uint32_t ip; long t_ms; } recientes[RECIENTES_MAX];   // Anunciadas por mDNS
+    int recientes_pos;
+} Barrido;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void ip_texto(uint32_t ip, char *out, size_t cap) {
+    struct in_addr a = { .s_addr = htonl(ip) };
+    inet_ntop(AF_INET, &a, out, (socklen_t)cap);
+}
+
+// --------------------------------------------------------------------------
+// Barrido
+// --------------------------------------------------------------------------
+static Barrido *barrido_crear(int puerto, int timeout_ms, discovery_cb cb, void *ctx) {
+    Barrido *b = calloc(1, sizeof(Barrido));
+    if (!b) return NULL;
+    b->ep = epoll_create1(EPOLL_CLOEXEC);
+    if (b->ep < 0) {
+        free(b);
+        return NULL;
+    }
+    b->fd_mdns = -1;
+    b->puerto = puerto;
+    b->timeout_ms = timeout_ms;
+    b->cb = cb;
+    b->ctx = ctx;
+    for (int i = 0; i < DISCOVERY_SIMULTANEOS; i++) b->sondas[i].fd = -1;
+    return b;
+}
+
+static void sonda_cerrar(Barrido *b, Sonda *s) {
+    if (s->fd >= 0) close(s->fd);   // close() también la saca del epoll
+    s->fd = -1;
+    s->fase = SONDA_LIBRE;
+    b->activas--;
+}
+
+static void barrido_destruir(Barrido *b) {
+    for (int i = 0; i < DISCOVERY_SIMULTANEOS; i++) {
+        if (b->sondas[i].fase != SONDA_LIBRE) sonda_cerrar(b, &b->sondas[i]);
+    }
+    if (b->fd_mdns >= 0) close(b->fd_mdns);
+    close(b->ep);
+    free(b);
+}
+
+static int barrido_encolar(Barrido *b, uint32_t ip) {
+    if (b->cola_n >= DISCOVERY_MAX_HOSTS) return 0;
+    b->cola[(b->cola_ini + b->cola_n) % DISCOVERY_MAX_HOSTS] = ip;
+    b->cola_n++;
+    return 1;
+}
+
+// Encola todas las IPs de la red menos la de red y la de broadcast
+// (/31 y /32: la IP dada). Devuelve cuántas encoló.
+static int barrido_encolar_red(Barrido *b, uint32_t red, int prefijo, uint32_t propia) {
+    if (prefijo < 22) prefijo = 22;
+    if (prefijo > 30) return (red != propia && barrido_encolar(b, red)) ? 1 : 0;
+    uint32_t mascara = 0xFFFFFFFFu << (32 - prefijo);
+    uint32_t base = red & mascara;
+    uint32_t ultima = base | ~mascara;
+    int n = 0;
+    for (uint32_t ip = base + 1; ip < ultima; ip++) {
+        if (ip != propia && barrido_encolar(b, ip)) n++;
+    }
+    return n;
+}
+
+static int enviar_handshake(Barrido *b, Sonda *s) {
+    char host[INET_ADDRSTRLEN];
+    ip_texto(s->ip, host, sizeof(host));
+    // Clave fija: solo se mira que haya 101 y saludo, no Sec-WebSocket-Accept
+    char req[256];
+    int n = snprintf(req, sizeof(req),
+                     "GET / HTTP/1.1\r\n"
+                     "Host: %s:%d\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                     "Sec-WebSocket-Version: 13\r\n\r\n",
+                     host, b->puerto);
+    // Recién conectado el buffer de envío está vacío: entra de una
+    return send(s->fd, req, (size_t)n, MSG_NOSIGNAL) == n ? 0 : -1;
+}
+
+static void sonda_abrir(Barrido *b, uint32_t ip, long ahora) {
+    Sonda *s = NULL;
+    int idx = 0;
+    for (; idx < DISCOVERY_SIMULTANEOS; idx++) {
+        if (b->sondas[idx].fase == SONDA_LIBRE) { s = &b->sondas[idx]; break; }
+    }
+    if (!s) return;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)b->puerto);
+    addr.sin_addr.s_addr = htonl(ip);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);      // Rechazada en el acto (o sin ruta): no es candidato
+        return;
+    }
+
+    // Conectada al toque o no, se sigue igual: EPOLLOUT avisa en los dos casos
+    struct epoll_event ev = { .events = EPOLLOUT, .data.u32 = (uint32_t)idx };
+    if (epoll_ctl(b->ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return;
+    }
+    s->fd = fd;
+    s->fase = SONDA_CONECTANDO;
+    s->ip = ip;
+    s->limite_ms = ahora + b->timeout_ms;
+    s->len = 0;
+    b->activas++;
+}
+
+static void barrido_arrancar(Barrido *b, long ahora) {
+    while (b->cola_n > 0 && b->activas < DISCOVERY_SIMULTANEOS) {
+        uint32_t ip = b->cola[b->cola_ini];
+        b->cola_ini = (b->cola_ini + 1) % DISCOVERY_MAX_HOSTS;
+        b->cola_n--;
+        sonda_abrir(b, ip, ahora);
+    }
+}
+
+// ¿Hay en el buffer un 101 seguido del saludo de FluidNC?
+// 1 = es FluidNC, 0 = falta leer, -1 = no es FluidNC
+static int es_fluidnc(const Sonda *s) {
+    const char *fin = strstr(s->buf, "\r\n\r\n");
+    if (!fin) return (s->len >= SONDA_BUF - 1) ? -1 : 0;
+    if (strncmp(s->buf, "HTTP/1.1 101", 12) != 0) return -1;
+
+    // Frames del servidor (sin máscara) después de las cabeceras
+    const unsigned char *p = (const unsigned char *)fin + 4;
+    const unsigned char *tope = (const unsigned char *)s->buf + s->len;
+    while (tope - p >= 2) {
+        int opcode = p[0] & 0x0F;
+        size_t largo = p[1] & 0x7F;
+        size_t cab = 2;
+        if (largo == 126) {
+            if (tope - p < 4) return 0;
+            largo = ((size_t)p[2] << 8) | p[3];
+            cab = 4;
+        } else if (largo == 127) {
+            return -1;  // El saludo es corto; algo de 64 KB no es FluidNC
+        }
+        if ((size_t)(tope - p) < cab + largo) return (s->len >= SONDA_BUF - 1) ? -1 : 0;
+
+        const char *dato = (const char *)p + cab;
+        if (opcode == 0x1 || opcode == 0x2) {
+            static const char *saludos[] = { "CURRENT_ID:", "ACTIVE_ID:", "PING:" };
+            for (size_t i = 0; i < sizeof(saludos) / sizeof(saludos[0]); i++) {
+                size_t n = strlen(saludos[i]);
+                if (largo >= n && memcmp(dato, saludos[i], n) == 0) return 1;
+            }
+        }
+        p += cab + largo;
+    }
+    return 0;
+}
+
+static void sonda_evento(Barrido *b, Sonda *s, uint32_t eventos) {
+    if (s->fase == SONDA_CONECTANDO) {
+        int err = 0;
+        socklen_t l = sizeof(err);
+        if ((eventos & (EPOLLERR | EPOLLHUP)) ||
+            getsockopt(s->fd, SOL_SOCKET, SO_ERROR, &err, &l) < 0 || err != 0 ||
+            enviar_handshake(b, s) < 0) {
+            sonda_cerrar(b, s);
+            return;
+        }
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.u32 = (uint32_t)(s - b->sondas) };
+        epoll_ctl(b->ep, EPOLL_CTL_MOD, s->fd, &ev);
+        s->fase = SONDA_ESPERANDO;
+        return;
+    }
+
+    ssize_t n = recv(s->fd, s->buf + s->len, (size_t)(SONDA_BUF - 1 - s->len), 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (n > 0) {
+        s->len += (int)n;
+        s->buf[s->len] = '\0';
+    }
+
+    int r = es_fluidnc(s);
+    if (r == 1) {
+        char ip[INET_ADDRSTRLEN];
+        ip_texto(s->ip, ip, sizeof(ip));
+        b->encontrados++;
+        sonda_cerrar(b, s);
+        if (b->cb) b->cb(ip, b->ctx);
+    } else if (r < 0 || n <= 0) {
+        sonda_cerrar(b, s);     // No es FluidNC, o cerró antes de saludar
+    }
+}
+
+static void barrido_vencer(Barrido *b, long ahora) {
+    if (b->activas == 0) return;
+    for (int i = 0; i < DISCOVERY_SIMULTANEOS; i++) {
+        Sonda *s = &b->sondas[i];
+        if (s->fase != SONDA_LIBRE && ahora >= s->limite_ms) sonda_cerrar(b, s);
+    }
+}
+
+static void mdns_leer(Barrido *b);
+
+// Una vuelta: abre sondas nuevas, atiende eventos y vence las que tardan
+static void barrido_paso(Barrido *b, int espera_ms) {
+    barrido_arrancar(b, ahora_ms());
+
+    struct epoll_event ev[64];
+    int n = epoll_wait(b->ep, ev, 64, espera_ms);
+    for (int i = 0; i < n; i++) {
+        if (ev[i].data.u32 == MARCA_MDNS) {
+            mdns_leer(b);
+        } else if (ev[i].data.u32 < DISCOVERY_SIMULTANEOS) {
+            Sonda *s = &b->sondas[ev[i].data.u32];
+            if (s->fase != SONDA_LIBRE) sonda_evento(b, s, ev[i].events);
+        }
+    }
+    barrido_vencer(b, ahora_ms());
+}
+
+int discovery_barrer(uint32_t red, int prefijo, int puerto, int timeout_ms,
+                     discovery_cb cb, void *ctx) {
+    Barrido *b = barrido_crear(puerto, timeout_ms, cb, ctx);
+    if (!b) return -1;
+
+    barrido_encolar_red(b, ntohl(red), prefijo, 0);
+
+    while (b->cola_n > 0 || b->activas > 0) barrido_paso(b, 20);
+
+    int n = b->encontrados;
+    barrido_destruir(b);
+    return n;
+}
+
+int discovery_barrer_cidr(const char *cidr, int puerto, int timeout_ms,
+                          discovery_cb cb, void *ctx) {
+    char dir[INET_ADDRSTRLEN];
+    int prefijo = 24;
+    const char *barra = strchr(cidr, '/');
+    size_t n = barra ? (size_t)(barra - cidr) : strlen(cidr);
+    if (n >= sizeof(dir)) return -1;
+    memcpy(dir, cidr, n);
+    dir[n] = '\0';
+    if (barra) prefijo = atoi(barra + 1);
+
+    struct in_addr a;
+    if (inet_pton(AF_INET, dir, &a) != 1 || prefijo < 0 || prefijo > 32) return -1;
+    return discovery_barrer(a.s_addr, prefijo, puerto, timeout_ms, cb, ctx);
+}
+
+// --------------------------------------------------------------------------
+// mDNS
+// --------------------------------------------------------------------------
+static int mdns_abrir(void) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int uno = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &uno, sizeof(uno));
+#endif
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(MDNS_PUERTO);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        // 5353 ocupado (avahi sin SO_REUSEPORT): sin los anuncios espontáneos,
+        // pero las preguntas desde un puerto cualquiera igual reciben respuesta unicast
+        printf("[DISCOVERY] Puerto mDNS ocupado, solo preguntas\n");
+        addr.sin_port = 0;
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct ip_mreq grupo;
+        memset(&grupo, 0, sizeof(grupo));
+        inet_pton(AF_INET, MDNS_GRUPO, &grupo.imr_multiaddr);
+        grupo.imr_interface.s_addr = htonl(INADDR_ANY);
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &grupo, sizeof(grupo));
+    }
+    return fd;
+}
+
+// Pregunta PTR por "_http._tcp.local"
+static void mdns_preguntar(int fd) {
+    static const unsigned char pregunta[] = {
+        0, 0, 0, 0,  0, 1, 0, 0,  0, 0, 0, 0,       // Cabecera: 1 pregunta
+        5, '_', 'h', 't', 't', 'p',
+        4, '_', 't', 'c', 'p',
+        5, 'l', 'o', 'c', 'a', 'l', 0,
+        0, 12,                                      // PTR
+        0, 1                                        // IN
+    };
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(MDNS_PUERTO);
+    inet_pton(AF_INET, MDNS_GRUPO, &dst.sin_addr);
+    sendto(fd, pregunta, sizeof(pregunta), 0, (struct sockaddr *)&dst, sizeof(dst));
+}
+
+static int mdns_reciente(Barrido *b, uint32_t ip, long ahora) {
+    for (int i = 0; i < RECIENTES_MAX; i++) {
+        if (b->recientes[i].ip == ip && ahora - b->recientes[i].t_ms < DISCOVERY_REPROBAR_S * 1000L) return 1;
+    }
+    b->recientes[b->recientes_pos].ip = ip;
+    b->recientes[b->recientes_pos].t_ms = ahora;
+    b->recientes_pos = (b->recientes_pos + 1) % RECIENTES_MAX;
+    return 0;
+}
+
+// No se decodifican los registros: basta con saber quién responde por un
+// servicio _http. El saludo del WebSocket decide si es FluidNC.
+static void mdns_leer(Barrido *b) {
+    unsigned char pkt[1500];
+    struct sockaddr_in origen;
+    socklen_t l = sizeof(origen);
+    ssize_t n;
+    while ((n = recvfrom(b->fd_mdns, pkt, sizeof(pkt), 0, (struct sockaddr *)&origen, &l)) > 0) {
+        l = sizeof(origen);
+        if (n < 12 || !(pkt[2] & 0x80)) continue;           // Solo respuestas
+        if (((pkt[6] << 8) | pkt[7]) == 0) continue;         // Sin registros de respuesta
+        if (!memmem(pkt + 12, (size_t)n - 12, "\x05_http", 6)) continue;
+
+        uint32_t ip = ntohl(origen.sin_addr.s_addr);
+        if (!mdns_reciente(b, ip, ahora_ms())) barrido_encolar(b, ip);
+    }
+}
+
+// --------------------------------------------------------------------------
+// Hilo
+// --------------------------------------------------------------------------
+// Los encontrados se anotan cuando no quedan sondas abiertas:
+// maquina_descubierta puede resolver nombres y, si tarda, vencerían las
+// sondas que siguen en el epoll. Si no entran, se dejan: el próximo
+// barrido las vuelve a encontrar.
+#define PENDIENTES_MAX 64
+static char pendientes[PENDIENTES_MAX][INET_ADDRSTRLEN];
+static int pendientes_n = 0;
+static int pendientes_sin_lugar = 0;
+
+static void registrar(const char *ip, void *ctx) {
+    (void)ctx;
+    if (pendientes_n < PENDIENTES_MAX) snprintf(pendientes[pendientes_n++], INET_ADDRSTRLEN, "%s", ip);
+    else pendientes_sin_lugar++;
+}
+
+static void anotar_pendientes(void) {
+    for (int i = 0; i < pendientes_n; i++) maquina_descubierta(pendientes[i]);
+    pendientes_n = 0;
+    if (pendientes_sin_lugar > 0) {
+        printf("[DISCOVERY] %d FluidNC quedan para el próximo barrido\n", pendientes_sin_lugar);
+        pendientes_sin_lugar = 0;
+    }
+}
+
+// Encola las subredes IPv4 de las interfaces activas (menos loopback)
+static int encolar_redes_locales(Barrido *b) {
+    struct ifaddrs *lista, *i;
+    if (getifaddrs(&lista) < 0) return 0;
+    int total = 0;
+    for (i = lista; i; i = i->ifa_next) {
+        if (!i->ifa_addr || !i->ifa_netmask || i->ifa_addr->sa_family != AF_INET) continue;
+        if (!(i->ifa_flags & IFF_UP) || (i->ifa_flags & IFF_LOOPBACK)) continue;
+
+        uint32_t propia = ntohl(((struct sockaddr_in *)i->ifa_addr)->sin_addr.s_addr);
+        uint32_t mascara = ntohl(((struct sockaddr_in *)i->ifa_netmask)->sin_addr.s_addr);
+        int prefijo = __builtin_popcount(mascara);
+        int n = barrido_encolar_red(b, propia, prefijo, propia);
+        if (n > 0) {
+            char dir[INET_ADDRSTRLEN];
+            ip_texto(propia, dir, sizeof(dir));
+            printf("[DISCOVERY] Barriendo %s/%d en %s (%d IPs)\n", dir, prefijo < 22 ? 22 : prefijo, i->ifa_name, n);
+        }
+        total += n;
+    }
+    freeifaddrs(lista);
+    return total;
+}
+
+void* thread_discovery_loop(void* arg) {
+    (void)arg;
+    Barrido *b = barrido_crear(DISCOVERY_PUERTO_WS, DISCOVERY_TIMEOUT_MS, registrar, NULL);
+    if (!b) {
+        logger_log("ERROR", "Descubrimiento: no se pudo crear el epoll");
+        return NULL;
+    }
+
+    b->fd_mdns = mdns_abrir();
+    if (b->fd_mdns >= 0) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = MARCA_MDNS };
+        epoll_ctl(b->ep, EPOLL_CTL_ADD, b->fd_mdns, &ev);
+    } else {
+        logger_log("ALERTA", "Descubrimiento: sin mDNS, solo barrido");
+    }
+
+    long ultima_pregunta = -DISCOVERY_MDNS_S * 1000L;
+    long ultimo_barrido = -DISCOVERY_BARRIDO_S * 1000L;
+    long t_barrido = 0;
+    int barriendo = 0;
+    int encontrados_antes = 0;
+
+    while (1) {
+        long ahora = ahora_ms();
+        if (b->fd_mdns >= 0 && ahora - ultima_pregunta >= DISCOVERY_MDNS_S * 1000L) {
+            mdns_preguntar(b->fd_mdns);
+            ultima_pregunta = ahora;
+        }
+        if (!barriendo && ahora - ultimo_barrido >= DISCOVERY_BARRIDO_S * 1000L) {
+            ultimo_barrido = ahora;
+            encontrados_antes = b->encontrados;
+            barriendo = encolar_redes_locales(b) > 0;
+            t_barrido = ahora;
+        }
+
+        // Apurado mientras hay sondas; si no, solo espera paquetes mDNS
+        barrido_paso(b, (b->activas > 0 || b->cola_n > 0) ? 20 : 500);
+        if (b->activas == 0) anotar_pendientes();
+
+        if (barriendo && b->activas == 0 && b->cola_n == 0) {
+            barriendo = 0;
+            printf("[DISCOVERY] Barrido terminado en %ld ms: %d FluidNC\n",
+                   ahora_ms() - t_barrido, b->encontrados - encontrados_antes);
+        }
+    }
+
+    barrido_destruir(b);
+    return NULL;
+}
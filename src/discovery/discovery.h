@@ -0,0 +1,56 @@
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- DESCUBRIMIENTO DE CONTROLADORES FLUIDNC ---
+// Dos fuentes de candidatos:
+//  - mDNS: se escucha 224.0.0.251:5353 y se pregunta cada tanto por
+//    "_http._tcp.local" (FluidNC se anuncia así). Quien responde es candidato.
+//  - Barrido: connect() no bloqueante a todas las IPs de la subred local,
+//    cientos a la vez, atendidos con un solo epoll.
+// Un candidato es FluidNC si en el puerto 81 acepta el WebSocket (101) y
+// manda su saludo ("CURRENT_ID:0" / "ACTIVE_ID:0" / "PING:"). Los que pasan
+// se anotan con maquina_descubierta() y el pool de WebSocket se conecta solo.
+
+#define DISCOVERY_PUERTO_WS      81
+#define DISCOVERY_TIMEOUT_MS     1000    // Conexión + handshake + saludo, por IP
+#define DISCOVERY_SIMULTANEOS    256     // Sondas abiertas a la vez (un /24 entero)
+#define DISCOVERY_MAX_HOSTS      1024    // Subredes más grandes que /22 se recortan
+#define DISCOVERY_BARRIDO_S      300     // Cada cuánto se repite el barrido
+#define DISCOVERY_MDNS_S         60      // Cada cuánto se pregunta por mDNS
+#define DISCOVERY_REPROBAR_S     60      // Una IP anunciada por mDNS no se vuelve a probar antes
+
+// Se llama por cada controlador encontrado (ip en texto, "192.168.1.50")
+typedef void (*discovery_cb)(const char *ip, void *ctx);
+
+/**
+ * @brief Barre una subred buscando FluidNC. Bloquea hasta terminar (como
+ * mucho un par de timeouts, aunque sean cientos de IPs).
+ * @param red Dirección base en orden de red.
+ * @param prefijo Largo de la máscara (24 = 254 IPs). Menos de 22 se recorta a 22.
+ * @param puerto Puerto del WebSocket (DISCOVERY_PUERTO_WS).
+ * @param timeout_ms Tiempo máximo por IP.
+ * @return Cantidad de controladores encontrados, -1 si no se pudo crear el epoll.
+ */
+int discovery_barrer(uint32_t red, int prefijo, int puerto, int timeout_ms,
+                     discovery_cb cb, void *ctx);
+
+/**
+ * @brief Igual que discovery_barrer pero con "192.168.1.0/24".
+ */
+int discovery_barrer_cidr(const char *cidr, int puerto, int timeout_ms,
+                          discovery_cb cb, void *ctx);
+
+// Hilo: escucha mDNS y barre las subredes de las interfaces locales
+void* thread_discovery_loop(void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISCOVERY_H
@@ -0,0 +1,119 @@
+#include "dro.h"
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+static float norma(const float v[3]) {
+    return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+void dro_reset(Dro *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void dro_muestra(Dro *d, const float pos[3], long t_ms, float feed, int en_movimiento) {
+    // Velocidad media entre las dos últimas muestras (solo si venía moviéndose)
+    float medida[3] = {0, 0, 0};
+    float medida_mod = 0;
+    long dt = t_ms - d->t_ms;
+    int medible = d->t_ms && d->en_movimiento && en_movimiento && dt > 0 && dt <= DRO_DT_MAX_MS;
+    if (medible) {
+        for (int k = 0; k < 3; k++) medida[k] = (pos[k] - d->pos[k]) / (float)dt;
+        medida_mod = norma(medida);
+    }
+
+    // Lo que se mostraba en ese momento, y a qué rapidez venía
+    float antes[3];
+    dro_estimar(d, t_ms, antes);
+    float rapidez_antes = d->rapidez;
+
+    memcpy(d->pos, pos, sizeof(d->pos));
+    d->t_ms = t_ms;
+    d->en_movimiento = en_movimiento;
+    d->tiene_fin = 0;
+    d->intervalo_ms = medible ? dt : (en_movimiento ? d->intervalo_ms : 0);
+
+    // El feed del reporte es el de ahora (con aceleración y overrides); lo
+    // medido es un promedio del último intervalo, atrasado
+    if (!en_movimiento) d->rapidez = 0;
+    else if (feed >= 0) d->rapidez = feed / 60000.0f;
+    else d->rapidez = medida_mod;
+
+    for (int k = 0; k < 3; k++) {
+        d->vel[k] = (medida_mod > 0) ? medida[k] * (d->rapidez / medida_mod) : 0;
+    }
+
+    // Lo que se mostraba y lo reportado se juntan en DRO_MEZCLA_MS en vez de
+    // saltar. Parada, o diferencia de más de dos intervalos de recorrido
+    // (reconexión): directo a lo real.
+    memset(d->correccion, 0, sizeof(d->correccion));
+    if (!medible) return;
+    float dif[3];
+    for (int k = 0; k < 3; k++) dif[k] = antes[k] - pos[k];
+    if (norma(dif) > 2.0f * rapidez_antes * (float)dt) return;
+    memcpy(d->correccion, dif, sizeof(dif));
+}
+
+int dro_segmento(Dro *d, const float ini[3], const float fin[3]) {
+    if (!d->en_movimiento || d->rapidez <= 0) return 0;
+
+    // ¿La posición está sobre el segmento? (proyección dentro y cerca de la recta)
+    float seg[3], rel[3];
+    for (int k = 0; k < 3; k++) {
+        seg[k] = fin[k] - ini[k];
+        rel[k] = d->pos[k] - ini[k];
+    }
+    float largo2 = seg[0] * seg[0] + seg[1] * seg[1] + seg[2] * seg[2];
+    if (largo2 < DRO_DIST_MIN * DRO_DIST_MIN) return 0;
+    float t = (rel[0] * seg[0] + rel[1] * seg[1] + rel[2] * seg[2]) / largo2;
+    if (t < 0 || t > 1) return 0;
+    float fuera[3];
+    for (int k = 0; k < 3; k++) fuera[k] = rel[k] - seg[k] * t;
+    if (norma(fuera) > DRO_TOLERANCIA_MM) return 0;
+
+    float dir[3];
+    for (int k = 0; k < 3; k++) dir[k] = fin[k] - d->pos[k];
+    float dist = norma(dir);
+    if (dist < DRO_DIST_MIN) return 0;      // Ya llegó: que siga lo medido
+
+    for (int k = 0; k < 3; k++) d->vel[k] = dir[k] * (d->rapidez / dist);
+    memcpy(d->fin, fin, sizeof(d->fin));
+    d->dist_fin = dist;
+    d->tiene_fin = 1;
+    return 1;
+}
+
+void dro_estimar(const Dro *d, long ahora_ms, float out[3]) {
+    memcpy(out, d->pos, sizeof(d->pos));
+    if (!d->t_ms || !d->en_movimiento) return;
+
+    long edad = ahora_ms - d->t_ms;
+    if (edad < DRO_MEZCLA_MS) {
+        float resto = 1.0f - (float)(edad > 0 ? edad : 0) / DRO_MEZCLA_MS;
+        for (int k = 0; k < 3; k++) out[k] += d->correccion[k] * resto;
+    }
+    if (edad <= 0) return;
+    // Reporte atrasado o perdido: se queda donde tendría que haber llegado el siguiente
+    long tope = (d->intervalo_ms > 0 && d->intervalo_ms < DRO_EDAD_MAX_MS) ? d->intervalo_ms : DRO_EDAD_MAX_MS;
+    if (edad > tope) edad = tope;
+
+    float t = (float)edad;
+    if (d->tiene_fin) {
+        if (d->rapidez * t >= d->dist_fin) {
+            memcpy(out, d->fin, sizeof(d->fin));
+            return;
+        }
+    } else if (t > DRO_AVANCE_SIN_FIN * (float)tope) {
+        t = DRO_AVANCE_SIN_FIN * (float)tope;
+    }
+    for (int k = 0; k < 3; k++) out[k] += d->vel[k] * t;
+}
+
+int dro_estado_mueve(const char *estado) {
+    if (!estado) return 0;
+    // Hold:1 también se mueve, pero frenando: mejor quieta que pasada
+    return strncasecmp(estado, "Run", 3) == 0 ||
+           strncasecmp(estado, "Jog", 3) == 0 ||
+           strncasecmp(estado, "Home", 4) == 0 ||
+           strstr(estado, "TRABAJANDO") != NULL;
+}
@@ -0,0 +1,70 @@
+#ifndef DRO_H
+#define DRO_H
+
+// --- POSICIÓN ESTIMADA ENTRE REPORTES (dead reckoning) ---
+// Los controladores reportan la posición a ~5 Hz; entre un reporte y otro el
+// DRO se mueve con la última velocidad conocida: la dirección sale del
+// segmento del programa que se está ejecutando (si la posición reportada cae
+// sobre él) o de las dos últimas muestras, y la rapidez del feed real del
+// reporte (FS). Nunca se extrapola más que el intervalo observado entre
+// reportes (ni que DRO_EDAD_MAX_MS) ni se pasa del fin del segmento. Sin el
+// segmento no se sabe dónde dobla la máquina: se avanza como mucho
+// DRO_AVANCE_SIN_FIN de lo que recorre en un intervalo, para que pasarse de
+// una esquina no aleje el DRO más que quedarse quieto. Cuando llega un
+// reporte, la diferencia con lo que se mostraba se absorbe en DRO_MEZCLA_MS
+// en vez de saltar (salvo al pararse: ahí va directo a la posición real).
+// Sin hilos ni locks: cada Dro es de quien lo usa.
+
+#define DRO_EDAD_MAX_MS     250     // Un reporte a 5 Hz más un margen por la red
+#define DRO_AVANCE_SIN_FIN  0.3f    // Fracción del intervalo que se extrapola sin segmento
+#define DRO_MEZCLA_MS       32      // En cuánto se absorbe la corrección de un reporte nuevo
+#define DRO_DT_MAX_MS       1000    // Muestras más separadas no sirven para medir velocidad
+#define DRO_TOLERANCIA_MM   0.1f    // Distancia máxima de la posición al segmento para creerle
+#define DRO_DIST_MIN        0.001f  // mm: más cerca del fin del segmento, no hay dirección
+
+typedef struct {
+    float pos[3];           // Última posición reportada (mm)
+    float vel[3];           // mm/ms con la que se extrapola (0 = quieta)
+    float rapidez;          // mm/ms: feed real, o lo medido si no hay feed
+    long t_ms;              // Cuándo llegó la muestra (0 = ninguna)
+    long intervalo_ms;      // Entre las dos últimas muestras en movimiento (0 = no se sabe)
+    int en_movimiento;
+    int tiene_fin;          // Se extrapola sobre un segmento del programa...
+    float fin[3];           // ...y se para en su fin
+    float dist_fin;
+    float correccion[3];    // Lo mostrado menos lo reportado al llegar la muestra
+} Dro;
+
+void dro_reset(Dro *d);
+
+/**
+ * @brief Anota una posición reportada (la estimación llega a ella en
+ * DRO_MEZCLA_MS, o enseguida si la máquina se paró).
+ * @param t_ms Hora de llegada del reporte (CLOCK_MONOTONIC).
+ * @param feed Feed real en mm/min, o < 0 si el reporte no lo trae.
+ * @param en_movimiento 0 si la máquina está quieta (Idle, Hold:0, Alarm...).
+ */
+void dro_muestra(Dro *d, const float pos[3], long t_ms, float feed, int en_movimiento);
+
+/**
+ * @brief Propone un segmento recto del programa, después de dro_muestra.
+ * Solo se toma si la posición reportada cae sobre él: el controlador
+ * reporta la línea que entra al planificador, que puede ir adelantada, así
+ * que quien llama prueba desde esa línea hacia atrás.
+ * @param ini Donde empieza (el fin de la línea anterior).
+ * @param fin Destino.
+ * @return 1 si se tomó.
+ */
+int dro_segmento(Dro *d, const float ini[3], const float fin[3]);
+
+/**
+ * @brief Posición estimada para la hora dada.
+ */
+void dro_estimar(const Dro *d, long ahora_ms, float out[3]);
+
+/**
+ * @brief Si un estado de máquina (FluidNC o de la nube) implica movimiento.
+ */
+int dro_estado_mueve(const char *estado);
+
+#endif
@@ -0,0 +1,116 @@
+#include "sha256.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void procesar_bloque(Sha256Ctx *ctx, const uint8_t *p) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16) |
+               ((uint32_t)p[i * 4 + 2] << 8) | (uint32_t)p[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx->estado[0], b = ctx->estado[1], c = ctx->estado[2], d = ctx->estado[3];
+    uint32_t e = ctx->estado[4], f = ctx->estado[5], g = ctx->estado[6], h = ctx->estado[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t S1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + S1 + ch + K[i] + w[i];
+        uint32_t S0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = S0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    ctx->estado[0] += a; ctx->estado[1] += b; ctx->estado[2] += c; ctx->estado[3] += d;
+    ctx->estado[4] += e; ctx->estado[5] += f; ctx->estado[6] += g; ctx->estado[7] += h;
+}
+
+void sha256_init(Sha256Ctx *ctx) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx->estado, iv, sizeof(iv));
+    ctx->bits = 0;
+    ctx->usado = 0;
+}
+
+void sha256_update(Sha256Ctx *ctx, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t*)data;
+    ctx->bits += (uint64_t)len * 8;
+
+    while (len > 0) {
+        size_t n = 64 - ctx->usado;
+        if (n > len) n = len;
+        memcpy(ctx->bloque + ctx->usado, p, n);
+        ctx->usado += n;
+        p += n;
+        len -= n;
+        if (ctx->usado == 64) {
+            procesar_bloque(ctx, ctx->bloque);
+            ctx->usado = 0;
+        }
+    }
+}
+
+void sha256_final(Sha256Ctx *ctx, uint8_t digest[SHA256_DIGEST_LEN]) {
+    uint64_t bits = ctx->bits;
+    uint8_t relleno = 0x80;
+    sha256_update(ctx, &relleno, 1);
+    relleno = 0;
+    while (ctx->usado != 56) sha256_update(ctx, &relleno, 1);
+
+    uint8_t largo[8];
+    for (int i = 0; i < 8; i++) largo[i] = (uint8_t)(bits >> (56 - i * 8));
+    sha256_update(ctx, largo, 8);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4]     = (uint8_t)(ctx->estado[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->estado[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->estado[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)(ctx->estado[i]);
+    }
+}
+
+int sha256_archivo(const char *ruta, char hex[SHA256_HEX_LEN]) {
+    FILE *f = fopen(ruta, "rb");
+    if (!f) return -1;
+
+    Sha256Ctx ctx;
+    sha256_init(&ctx);
+    unsigned char buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        sha256_update(&ctx, buf, n);
+    }
+    int error = ferror(f);
+    fclose(f);
+    if (error) return -1;
+
+    uint8_t digest[SHA256_DIGEST_LEN];
+    sha256_final(&ctx, digest);
+    for (int i = 0; i < SHA256_DIGEST_LEN; i++) {
+        sprintf(hex + i * 2, "%02x", digest[i]);
+    }
+    hex[64] = '\0';
+    return 0;
+}
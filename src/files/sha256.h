@@ -0,0 +1,30 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_LEN 32
+#define SHA256_HEX_LEN    65   // 64 caracteres + '\0'
+
+// SHA-256 incremental (para verificar archivos sin cargarlos enteros en memoria)
+typedef struct {
+    uint32_t estado[8];
+    uint64_t bits;
+    uint8_t bloque[64];
+    size_t usado;
+} Sha256Ctx;
+
+void sha256_init(Sha256Ctx *ctx);
+void sha256_update(Sha256Ctx *ctx, const void *data, size_t len);
+void sha256_final(Sha256Ctx *ctx, uint8_t digest[SHA256_DIGEST_LEN]);
+
+/**
+ * @brief Calcula el SHA-256 de un archivo leyendo por bloques.
+ * @param ruta Archivo a leer.
+ * @param hex Salida en hexadecimal minúscula (SHA256_HEX_LEN bytes).
+ * @return 0 si se pudo leer, -1 si no.
+ */
+int sha256_archivo(const char *ruta, char hex[SHA256_HEX_LEN]);
+
+#endif
@@ -0,0 +1,231 @@
+#include "hal.h"
+#include "lv_drv_conf.h"
+#if USE_SDL
+#include "sdl/sdl.h"
+#endif
+#if HAL_USE_DRM
+#include "hal_drm.h"
+#endif
+#if USE_EVDEV
+#include "indev/evdev.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define GUION_MAX   256
+
+static HalBackend backend_activo = HAL_SDL;
+
+static lv_disp_draw_buf_t disp_buf;
+static lv_color_t buf[HAL_HOR_RES * HAL_BUF_LINEAS];
+static lv_disp_drv_t disp_drv;
+static lv_indev_drv_t indev_drv;
+static HalFrame frame;
+static void (*flush_backend)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *);
+
+// --- Offscreen ---
+static lv_color_t *framebuffer = NULL;
+
+static HalPaso guion[GUION_MAX];
+static int guion_n = 0;
+static int guion_i = 0;
+static uint32_t paso_inicio = 0;
+static lv_coord_t ultimo_x = 0, ultimo_y = 0;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+HalBackend hal_backend_env(void) {
+    const char *v = getenv("CNC_HAL");
+    if (v && strcasecmp(v, "offscreen") == 0) return HAL_OFFSCREEN;
+    if (v && strcasecmp(v, "drm") == 0) return HAL_DRM;
+    return HAL_SDL;
+}
+
+HalBackend hal_backend(void) {
+    return backend_activo;
+}
+
+const lv_color_t *hal_framebuffer(void) {
+    return framebuffer;
+}
+
+// --------------------------------------------------------------------------
+// Medición, igual para todos los backends (los flush son sincrónicos)
+// --------------------------------------------------------------------------
+static void flush_medido(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    double t0 = ahora_ms();
+    flush_backend(drv, area, color_p);
+    frame.flush_ms += ahora_ms() - t0;
+    frame.flushes++;
+}
+
+// LVGL lo llama al terminar cada refresco con los píxeles que redibujó
+static void monitor(lv_disp_drv_t *drv, uint32_t ms, uint32_t px) {
+    (void)drv;
+    (void)ms;               // Con tick manual no sirve: el tiempo lo mide el llamador
+    frame.px_invalidados += px;
+    frame.refrescos++;
+}
+
+void hal_frame_tomar(HalFrame *out) {
+    *out = frame;
+    memset(&frame, 0, sizeof(frame));
+}
+
+// --------------------------------------------------------------------------
+// Driver de pantalla en memoria
+// --------------------------------------------------------------------------
+static void offscreen_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    lv_coord_t ancho = lv_area_get_width(area);
+    for (lv_coord_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&framebuffer[y * HAL_HOR_RES + area->x1], color_p, ancho * sizeof(lv_color_t));
+        color_p += ancho;
+    }
+    lv_disp_flush_ready(drv);
+}
+
+// --------------------------------------------------------------------------
+// Entrada por guion
+// --------------------------------------------------------------------------
+void hal_guion_cargar(const HalPaso *pasos, int n) {
+    if (n > GUION_MAX) n = GUION_MAX;
+    memcpy(guion, pasos, n * sizeof(HalPaso));
+    guion_n = n;
+    guion_i = 0;
+    paso_inicio = lv_tick_get();
+}
+
+int hal_guion_terminado(void) {
+    return guion_i >= guion_n;
+}
+
+static void guion_leer(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+    (void)drv;
+    while (guion_i < guion_n && lv_tick_elaps(paso_inicio) >= guion[guion_i].ms) {
+        paso_inicio += guion[guion_i].ms;
+        guion_i++;
+    }
+    if (guion_i < guion_n) {
+        ultimo_x = guion[guion_i].x;
+        ultimo_y = guion[guion_i].y;
+        data->state = guion[guion_i].presionado ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    } else {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+    data->point.x = ultimo_x;
+    data->point.y = ultimo_y;
+}
+
+static void* thread_tick_loop(void* arg) {
+    (void)arg;
+    while (1) {
+        usleep(5000);
+        lv_tick_inc(5);
+    }
+    return NULL;
+}
+
+// --------------------------------------------------------------------------
+// Registro
+// --------------------------------------------------------------------------
+static void tick_propio_iniciar(void) {
+    pthread_t t_tick;
+    pthread_create(&t_tick, NULL, thread_tick_loop, NULL);
+    pthread_detach(t_tick);
+}
+
+static void buffer_parcial(void) {
+    lv_disp_draw_buf_init(&disp_buf, buf, NULL, HAL_HOR_RES * HAL_BUF_LINEAS);
+    disp_drv.hor_res = HAL_HOR_RES;
+    disp_drv.ver_res = HAL_VER_RES;
+}
+
+static int init_sdl(void) {
+#if USE_SDL
+    sdl_init();
+    buffer_parcial();
+    disp_drv.flush_cb = sdl_display_flush;
+    indev_drv.read_cb = sdl_mouse_read;
+    return 0;
+#else
+    printf("[HAL] Compilado sin SDL\n");
+    return -1;
+#endif
+}
+
+static int init_drm(void) {
+#if HAL_USE_DRM
+    if (hal_drm_init(&disp_buf, &disp_drv) < 0) return -1;
+#if USE_EVDEV
+    evdev_init();
+    indev_drv.read_cb = evdev_read;
+#else
+    indev_drv.read_cb = guion_leer;     // Sin táctil: el puntero queda suelto
+#endif
+    tick_propio_iniciar();
+    return 0;
+#else
+    printf("[HAL] Compilado sin DRM (cmake -DCNC_HAL_DRM=ON)\n");
+    return -1;
+#endif
+}
+
+static int init_offscreen(int tick_propio) {
+    framebuffer = calloc(HAL_HOR_RES * HAL_VER_RES, sizeof(lv_color_t));
+    if (!framebuffer) {
+        printf("[HAL] Sin memoria para el framebuffer\n");
+        return -1;
+    }
+    buffer_parcial();
+    disp_drv.flush_cb = offscreen_flush;
+    indev_drv.read_cb = guion_leer;
+    if (tick_propio) tick_propio_iniciar();
+    return 0;
+}
+
+static const char *nombre_backend(HalBackend b) {
+    if (b == HAL_OFFSCREEN) return "offscreen";
+    if (b == HAL_DRM) return "DRM";
+    return "SDL";
+}
+
+void hal_init(HalBackend backend, int tick_propio) {
+    backend_activo = backend;
+    lv_disp_drv_init(&disp_drv);
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+
+    int r;
+    if (backend == HAL_OFFSCREEN) r = init_offscreen(tick_propio);
+    else if (backend == HAL_DRM) r = init_drm();
+    else r = init_sdl();
+    if (r < 0) {
+        printf("[HAL] No se pudo iniciar el backend %s\n", nombre_backend(backend));
+        exit(1);
+    }
+
+    disp_drv.draw_buf = &disp_buf;
+    flush_backend = disp_drv.flush_cb;
+    disp_drv.flush_cb = flush_medido;
+    disp_drv.monitor_cb = monitor;
+    lv_disp_drv_register(&disp_drv);
+    lv_indev_t * indev = lv_indev_drv_register(&indev_drv);
+
+    // El cursor solo tiene sentido con mouse
+    if (backend == HAL_SDL) {
+        lv_obj_t * cursor = lv_label_create(lv_scr_act());
+        lv_label_set_text(cursor, "+");
+        lv_indev_set_cursor(indev, cursor);
+    }
+
+    printf("[HAL] Backend %s, %dx%d a %d bpp\n", nombre_backend(backend), disp_drv.hor_res, disp_drv.ver_res, LV_COLOR_DEPTH);
+}
@@ -0,0 +1,64 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include "lvgl.h"
+
+// --- PANTALLA Y ENTRADA ---
+// Backends, elegidos al arrancar con CNC_HAL en el entorno:
+//  - HAL_SDL (por defecto): ventana SDL y mouse.
+//  - HAL_OFFSCREEN (CNC_HAL=offscreen): framebuffer en memoria y entrada por
+//    guion. Sin ventana, para medir la UI sin pantalla (tests/ui_bench.c).
+//  - HAL_DRM (CNC_HAL=drm): DRM/KMS directo con doble buffer y táctil por
+//    evdev, para el panel del Pi (hal_drm.h). Solo con cmake -DCNC_HAL_DRM=ON.
+
+#define HAL_HOR_RES     800
+#define HAL_VER_RES     480
+#define HAL_BUF_LINEAS  100     // Buffer de dibujo parcial (SDL y offscreen)
+
+typedef enum {
+    HAL_SDL = 0,
+    HAL_OFFSCREEN,
+    HAL_DRM
+} HalBackend;
+
+// Un paso del guion de entrada: el puntero queda así durante `ms`
+typedef struct {
+    lv_coord_t x;
+    lv_coord_t y;
+    int presionado;
+    uint32_t ms;
+} HalPaso;
+
+// Lo medido desde la última llamada a hal_frame_tomar()
+typedef struct {
+    double flush_ms;            // Tiempo dentro de flush_cb (copias; con DRM, también el vsync)
+    uint32_t px_invalidados;    // Píxeles redibujados (monitor_cb de LVGL)
+    int refrescos;              // Veces que LVGL redibujó algo
+    int flushes;                // Áreas enviadas al framebuffer
+} HalFrame;
+
+// Lee CNC_HAL del entorno
+HalBackend hal_backend_env(void);
+
+/**
+ * @brief Registra pantalla y entrada del backend (después de lv_init()).
+ * @param tick_propio En offscreen: 1 lanza un hilo que avanza lv_tick; 0 deja
+ *                    el tick a cargo del llamador (benchmark determinista).
+ *                    Con SDL no se usa (el driver ya tiene su tick) y DRM
+ *                    siempre lanza el suyo.
+ */
+void hal_init(HalBackend backend, int tick_propio);
+
+HalBackend hal_backend(void);
+
+// Offscreen: framebuffer HAL_HOR_RES x HAL_VER_RES (NULL con SDL)
+const lv_color_t *hal_framebuffer(void);
+
+// Offscreen (y DRM sin evdev): reemplaza el guion de entrada. Terminado, el puntero queda suelto.
+void hal_guion_cargar(const HalPaso *pasos, int n);
+int hal_guion_terminado(void);
+
+// Devuelve lo acumulado y vuelve a cero
+void hal_frame_tomar(HalFrame *out);
+
+#endif
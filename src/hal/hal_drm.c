@@ -0,0 +1,204 @@
+#include "hal_drm.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP
+#define FORMATO_DRM (DRM_FORMAT_RGB565 | DRM_FORMAT_BIG_ENDIAN)
+#elif LV_COLOR_DEPTH == 16
+#define FORMATO_DRM DRM_FORMAT_RGB565
+#else
+#define FORMATO_DRM DRM_FORMAT_XRGB8888
+#endif
+
+typedef struct {
+    uint32_t handle;
+    uint32_t fb_id;
+    uint32_t pitch;
+    uint64_t tam;
+    uint8_t *mapa;
+} BufferDrm;
+
+static int fd = -1;
+static uint32_t conector_id;
+static uint32_t crtc_id;
+static drmModeModeInfo modo;
+static BufferDrm buffers[2];
+static int flip_pendiente = 0;
+
+static int crear_buffer(BufferDrm *b, uint32_t ancho, uint32_t alto) {
+    struct drm_mode_create_dumb crear = { .width = ancho, .height = alto, .bpp = LV_COLOR_DEPTH };
+    if (drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, &crear) < 0) return -1;
+    b->handle = crear.handle;
+    b->pitch = crear.pitch;
+    b->tam = crear.size;
+
+    // LVGL en modo directo escribe con stride = ancho
+    if (b->pitch != ancho * sizeof(lv_color_t)) {
+        printf("[DRM] Pitch %u no coincide con %u px de ancho\n", b->pitch, ancho);
+        return -1;
+    }
+
+    uint32_t handles[4] = { b->handle }, pitches[4] = { b->pitch }, offsets[4] = { 0 };
+    if (drmModeAddFB2(fd, ancho, alto, FORMATO_DRM, handles, pitches, offsets, &b->fb_id, 0) < 0)
+        return -1;
+
+    struct drm_mode_map_dumb mapear = { .handle = b->handle };
+    if (drmIoctl(fd, DRM_IOCTL_MODE_MAP_DUMB, &mapear) < 0) return -1;
+    b->mapa = mmap(NULL, b->tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, mapear.offset);
+    if (b->mapa == MAP_FAILED) return -1;
+    memset(b->mapa, 0, b->tam);
+    return 0;
+}
+
+// Primer conector conectado, su modo preferido y un CRTC que lo pueda manejar
+static int elegir_salida(void) {
+    drmModeRes *res = drmModeGetResources(fd);
+    if (!res) return -1;
+
+    int ok = -1;
+    for (int i = 0; i < res->count_connectors && ok < 0; i++) {
+        drmModeConnector *con = drmModeGetConnector(fd, res->connectors[i]);
+        if (!con) continue;
+        if (con->connection == DRM_MODE_CONNECTED && con->count_modes > 0) {
+            modo = con->modes[0];
+            for (int m = 0; m < con->count_modes; m++) {
+                if (con->modes[m].type & DRM_MODE_TYPE_PREFERRED) {
+                    modo = con->modes[m];
+                    break;
+                }
+            }
+            drmModeEncoder *enc = con->encoder_id ? drmModeGetEncoder(fd, con->encoder_id) : NULL;
+            if (enc && enc->crtc_id) {
+                crtc_id = enc->crtc_id;
+                ok = 0;
+            } else {
+                for (int e = 0; e < con->count_encoders && ok < 0; e++) {
+                    drmModeEncoder *cand = drmModeGetEncoder(fd, con->encoders[e]);
+                    if (!cand) continue;
+                    for (int c = 0; c < res->count_crtcs; c++) {
+                        if (cand->possible_crtcs & (1u << c)) {
+                            crtc_id = res->crtcs[c];
+                            ok = 0;
+                            break;
+                        }
+                    }
+                    drmModeFreeEncoder(cand);
+                }
+            }
+            if (enc) drmModeFreeEncoder(enc);
+            conector_id = con->connector_id;
+        }
+        drmModeFreeConnector(con);
+    }
+    drmModeFreeResources(res);
+    return ok;
+}
+
+static void al_flip(int fd_, unsigned int frame, unsigned int s, unsigned int us, void *dato) {
+    (void)fd_; (void)frame; (void)s; (void)us; (void)dato;
+    flip_pendiente = 0;
+}
+
+static void esperar_flip(void) {
+    drmEventContext ev = { .version = 2, .page_flip_handler = al_flip };
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (flip_pendiente) {
+        int r = poll(&pfd, 1, 100);
+        if (r < 0 && errno != EINTR) break;
+        if (r == 0) {
+            printf("[DRM] Page flip sin respuesta, se sigue\n");
+            break;
+        }
+        if (r > 0) drmHandleEvent(fd, &ev);
+    }
+    flip_pendiente = 0;
+}
+
+static BufferDrm *buffer_de(const lv_color_t *p) {
+    return ((const uint8_t *)p == buffers[0].mapa) ? &buffers[0] : &buffers[1];
+}
+
+// En modo directo LVGL ya escribió en el buffer oculto; solo el último
+// flush del frame hace algo
+static void drm_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    (void)area;
+    if (!lv_disp_flush_is_last(drv)) {
+        lv_disp_flush_ready(drv);
+        return;
+    }
+
+    BufferDrm *listo = buffer_de(color_p);
+    BufferDrm *otro = (listo == &buffers[0]) ? &buffers[1] : &buffers[0];
+
+    if (drmModePageFlip(fd, crtc_id, listo->fb_id, DRM_MODE_PAGE_FLIP_EVENT, NULL) == 0) {
+        flip_pendiente = 1;
+        esperar_flip();     // El flip ocurre en el vsync: sin tearing
+    } else {
+        printf("[DRM] Page flip falló (%s)\n", strerror(errno));
+    }
+
+    // El próximo frame se dibuja sobre `otro`: ponerle lo que cambió en este
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    for (int i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) continue;
+        const lv_area_t *a = &disp->inv_areas[i];
+        size_t bytes = lv_area_get_width(a) * sizeof(lv_color_t);
+        for (lv_coord_t y = a->y1; y <= a->y2; y++) {
+            size_t off = y * listo->pitch + a->x1 * sizeof(lv_color_t);
+            memcpy(otro->mapa + off, listo->mapa + off, bytes);
+        }
+    }
+    lv_disp_flush_ready(drv);
+}
+
+int hal_drm_init(lv_disp_draw_buf_t *disp_buf, lv_disp_drv_t *drv) {
+    fd = open(HAL_DRM_DISPOSITIVO, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        printf("[DRM] No se pudo abrir %s (%s)\n", HAL_DRM_DISPOSITIVO, strerror(errno));
+        return -1;
+    }
+    uint64_t dumb = 0;
+    if (drmGetCap(fd, DRM_CAP_DUMB_BUFFER, &dumb) < 0 || !dumb) {
+        printf("[DRM] El dispositivo no tiene dumb buffers\n");
+        goto error;
+    }
+    if (elegir_salida() < 0) {
+        printf("[DRM] No hay conector conectado\n");
+        goto error;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (crear_buffer(&buffers[i], modo.hdisplay, modo.vdisplay) < 0) {
+            printf("[DRM] No se pudo crear el buffer %d\n", i);
+            goto error;
+        }
+    }
+    if (drmModeSetCrtc(fd, crtc_id, buffers[0].fb_id, 0, 0, &conector_id, 1, &modo) < 0) {
+        printf("[DRM] drmModeSetCrtc falló (%s)\n", strerror(errno));
+        goto error;
+    }
+
+    uint32_t px = modo.hdisplay * modo.vdisplay;
+    lv_disp_draw_buf_init(disp_buf, buffers[0].mapa, buffers[1].mapa, px);
+    drv->flush_cb = drm_flush;
+    drv->direct_mode = 1;
+    drv->hor_res = modo.hdisplay;
+    drv->ver_res = modo.vdisplay;
+
+    printf("[DRM] %s: %dx%d@%d, doble buffer en modo directo\n",
+           HAL_DRM_DISPOSITIVO, modo.hdisplay, modo.vdisplay, modo.vrefresh);
+    return 0;
+
+error:
+    close(fd);
+    fd = -1;
+    return -1;
+}
@@ -0,0 +1,23 @@
+#ifndef HAL_DRM_H
+#define HAL_DRM_H
+
+#include "lvgl.h"
+
+// --- BACKEND DRM/KMS (panel del Pi, sin SDL ni X) ---
+// Dos dumb buffers del tamaño de la pantalla en modo directo de LVGL: se
+// dibuja sobre el que no se ve, al terminar el frame se hace page flip en el
+// vsync y se copian al otro buffer solo las áreas invalidadas, así los dos
+// quedan iguales sin copiar la pantalla entera.
+
+#define HAL_DRM_DISPOSITIVO "/dev/dri/card0"
+
+/**
+ * @brief Abre el dispositivo, elige el conector y el modo preferido y
+ *        prepara los dos buffers.
+ * @param disp_buf Se inicializa con los dos buffers (modo directo).
+ * @param drv Se completan flush_cb, direct_mode y la resolución del modo.
+ * @return 0, o -1 si no hay DRM utilizable.
+ */
+int hal_drm_init(lv_disp_draw_buf_t *disp_buf, lv_disp_drv_t *drv);
+
+#endif
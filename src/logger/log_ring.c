@@ -0,0 +1,100 @@
+#include "log_ring.h"
+#include <string.h>
+#include <pthread.h>
+
+#define MASCARA (LOG_RING_CAP - 1)
+
+static LogLinea anillo[LOG_RING_CAP];
+static unsigned long ultimo = 0;        // Secuencia de la más nueva
+static pthread_mutex_t ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Con ring_mutex tomado: la más vieja que sigue en el anillo
+static unsigned long primero(void) {
+    return (ultimo > LOG_RING_CAP) ? ultimo - LOG_RING_CAP + 1 : 1;
+}
+
+static int pasa(const LogLinea *l, int maquina) {
+    return maquina == 0 || l->maquina == maquina;
+}
+
+void log_ring_agregar(LogSeveridad sev, int maquina, const char *texto) {
+    if (!texto) return;
+    size_t n = strcspn(texto, "\n");
+    if (n >= LOG_LINEA_MAX) n = LOG_LINEA_MAX - 1;
+    time_t ahora = time(NULL);
+
+    pthread_mutex_lock(&ring_mutex);
+    unsigned long s = ++ultimo;
+    LogLinea *l = &anillo[s & MASCARA];
+    l->seq = s;
+    l->sev = sev;
+    l->maquina = maquina;
+    l->ts = ahora;
+    memcpy(l->texto, texto, n);
+    l->texto[n] = '\0';
+    pthread_mutex_unlock(&ring_mutex);
+}
+
+unsigned long log_ring_ultimo(void) {
+    pthread_mutex_lock(&ring_mutex);
+    unsigned long s = ultimo;
+    pthread_mutex_unlock(&ring_mutex);
+    return s;
+}
+
+int log_ring_leer(int maquina, unsigned long hasta, LogLinea *out, int max) {
+    int n = 0;
+    pthread_mutex_lock(&ring_mutex);
+    if (hasta == 0 || hasta > ultimo) hasta = ultimo;
+    unsigned long ini = primero();
+    // Hacia atrás desde 'hasta' y después se da vuelta
+    for (unsigned long s = hasta; s >= ini && s > 0 && n < max; s--) {
+        const LogLinea *l = &anillo[s & MASCARA];
+        if (pasa(l, maquina)) out[n++] = *l;
+    }
+    pthread_mutex_unlock(&ring_mutex);
+
+    for (int i = 0; i < n / 2; i++) {
+        LogLinea tmp = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = tmp;
+    }
+    return n;
+}
+
+unsigned long log_ring_mover(int maquina, unsigned long desde, int delta) {
+    unsigned long res = 0;
+    pthread_mutex_lock(&ring_mutex);
+    if (ultimo == 0) {
+        pthread_mutex_unlock(&ring_mutex);
+        return 0;
+    }
+    unsigned long ini = primero();
+    if (desde == 0 || desde > ultimo) desde = ultimo;
+    if (desde < ini) desde = ini;
+
+    // Punto de partida: la que pasa el filtro en 'desde' o antes (si no, después)
+    for (unsigned long s = desde; s >= ini && !res; s--) {
+        if (pasa(&anillo[s & MASCARA], maquina)) res = s;
+    }
+    for (unsigned long s = desde + 1; s <= ultimo && !res; s++) {
+        if (pasa(&anillo[s & MASCARA], maquina)) res = s;
+    }
+
+    while (res && delta < 0) {
+        unsigned long s = res - 1;
+        while (s >= ini && !pasa(&anillo[s & MASCARA], maquina)) s--;
+        if (s < ini) break;
+        res = s;
+        delta++;
+    }
+    while (res && delta > 0) {
+        unsigned long s = res + 1;
+        while (s <= ultimo && !pasa(&anillo[s & MASCARA], maquina)) s++;
+        if (s > ultimo) break;
+        res = s;
+        delta--;
+    }
+    pthread_mutex_unlock(&ring_mutex);
+    return res;
+}
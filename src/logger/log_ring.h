@@ -0,0 +1,51 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <time.h>
+
+// --- ANILLO DE LÍNEAS DE LA CONSOLA ---
+// Capacidad fija: la línea nueva pisa a la más vieja, así que agregar cuesta
+// lo mismo tras una hora que tras un mes. Cada línea lleva un número de
+// secuencia creciente (1, 2, ...) que sirve para anclar la vista. Se puede
+// escribir desde cualquier hilo.
+
+#define LOG_RING_CAP    512     // Potencia de 2
+#define LOG_LINEA_MAX   96
+
+typedef enum {
+    LOG_INFO = 0,
+    LOG_AVISO,
+    LOG_ERROR
+} LogSeveridad;
+
+typedef struct {
+    unsigned long seq;
+    LogSeveridad sev;
+    int maquina;                // 0 = general
+    time_t ts;
+    char texto[LOG_LINEA_MAX];
+} LogLinea;
+
+// O(1). El texto se corta en LOG_LINEA_MAX y en el primer '\n'.
+void log_ring_agregar(LogSeveridad sev, int maquina, const char *texto);
+
+// Secuencia de la última línea (0 = vacío). Cambia con cada línea nueva.
+unsigned long log_ring_ultimo(void);
+
+/**
+ * @brief Copia las últimas líneas que pasan el filtro, de la más vieja a la
+ * más nueva, terminando en la secuencia hasta (0 = la más nueva).
+ * @param maquina Filtro: 0 = todas, si no solo las de esa máquina.
+ * @return Cantidad copiada (<= max).
+ */
+int log_ring_leer(int maquina, unsigned long hasta, LogLinea *out, int max);
+
+/**
+ * @brief Secuencia de la línea que queda delta líneas (filtradas) más allá
+ * de desde (negativo = más viejas). Se detiene en la primera y la última
+ * que quedan en el anillo. desde = 0 es la más nueva.
+ * @return 0 si no hay ninguna línea que pase el filtro.
+ */
+unsigned long log_ring_mover(int maquina, unsigned long desde, int delta);
+
+#endif
@@ -1,4 +1,5 @@
 #include "logger.h"
+#include "log_ring.h"
 #include <stdio.h>
 #include <time.h>
 #include <string.h>
@@ -13,7 +14,22 @@ void logger_init(void) {
     }
 }
 
+// Severidad en la consola: por el tipo y por lo que contestó el controlador
+static LogSeveridad severidad(const char* tipo, const char* mensaje) {
+    if (strcmp(tipo, "ERROR") == 0 || strstr(mensaje, "error:") || strstr(mensaje, "ALARM")) return LOG_ERROR;
+    if (strcmp(tipo, "ALERTA") == 0 || strcmp(tipo, "ADVERTENCIA") == 0) return LOG_AVISO;
+    return LOG_INFO;
+}
+
 void logger_log(const char* tipo, const char* mensaje) {
+    logger_log_maquina(tipo, 0, mensaje);
+}
+
+void logger_log_maquina(const char* tipo, int maquina, const char* mensaje) {
+    char linea[LOG_LINEA_MAX];
+    snprintf(linea, sizeof(linea), "[%s] %s", tipo, mensaje);
+    log_ring_agregar(severidad(tipo, mensaje), maquina, linea);
+
     time_t now;
     struct tm *t;
     char fecha[64];
@@ -9,5 +9,9 @@ void logger_init(void);
 // Mensaje: "Maquina 1 inicio corte", "Fallo conexion WiFi"
 void logger_log(const char* tipo, const char* mensaje);
 
+// Igual, a nombre de una máquina (0 = general). Además del archivo, la línea
+// va al anillo de la consola (log_ring.h) para que se vea en pantalla.
+void logger_log_maquina(const char* tipo, int maquina, const char* mensaje);
+
 #endif
 
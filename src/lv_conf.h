@@ -8,14 +8,21 @@
 
 #define LV_CONF_SKIP 0  // <--- ESTO ENCIENDE LA CONFIGURACIÓN
 
-// Pantalla
+// Pantalla (perfil RGB565: cmake -DCNC_COLOR_16=ON, ver CMakeLists.txt)
+#ifndef LV_COLOR_DEPTH
 #define LV_COLOR_DEPTH 32
+#endif
+#ifndef LV_COLOR_16_SWAP
 #define LV_COLOR_16_SWAP 0
+#endif
 #define LV_DPI_DEF 145  // Ajuste para pantalla de 7 pulgadas
 
-// Memoria
-#define LV_MEM_CUSTOM 0
-#define LV_MEM_SIZE (4096 * 1024U) // <--- AUMENTADO A 4MB (Antes 128KB)
+// Memoria: slabs por tamaño + arena, con telemetría (src/mem/heap_pool.h)
+#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM_INCLUDE "mem/heap_pool.h"
+#define LV_MEM_CUSTOM_ALLOC   heap_alloc
+#define LV_MEM_CUSTOM_FREE    heap_free
+#define LV_MEM_CUSTOM_REALLOC heap_realloc
 
 // Funcionalidades
 #define LV_USE_LOG 1
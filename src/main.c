@@ -4,124 +4,127 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <time.h>
+#include <curl/curl.h>
 
 #include "lvgl.h"
-#include "sdl/sdl.h"
+#include "hal/hal.h"
 #include "mqtt/mqtt_service.h"
 #include "files/file_manager.h"
 #include "logger/logger.h"
+#include "aws/order_sync.h"
+#include "aws/aws_service.h"
+#include "scheduler/job_scheduler.h"
+#include "websocket/ws_pool.h"
+#include "config/machine_config.h"
+#include "discovery/discovery.h"
+#include "timer/timer_wheel.h"
+#include "mem/heap_pool.h"
 #include "ui/ui.h"
 #include "ui/ui_logic.h"
+#include "ui/ui_flota.h"
+#include "ui/ui_consola.h"
+#include "ui/ui_pantallas.h"
+#include "ui/ui_memoria.h"
+#include "ui/ui_dro.h"
 
-// --- NO AWS ---
 
 SystemState global_state;
 pthread_mutex_t state_mutex;
-lv_obj_t * cursor_obj;
 extern int mqtt_conectado;
 extern int maquina_activa_id; // Viene de ui_events.c
 extern void ActualizarRollerMaquinas(void); // Nueva función
 
-// Externos UI
-extern lv_obj_t * ui_agregarTareas;
-extern lv_obj_t * ui_btnAtras;
-extern lv_obj_t * ui_asignarTarea;
-extern lv_obj_t * ui_areaComands;
-
-// Funciones Externas (Coinciden con ui_events.c)
-extern void IrSeleccionarTarea(lv_event_t * e);
-extern void retrocederMain(lv_event_t * e);
-extern void EnviarArchivoDesdeRoller(lv_event_t * e);
-extern void agregar_tarea(lv_event_t * e); // Usamos el nombre de SquareLine
-extern void asignar_tarea(lv_event_t * e); // Usamos el nombre de SquareLine
-
-void hal_init(void) {
-    sdl_init();
-    static lv_disp_draw_buf_t disp_buf;
-    static lv_color_t buf[SDL_HOR_RES * 100];
-    lv_disp_draw_buf_init(&disp_buf, buf, NULL, SDL_HOR_RES * 100);
-    static lv_disp_drv_t disp_drv;
-    lv_disp_drv_init(&disp_drv);
-    disp_drv.draw_buf = &disp_buf;
-    disp_drv.flush_cb = sdl_display_flush;
-    disp_drv.hor_res = SDL_HOR_RES;
-    disp_drv.ver_res = SDL_VER_RES;
-    lv_disp_drv_register(&disp_drv);
-
-    static lv_indev_drv_t indev_drv;
-    lv_indev_drv_init(&indev_drv);
-    indev_drv.type = LV_INDEV_TYPE_POINTER;
-    indev_drv.read_cb = sdl_mouse_read;
-    lv_indev_t * mouse_indev = lv_indev_drv_register(&indev_drv);
-
-    cursor_obj = lv_label_create(lv_scr_act());
-    lv_label_set_text(cursor_obj, "+");
-    lv_indev_set_cursor(mouse_indev, cursor_obj);
-}
+#define EXPORTAR_ESTADO_MS 5000
 
+// Métricas del gateway para quien las lea desde afuera (heap de LVGL incluido)
 void exportar_estado_json() {
-    FILE *f = fopen("state.json", "w");
-    if (f) { fprintf(f, "{\"ts\": %ld}", time(NULL)); fclose(f); }
+    HeapStats h;
+    heap_stats(&h);
+    FILE *f = fopen("state.json.tmp", "w");
+    if (!f) return;
+    fprintf(f, "{\"ts\": %ld, \"heap\": {\"usado\": %zu, \"pico\": %zu, \"reservado\": %zu, "
+               "\"arena\": %zu, \"presupuesto\": %lu, \"frag_pct\": %d, \"slabs\": %d, "
+               "\"allocs\": %lu, \"frees\": %lu, \"allocs_frame\": %lu}}\n",
+            time(NULL), h.usado, h.pico, h.reservado, h.arena, HEAP_PRESUPUESTO, h.frag_pct,
+            h.slabs, h.allocs, h.frees, h.allocs_frame);
+    fclose(f);
+    rename("state.json.tmp", "state.json");     // Quien lee nunca ve un archivo a medias
 }
 
 void* thread_ui_loop(void* arg) {
     lv_init();
-    hal_init();
+    hal_init(hal_backend_env(), 1);     // CNC_HAL=offscreen: sin ventana
     ui_init();
     ui_init_custom_label();
+    ui_flota_acceso_init();
+    InicializarListaMaquinas();   // Roller y pasos de jog desde machine_config.json
 
-    if (ui_areaComands) {
-        lv_obj_clear_flag(ui_areaComands, LV_OBJ_FLAG_CLICK_FOCUSABLE);
-        lv_obj_add_flag(ui_areaComands, LV_OBJ_FLAG_SCROLLABLE);
-    }
-
-    // --- PARCHES MANUALES (Usamos las funciones wrapper) ---
-    if (ui_agregarTareas) {
-        lv_obj_add_flag(ui_agregarTareas, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_remove_event_cb(ui_agregarTareas, NULL);
-        lv_obj_add_event_cb(ui_agregarTareas, agregar_tarea, LV_EVENT_CLICKED, NULL);
-    }
-    if (ui_btnAtras) {
-        lv_obj_add_flag(ui_btnAtras, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_remove_event_cb(ui_btnAtras, NULL);
-        lv_obj_add_event_cb(ui_btnAtras, retrocederMain, LV_EVENT_CLICKED, NULL);
-    }
-    if (ui_asignarTarea) {
-        lv_obj_add_flag(ui_asignarTarea, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_remove_event_cb(ui_asignarTarea, NULL);
-        lv_obj_add_event_cb(ui_asignarTarea, asignar_tarea, LV_EVENT_CLICKED, NULL);
-    }
-    // -----------------------------------------------------
+    ui_consola_init();      // Consola con anillo de líneas en lugar del textarea
+    // Las pantallas quedan armadas: navegar es cargar la que ya existe, y los
+    // eventos de SquareLine (ui_event_*) ya llaman a agregar_tarea/retrocederMain/
+    // asignar_tarea, así que no hace falta volver a engancharlos
+    ui_pantallas_init();
+    ui_memoria_init();      // CNC_DEBUG_HEAP=1: overlay con el heap de LVGL
 
     int ultimo_conn = -1;
+    long ultimo_export = 0;
+    unsigned int version_ordenes = order_sync_version();
+    unsigned int version_config = config_version();
     while(1) {
         lv_timer_handler();
 
+        // Llegaron órdenes/archivos nuevos y el operador está eligiendo tarea
+        unsigned int v = order_sync_version();
+        if (v != version_ordenes) {
+            version_ordenes = v;
+            if (lv_scr_act() == ui_seleccionarTarea) RefrescarListaArchivos(NULL);
+        }
+
+        // Se editó machine_config.json: nombres, máquinas nuevas, perfiles de jog
+        unsigned int vc = config_version();
+        if (vc != version_config) {
+            version_config = vc;
+            pthread_mutex_lock(&state_mutex);
+            ActualizarRollerMaquinas();
+            ui_flota_lista();
+            pthread_mutex_unlock(&state_mutex);
+            CargarPasosJog();
+        }
+
         pthread_mutex_lock(&state_mutex);
 
         // A. SI HAY MÁQUINAS NUEVAS -> ACTUALIZAR ROLLER
         if (global_state.lista_cambio) {
             ActualizarRollerMaquinas();
+            ui_flota_lista();
             global_state.lista_cambio = 0;
         }
 
-        // B. SI HAY DATOS NUEVOS
-        if (global_state.hay_actualizacion) {
-            int id_actualizada = global_state.ultima_maquina_actualizada_id;
-
-            // Solo actualizamos la pantalla si es la máquina que estamos mirando
-            if (id_actualizada == maquina_activa_id) {
-                int idx = id_actualizada - 1;
-                ui_update_ip_display(global_state.maquinas[idx].ip);
-                ui_update_coords(global_state.maquinas[idx].pos_x,
-                                 global_state.maquinas[idx].pos_y,
-                                 global_state.maquinas[idx].pos_z);
-                ui_update_status(global_state.maquinas[idx].estado);
-            }
-            global_state.hay_actualizacion = 0;
+        // B. MÁQUINA SELECCIONADA: se mira su versión y su último reporte de
+        //    posición (no solo la última que avisó, que se pisa si reportan dos
+        //    en la misma vuelta); ui_dro se queda con la copia para dibujar sin
+        //    el mutex
+        if (maquina_activa_id >= 1 && maquina_activa_id <= MAX_MAQUINAS) {
+            ui_dro_muestrear(maquina_activa_id, &global_state.maquinas[maquina_activa_id - 1]);
         }
+        global_state.hay_actualizacion = 0;
         pthread_mutex_unlock(&state_mutex);
 
+        // Entre reportes, la posición estimada; solo los labels cuyo texto cambió (ui_binding.h)
+        ui_dro_refrescar();
+
+        // C. PANTALLA DE FLOTA: solo las tarjetas visibles cuya máquina cambió
+        ui_flota_refrescar();
+        ui_consola_refrescar();
+        ui_pantallas_mantener();
+        ui_memoria_refrescar();
+
+        long ahora = (long)time(NULL) * 1000L;
+        if (ahora - ultimo_export >= EXPORTAR_ESTADO_MS) {
+            ultimo_export = ahora;
+            exportar_estado_json();
+        }
+
         usleep(5000);
     }
     return NULL;
@@ -131,13 +134,21 @@ int main() {
     logger_init();
     pthread_mutex_init(&state_mutex, NULL);
     memset(&global_state, 0, sizeof(SystemState));
+    // Una sola vez y antes de los hilos: dos hilos usan curl y el init global no es reentrante
+    curl_global_init(CURL_GLOBAL_ALL);
 
-    pthread_t t_ui, t_mqtt;
+    pthread_t t_ui, t_mqtt, t_sync, t_sched, t_ws, t_cfg, t_disc, t_timer, t_aws;
 
+    // Primero la rueda: latidos, backoff y timeouts cuelgan de ella
+    pthread_create(&t_timer, NULL, thread_timer_loop, NULL);
     pthread_create(&t_mqtt, NULL, thread_mqtt_loop, NULL);
+    pthread_create(&t_ws, NULL, thread_ws_pool_loop, NULL);
     pthread_create(&t_ui, NULL, thread_ui_loop, NULL);
-
-    // SIN HILO AWS
+    pthread_create(&t_sync, NULL, thread_order_sync_loop, NULL);
+    pthread_create(&t_sched, NULL, thread_scheduler_loop, NULL);
+    pthread_create(&t_cfg, NULL, thread_config_watch_loop, NULL);
+    pthread_create(&t_disc, NULL, thread_discovery_loop, NULL);
+    pthread_create(&t_aws, NULL, thread_aws_loop, NULL);
 
     pthread_join(t_mqtt, NULL);
     pthread_join(t_ui, NULL);
@@ -0,0 +1,259 @@
+#include "heap_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define N_SLABS     ((int)(HEAP_REGION / HEAP_SLAB))
+#define NINGUNO     (-1)
+
+static const size_t clase_tam[HEAP_CLASES] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+typedef struct {
+    void *libres;               // Bloques devueltos (lista dentro de los mismos bloques)
+    unsigned int virgen;        // Offset del primer bloque nunca entregado
+    unsigned short usados;
+    unsigned short total;
+    int clase;                  // NINGUNO = slab sin asignar
+    int ant, sig;               // Lista de parciales de su clase (o de slabs libres)
+} Slab;
+
+// Encabezado de la arena: conserva la alineación de malloc
+typedef union {
+    size_t tam;
+    max_align_t alineacion;
+} Encabezado;
+
+static char *region = NULL;
+static Slab slabs[N_SLABS];
+static int slab_tope = 0;                   // Desde acá, nunca usados
+static int slab_libres = NINGUNO;           // Devueltos, para reusar
+static int parciales[HEAP_CLASES];          // Slabs con lugar, por clase
+static int n_parciales[HEAP_CLASES];
+static unsigned char clase_de_tam[HEAP_BLOQUE_MAX / 16 + 1];   // (n + 15) / 16 -> clase
+
+static HeapStats st;
+static unsigned long allocs_marca = 0;
+static pthread_mutex_t heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t heap_once = PTHREAD_ONCE_INIT;
+
+static void heap_init(void) {
+    void *r = mmap(NULL, HEAP_REGION, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (r == MAP_FAILED) printf("[HEAP] Sin región para slabs: todo va a la arena\n");
+    else region = r;
+
+    for (int c = 0; c < HEAP_CLASES; c++) parciales[c] = NINGUNO;
+    int c = 0;
+    for (size_t i = 0; i <= HEAP_BLOQUE_MAX / 16; i++) {
+        while (clase_tam[c] < i * 16) c++;
+        clase_de_tam[i] = c;
+    }
+}
+
+size_t heap_clase_tam(int clase) {
+    return (clase >= 0 && clase < HEAP_CLASES) ? clase_tam[clase] : 0;
+}
+
+static int en_region(const void *p) {
+    return region && (const char *)p >= region && (const char *)p < region + HEAP_REGION;
+}
+
+// --------------------------------------------------------------------------
+// Slabs
+// --------------------------------------------------------------------------
+static void parcial_agregar(int s) {
+    int c = slabs[s].clase;
+    slabs[s].ant = NINGUNO;
+    slabs[s].sig = parciales[c];
+    if (parciales[c] != NINGUNO) slabs[parciales[c]].ant = s;
+    parciales[c] = s;
+    n_parciales[c]++;
+}
+
+static void parcial_quitar(int s) {
+    int c = slabs[s].clase;
+    if (slabs[s].ant != NINGUNO) slabs[slabs[s].ant].sig = slabs[s].sig;
+    else parciales[c] = slabs[s].sig;
+    if (slabs[s].sig != NINGUNO) slabs[slabs[s].sig].ant = slabs[s].ant;
+    n_parciales[c]--;
+}
+
+static int slab_nuevo(int clase) {
+    int s;
+    if (slab_libres != NINGUNO) {
+        s = slab_libres;
+        slab_libres = slabs[s].sig;
+    } else if (region && slab_tope < N_SLABS) {
+        s = slab_tope++;
+    } else {
+        return NINGUNO;
+    }
+    Slab *sl = &slabs[s];
+    sl->libres = NULL;
+    sl->virgen = 0;
+    sl->usados = 0;
+    sl->total = HEAP_SLAB / clase_tam[clase];
+    sl->clase = clase;
+    parcial_agregar(s);
+    st.slabs++;
+    st.reservado += HEAP_SLAB;
+    return s;
+}
+
+// Vacío y con otro parcial de la misma clase: vuelve al sistema. El último
+// parcial se queda para no crear y soltar un slab en cada alloc/free.
+static void slab_soltar(int s) {
+    parcial_quitar(s);
+    madvise(region + (size_t)s * HEAP_SLAB, HEAP_SLAB, MADV_DONTNEED);
+    slabs[s].clase = NINGUNO;
+    slabs[s].sig = slab_libres;
+    slab_libres = s;
+    st.slabs--;
+    st.reservado -= HEAP_SLAB;
+}
+
+static void *slab_alloc(int clase) {
+    int s = parciales[clase];
+    if (s == NINGUNO) s = slab_nuevo(clase);
+    if (s == NINGUNO) return NULL;
+
+    Slab *sl = &slabs[s];
+    void *b;
+    if (sl->libres) {
+        b = sl->libres;
+        sl->libres = *(void **)b;
+    } else {
+        b = region + (size_t)s * HEAP_SLAB + sl->virgen;
+        sl->virgen += clase_tam[clase];
+    }
+    if (++sl->usados == sl->total) parcial_quitar(s);
+
+    st.usado += clase_tam[clase];
+    st.bloques[clase]++;
+    return b;
+}
+
+static void slab_free(void *p) {
+    int s = (int)(((char *)p - region) / HEAP_SLAB);
+    Slab *sl = &slabs[s];
+    int c = sl->clase;
+
+    *(void **)p = sl->libres;
+    sl->libres = p;
+    if (sl->usados-- == sl->total) parcial_agregar(s);
+
+    st.usado -= clase_tam[c];
+    st.bloques[c]--;
+    if (sl->usados == 0 && n_parciales[c] > 1) slab_soltar(s);
+}
+
+// --------------------------------------------------------------------------
+// Arena de respaldo
+// --------------------------------------------------------------------------
+static void *arena_alloc(size_t n) {
+    Encabezado *h = malloc(sizeof(Encabezado) + n);
+    if (!h) return NULL;
+    h->tam = n;
+    st.usado += n;
+    st.arena += n;
+    st.reservado += n;
+    return h + 1;
+}
+
+static void arena_free(void *p) {
+    Encabezado *h = (Encabezado *)p - 1;
+    st.usado -= h->tam;
+    st.arena -= h->tam;
+    st.reservado -= h->tam;
+    free(h);
+}
+
+// --------------------------------------------------------------------------
+// API
+// --------------------------------------------------------------------------
+static void contar_alloc(void) {
+    st.allocs++;
+    if (st.usado > st.pico) st.pico = st.usado;
+}
+
+void *heap_alloc(size_t n) {
+    pthread_once(&heap_once, heap_init);
+    if (n == 0) n = 1;
+
+    pthread_mutex_lock(&heap_mutex);
+    void *p = NULL;
+    if (n <= HEAP_BLOQUE_MAX) p = slab_alloc(clase_de_tam[(n + 15) / 16]);
+    if (!p) p = arena_alloc(n);     // Grande, o la región se llenó
+    if (p) contar_alloc();
+    pthread_mutex_unlock(&heap_mutex);
+    return p;
+}
+
+void heap_free(void *p) {
+    if (!p) return;
+    pthread_mutex_lock(&heap_mutex);
+    if (en_region(p)) slab_free(p);
+    else arena_free(p);
+    st.frees++;
+    pthread_mutex_unlock(&heap_mutex);
+}
+
+void *heap_realloc(void *p, size_t n) {
+    if (!p) return heap_alloc(n);
+    if (n == 0) {
+        heap_free(p);
+        return NULL;
+    }
+
+    size_t viejo;
+    pthread_mutex_lock(&heap_mutex);
+    if (en_region(p)) {
+        int c = slabs[((char *)p - region) / HEAP_SLAB].clase;
+        viejo = clase_tam[c];
+        if (n <= HEAP_BLOQUE_MAX && clase_de_tam[(n + 15) / 16] == c) {
+            pthread_mutex_unlock(&heap_mutex);
+            return p;       // Sigue entrando en el mismo bloque
+        }
+    } else {
+        Encabezado *h = (Encabezado *)p - 1;
+        viejo = h->tam;
+        if (n > HEAP_BLOQUE_MAX) {
+            // De arena a arena: que lo resuelva realloc (puede crecer en el lugar)
+            Encabezado *nuevo = realloc(h, sizeof(Encabezado) + n);
+            if (nuevo) {
+                st.usado += n - viejo;
+                st.arena += n - viejo;
+                st.reservado += n - viejo;
+                nuevo->tam = n;
+                contar_alloc();
+                st.frees++;
+            }
+            pthread_mutex_unlock(&heap_mutex);
+            return nuevo ? nuevo + 1 : NULL;
+        }
+    }
+    pthread_mutex_unlock(&heap_mutex);
+
+    void *q = heap_alloc(n);
+    if (!q) return NULL;
+    memcpy(q, p, viejo < n ? viejo : n);
+    heap_free(p);
+    return q;
+}
+
+void heap_stats(HeapStats *out) {
+    pthread_mutex_lock(&heap_mutex);
+    *out = st;
+    pthread_mutex_unlock(&heap_mutex);
+    out->frag_pct = out->reservado ? (int)((out->reservado - out->usado) * 100 / out->reservado) : 0;
+}
+
+void heap_frame_marcar(void) {
+    pthread_mutex_lock(&heap_mutex);
+    st.allocs_frame = st.allocs - allocs_marca;
+    allocs_marca = st.allocs;
+    pthread_mutex_unlock(&heap_mutex);
+}
@@ -0,0 +1,46 @@
+#ifndef HEAP_POOL_H
+#define HEAP_POOL_H
+
+#include <stddef.h>
+
+// --- HEAP DE LVGL ---
+// Reemplaza al heap estático de 4 MB (LV_MEM_CUSTOM en lv_conf.h). Los
+// objetos chicos (hasta HEAP_BLOQUE_MAX bytes: objetos, estilos, textos de
+// labels) salen de slabs de HEAP_SLAB bytes, uno por clase de tamaño, dentro
+// de una región reservada de HEAP_REGION que el kernel solo respalda al
+// tocarla; un slab vacío se devuelve al sistema. Lo más grande va a una arena
+// de respaldo (malloc con encabezado). Todo se cuenta para la telemetría.
+
+#define HEAP_CLASES         10
+#define HEAP_BLOQUE_MAX     512
+#define HEAP_SLAB           (64 * 1024)
+#define HEAP_REGION         (64UL * 1024 * 1024)    // Virtual; lo residente es lo usado
+#define HEAP_PRESUPUESTO    (3UL * 1024 * 1024)     // Lo que se espera que use la UI
+
+typedef struct {
+    size_t usado;               // Bytes en bloques vivos (slabs + arena)
+    size_t pico;                // Máximo de `usado`
+    size_t reservado;           // Slabs en uso * HEAP_SLAB + arena
+    size_t arena;               // Bytes vivos en la arena de respaldo
+    int frag_pct;               // Reservado que no está en uso (huecos en slabs)
+    int slabs;
+    unsigned long allocs;       // Totales desde el arranque
+    unsigned long frees;
+    unsigned long allocs_frame; // Entre las dos últimas heap_frame_marcar()
+    unsigned long bloques[HEAP_CLASES];     // Vivos por clase
+} HeapStats;
+
+// Para LV_MEM_CUSTOM_ALLOC / _FREE / _REALLOC. Seguras entre hilos.
+void *heap_alloc(size_t n);
+void heap_free(void *p);
+void *heap_realloc(void *p, size_t n);
+
+// Tamaño de bloque de cada clase (para mostrar)
+size_t heap_clase_tam(int clase);
+
+void heap_stats(HeapStats *out);
+
+// Desde el loop de la UI, una vez por vuelta: cierra el conteo del frame
+void heap_frame_marcar(void);
+
+#endif
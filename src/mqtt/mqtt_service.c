@@ -3,8 +3,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <time.h>
+#include <netdb.h>
+#include <arpa/inet.h>
 #include "MQTTAsync.h"
 #include "../ui/ui_logic.h"
+#include "../config/machine_config.h"
+#include "../logger/logger.h"
+#include "../timer/timer_wheel.h"
 
 #define ADDRESS     "tcp://localhost:1883"
 #define CLIENTID    "RPi3_CNC_Central"
@@ -41,6 +48,169 @@ void onConnect(void* context, MQTTAsync_successData* response) {
     MQTTAsync_subscribe(client, TOPIC_SUB, QOS, &opts);
 }
 
+// --------------------------------------------------------------------------
+// Latido: cada reporte (MQTT o WebSocket) vuelve a armar el plazo de su
+// máquina en la rueda de timers; si vence, la máquina pasa a OFFLINE.
+// --------------------------------------------------------------------------
+static TimerNodo latido[MAX_MAQUINAS];
+static pthread_once_t latido_once = PTHREAD_ONCE_INIT;
+
+static void maquina_sin_latido(void *ctx) {
+    int id = (int)(intptr_t)ctx;
+    int caida = 0;
+
+    pthread_mutex_lock(&state_mutex);
+    MaquinaData *m = &global_state.maquinas[id - 1];
+    // Si llegó un reporte mientras vencía, el timer ya está armado otra vez
+    if (!timer_pendiente(&latido[id - 1]) && m->activa) {
+        m->activa = 0;
+        snprintf(m->estado, sizeof(m->estado), "OFFLINE");
+        m->version++;
+        global_state.lista_cambio = 1;
+        global_state.hay_actualizacion = 1;
+        global_state.ultima_maquina_actualizada_id = id;
+        caida = 1;
+    }
+    pthread_mutex_unlock(&state_mutex);
+
+    if (caida) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Maquina %d sin latido: OFFLINE", id);
+        logger_log_maquina("ALERTA", id, msg);
+        printf("[MQTT] Maquina %d sin reportes en %d ms: OFFLINE\n", id, MAQUINA_LATIDO_MS);
+    }
+}
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void latido_init(void) {
+    for (int i = 0; i < MAX_MAQUINAS; i++) {
+        timer_init(&latido[i], maquina_sin_latido, (void *)(intptr_t)(i + 1));
+    }
+}
+
+// --------------------------------------------------------------------------
+// Escritura en global_state (con state_mutex tomado). La comparten MQTT y
+// el sondeo de estado por WebSocket, así la UI no distingue de dónde vino.
+// --------------------------------------------------------------------------
+static MaquinaData *maquina_activar(int id) {
+    MaquinaData *m = &global_state.maquinas[id - 1];
+    // Orden de locks: state_mutex -> rueda, igual que en maquina_sin_latido
+    pthread_once(&latido_once, latido_init);
+    timer_armar(&latido[id - 1], MAQUINA_LATIDO_MS);
+    m->visto_ms = ahora_ms();
+    // Si es nueva, activar bandera para recargar lista
+    if (m->activa == 0) {
+        m->activa = 1;
+        m->feed = -1;
+        m->version++;
+        global_state.lista_cambio = 1;
+    }
+    m->id = id;
+    return m;
+}
+
+static void maquina_set_estado(MaquinaData *m, const char *estado) {
+    if (strncmp(m->estado, estado, sizeof(m->estado) - 1) != 0) {
+        snprintf(m->estado, sizeof(m->estado), "%s", estado);
+        m->version++;
+    }
+}
+
+static void maquina_set_pos(MaquinaData *m, float x, float y, float z) {
+    if (x != m->pos_x || y != m->pos_y || z != m->pos_z) {
+        m->pos_x = x;
+        m->pos_y = y;
+        m->pos_z = z;
+        m->version++;
+    }
+}
+
+void maquina_reportar(int id, const char *estado, const float *pos, long linea, float feed) {
+    if (id < 1 || id > MAX_MAQUINAS) return;
+
+    pthread_mutex_lock(&state_mutex);
+    MaquinaData *m = maquina_activar(id);
+    unsigned int antes = m->version;
+    if (estado) maquina_set_estado(m, estado);
+    if (pos) {
+        maquina_set_pos(m, pos[0], pos[1], pos[2]);
+        m->pos_ms = m->visto_ms;
+        m->feed = feed;
+    }
+    if (linea >= 0) m->linea = (int)linea;     // Como el tópico "linea": no sube la versión
+    // Los reportes repetidos (máquina quieta) no despiertan a la UI
+    if (m->version != antes) {
+        global_state.hay_actualizacion = 1;
+        global_state.ultima_maquina_actualizada_id = id;
+    }
+    pthread_mutex_unlock(&state_mutex);
+}
+
+// ¿El host de machine_config.json ("192.168.1.50" o "cnc1.local") es esta
+// IP? Los nombres se resuelven: si no, una máquina configurada por nombre que
+// el descubrimiento encuentra por IP quedaría con dos IDs. Sin state_mutex,
+// getaddrinfo puede tardar.
+static int host_es_ip(const char *host, const char *ip) {
+    struct in_addr a;
+    if (inet_pton(AF_INET, host, &a) == 1) return strcmp(host, ip) == 0;
+
+    struct addrinfo pista, *res = NULL;
+    memset(&pista, 0, sizeof(pista));
+    pista.ai_family = AF_INET;
+    pista.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &pista, &res) != 0) return 0;
+    int igual = 0;
+    for (struct addrinfo *r = res; r && !igual; r = r->ai_next) {
+        char txt[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &((struct sockaddr_in *)r->ai_addr)->sin_addr, txt, sizeof(txt));
+        igual = strcmp(txt, ip) == 0;
+    }
+    freeaddrinfo(res);
+    return igual;
+}
+
+int maquina_descubierta(const char *ip) {
+    if (!ip || !ip[0]) return 0;
+    const MachinesConfigList *conf = config_acquire();
+    int id = 0;
+
+    // Configurada con esta IP o con un nombre que resuelve a ella
+    for (int i = 1; i <= MAX_MAQUINAS && !id; i++) {
+        const char *fija = config_get_machine_ip(conf, i);
+        if (fija && host_es_ip(fija, ip)) id = i;
+    }
+
+    pthread_mutex_lock(&state_mutex);
+    // ¿Ya la conocemos? (IP anunciada por MQTT o descubierta antes)
+    for (int i = 1; i <= MAX_MAQUINAS && !id; i++) {
+        if (strcmp(global_state.maquinas[i - 1].ip, ip) == 0) id = i;
+    }
+    // Nueva: primer ID sin configurar y sin datos. Queda como candidata
+    // (inactiva y sin latido) hasta que la máquina misma reporte, por MQTT o
+    // por el WebSocket que le abre el pool; si nunca contesta no aparece
+    // como OFFLINE a los MAQUINA_LATIDO_MS.
+    for (int i = 1; i <= MAX_MAQUINAS && !id; i++) {
+        MaquinaData *m = &global_state.maquinas[i - 1];
+        if (!m->activa && m->ip[0] == '\0' && !config_find(conf, i)) {
+            m->id = i;
+            snprintf(m->ip, sizeof(m->ip), "%s", ip);
+            m->version++;
+            global_state.hay_actualizacion = 1;
+            global_state.ultima_maquina_actualizada_id = i;
+            id = i;
+            printf("[DISCOVERY] FluidNC en %s -> Maquina %d (candidata)\n", ip, id);
+        }
+    }
+    pthread_mutex_unlock(&state_mutex);
+    config_release(conf);
+    return id;
+}
+
 int onMessageArrived(void *context, char *topicName, int topicLen, MQTTAsync_message *message) {
     char payload[256];
     int len = message->payloadlen > 255 ? 255 : message->payloadlen;
@@ -53,33 +223,37 @@ int onMessageArrived(void *context, char *topicName, int topicLen, MQTTAsync_mes
         MQTTAsync_free(topicName);
         return 1;
     }
-    int index = id - 1;
-
     pthread_mutex_lock(&state_mutex);
 
-    // Si es nueva, activar bandera para recargar lista
-    if (global_state.maquinas[index].activa == 0) {
-        global_state.maquinas[index].activa = 1;
-        global_state.lista_cambio = 1;
-    }
-    global_state.maquinas[index].id = id;
-
     // --- CLASIFICACIÓN DE MENSAJES ---
 
+    // Solo se sube la versión si el dato cambió de verdad (la nube reporta por delta)
+    MaquinaData *m = maquina_activar(id);
+
     if (strstr(topicName, "estado")) {
-        snprintf(global_state.maquinas[index].estado, 32, "%s", payload);
+        maquina_set_estado(m, payload);
     }
     else if (strstr(topicName, "posicion")) {
         float x,y,z;
         if (sscanf(payload, "POS:%f:%f:%f", &x, &y, &z) == 3) {
-            global_state.maquinas[index].pos_x = x;
-            global_state.maquinas[index].pos_y = y;
-            global_state.maquinas[index].pos_z = z;
+            maquina_set_pos(m, x, y, z);
+            m->pos_ms = m->visto_ms;
+            m->feed = -1;       // La nube no lo manda
+        }
+    }
+    // Progreso del programa: "LN:1234" o solo el número (no se reporta a la nube)
+    else if (strstr(topicName, "linea")) {
+        int ln;
+        if (sscanf(payload, "LN:%d", &ln) == 1 || sscanf(payload, "%d", &ln) == 1) {
+            m->linea = ln;
         }
     }
     // NUEVO: CAPTURAR IP
     else if (strstr(topicName, "ip")) {
-        snprintf(global_state.maquinas[index].ip, 32, "%s", payload);
+        if (strncmp(m->ip, payload, sizeof(m->ip) - 1) != 0) {
+            snprintf(m->ip, sizeof(m->ip), "%s", payload);
+            m->version++;
+        }
         // printf("[MQTT] IP M%d: %s\n", id, payload);
     }
 
@@ -3,7 +3,8 @@
 
 #include <pthread.h>
 
-#define MAX_MAQUINAS 10
+#define MAX_MAQUINAS 64
+#define MAQUINA_LATIDO_MS 15000  // Sin reportes en este plazo, la máquina pasa a OFFLINE
 
 typedef struct {
     int id;
@@ -11,6 +12,11 @@ typedef struct {
     char ip[32];     // <--- NUEVO: IP para WebSocket (ej: "192.168.1.50")
     float pos_x, pos_y, pos_z;
     int activa;      // 1 si está conectada
+    unsigned int version; // Se incrementa cada vez que cambia estado/posición/IP
+    int linea;       // Línea del programa en ejecución (0 = no se sabe)
+    long visto_ms;   // Último reporte (CLOCK_MONOTONIC, 0 = nunca): no sube la versión
+    long pos_ms;     // Último reporte de posición, aunque no haya cambiado (muestra para el DRO)
+    float feed;      // Feed real en mm/min (FS de FluidNC), < 0 = no se sabe: no sube la versión
 } MaquinaData;
 
 typedef struct {
@@ -24,6 +30,26 @@ extern SystemState global_state;
 extern int mqtt_conectado;
 
 void* thread_mqtt_loop(void* arg);
+
+/**
+ * @brief Vuelca un reporte de estado en global_state igual que si hubiera
+ * llegado por MQTT (toma state_mutex).
+ * @param estado NULL si el reporte no trae estado.
+ * @param pos X/Y/Z, o NULL si no trae posición.
+ * @param linea Línea del programa en ejecución, o -1 si no la trae.
+ * @param feed Feed real en mm/min, o -1 si no lo trae.
+ */
+void maquina_reportar(int id, const char *estado, const float *pos, long linea, float feed);
+
+/**
+ * @brief Anota un controlador encontrado por el descubrimiento (toma state_mutex).
+ * Si la IP ya es de una máquina (por MQTT, o por machine_config.json aunque
+ * allí figure con nombre) devuelve ese ID; si no, ocupa el primer ID libre
+ * como candidata: inactiva hasta que la máquina reporte. Puede resolver
+ * nombres: no llamar desde un hilo que no pueda esperar.
+ * @return ID de la máquina, 0 si no quedan IDs libres.
+ */
+int maquina_descubierta(const char *ip);
 // Ya no usamos mqtt_send_command para control, solo para estado/discovery si es necesario
 
 #endif
@@ -0,0 +1,276 @@
+#include "gcode_estimate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+// Lee la siguiente palabra "letra+número" de una línea saltando comentarios.
+// Devuelve 0 al llegar al final de la línea.
+static int siguiente_palabra(const char **pp, char *letra, float *valor) {
+    const char *p = *pp;
+    while (*p) {
+        char c = (char)toupper((unsigned char)*p);
+
+        // Comentarios: (...) o ; hasta fin de línea
+        if (c == ';') break;
+        if (c == '(') {
+            while (*p && *p != ')') p++;
+            if (*p) p++;
+            continue;
+        }
+        if (!isalpha((unsigned char)c)) { p++; continue; }
+
+        char *fin;
+        float v = strtof(p + 1, &fin);
+        if (fin == p + 1) { p++; continue; } // Letra sin número
+
+        *letra = c;
+        *valor = v;
+        *pp = fin;
+        return 1;
+    }
+    *pp = p;
+    return 0;
+}
+
+// Código G/M por diez, para distinguir G90 de G90.1 o G38.2 de G38
+static int codigo(float v) {
+    return (int)lroundf(v * 10.0f);
+}
+
+float gcode_estimar_segundos(const char *ruta, int *lineas) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) return -1.0f;
+
+    float pos[3] = {0, 0, 0};
+    float feed = GCODE_FEED_DEFECTO;
+    float escala = 1.0f;      // 25.4 con G20 (pulgadas)
+    int absoluto = 1;         // G90 por defecto
+    int modo = 0;             // Último G de movimiento (modal)
+    double minutos = 0.0;
+    double segundos_pausa = 0.0;
+    int n_lineas = 0;
+
+    // getline: una línea larga (comentarios de CAM) sigue siendo una sola
+    char *linea = NULL;
+    size_t cap = 0;
+    while (getline(&linea, &cap, f) != -1) {
+        n_lineas++;
+
+        float destino[3] = {pos[0], pos[1], pos[2]};
+        int hay_eje = 0, es_pausa = 0;
+        float pausa = 0;
+
+        const char *p = linea;
+        char c;
+        float v;
+        while (siguiente_palabra(&p, &c, &v)) {
+            switch (c) {
+                case 'G': {
+                    int g = codigo(v);
+                    if (g >= 0 && g <= 30 && g % 10 == 0) modo = g / 10;
+                    else if (g == 40) es_pausa = 1;
+                    else if (g == 200) escala = 25.4f;
+                    else if (g == 210) escala = 1.0f;
+                    else if (g == 900) absoluto = 1;
+                    else if (g == 910) absoluto = 0;
+                    break;
+                }
+                case 'X': case 'Y': case 'Z': {
+                    int eje = c - 'X';
+                    destino[eje] = absoluto ? v * escala : pos[eje] + v * escala;
+                    hay_eje = 1;
+                    break;
+                }
+                case 'F': if (v > 0) feed = v * escala; break;
+                case 'P': pausa = v; break;
+                default: break;
+            }
+        }
+
+        if (es_pausa) {
+            segundos_pausa += pausa; // Grbl/FluidNC: P en segundos
+            continue;
+        }
+        if (!hay_eje) continue;
+
+        float dx = destino[0] - pos[0], dy = destino[1] - pos[1], dz = destino[2] - pos[2];
+        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        float vel = (modo == 0) ? GCODE_VEL_RAPIDA : feed;
+        if (vel > 0) minutos += dist / vel;
+
+        memcpy(pos, destino, sizeof(pos));
+    }
+    free(linea);
+    fclose(f);
+
+    if (lineas) *lineas = n_lineas;
+    return (float)(minutos * 60.0 + segundos_pausa);
+}
+
+GcodeSegmento *gcode_trayecto_cargar(const char *ruta, int *lineas) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) return NULL;
+
+    int cap = 1024, n = 0;
+    GcodeSegmento *seg = malloc(cap * sizeof(GcodeSegmento));
+    float pos[3] = {0, 0, 0};
+    float escala = 1.0f;
+    int absoluto = 1;
+    int modo = 0;
+
+    char *linea = NULL;
+    size_t linea_cap = 0;
+    while (seg && getline(&linea, &linea_cap, f) != -1) {
+        if (n == GCODE_TRAYECTO_MAX_LINEAS) {
+            free(seg);
+            seg = NULL;
+            break;
+        }
+        if (n == cap) {
+            cap *= 2;
+            GcodeSegmento *nuevo = realloc(seg, cap * sizeof(GcodeSegmento));
+            if (!nuevo) free(seg);
+            seg = nuevo;
+            if (!seg) break;
+        }
+
+        int hay_eje = 0;
+        const char *p = linea;
+        char c;
+        float v;
+        while (siguiente_palabra(&p, &c, &v)) {
+            if (c == 'G') {
+                int g = codigo(v);
+                if (g >= 0 && g <= 30 && g % 10 == 0) modo = g / 10;
+                else if (g == 200) escala = 25.4f;
+                else if (g == 210) escala = 1.0f;
+                else if (g == 900) absoluto = 1;
+                else if (g == 910) absoluto = 0;
+            } else if (c >= 'X' && c <= 'Z') {
+                int eje = c - 'X';
+                pos[eje] = absoluto ? v * escala : pos[eje] + v * escala;
+                hay_eje = 1;
+            }
+        }
+        memcpy(seg[n].fin, pos, sizeof(pos));
+        seg[n].modo = hay_eje ? (unsigned char)modo : GCODE_SIN_MOVIMIENTO;
+        n++;
+    }
+    free(linea);
+    fclose(f);
+
+    if (lineas) *lineas = seg ? n : 0;
+    return seg;
+}
+
+int gcode_crear_reanudacion(const char *ruta, int linea, const char *destino) {
+    if (linea < 1) return -1;
+    FILE *f = fopen(ruta, "r");
+    if (!f) return -1;
+
+    // Estado modal acumulado hasta la línea donde se retoma (posiciones en mm).
+    // Un grupo por variable: lo que quede distinto del arranque se vuelve a
+    // escribir antes de la cola copiada.
+    float pos[3] = {0, 0, 0};
+    float z_max = 0;
+    float escala = 1.0f;      // G20 / G21
+    int absoluto = 1;         // G90 / G91
+    int arco = 0;             // G90.1 / G91.1 (0 = el archivo no lo dijo)
+    int movimiento = 0;       // G0 / G1 / G2 / G3 / G80
+    int plano = 17;           // G17 / G18 / G19
+    int inverso = 0;          // G93 (1) / G94 (0)
+    int sistema = 54;         // G54..G59
+    float feed = 0;           // En unidades del archivo, con G94
+    float velocidad = 0;      // S
+    int husillo = 5;          // M3 / M4 / M5
+    int refrigerante = 9;     // M7 / M8 / M9
+
+    // Se cuentan líneas físicas: una larga no corre la numeración
+    char *lbuf = NULL;
+    size_t lcap = 0;
+    int n = 0;
+    while (n < linea - 1 && getline(&lbuf, &lcap, f) != -1) {
+        n++;
+        const char *p = lbuf;
+        char c;
+        float v;
+        while (siguiente_palabra(&p, &c, &v)) {
+            int k = codigo(v);
+            switch (c) {
+                case 'G':
+                    if ((k >= 0 && k <= 30 && k % 10 == 0) || k == 800) movimiento = k / 10;
+                    else if (k == 170 || k == 180 || k == 190) plano = k / 10;
+                    else if (k == 200) escala = 25.4f;
+                    else if (k == 210) escala = 1.0f;
+                    else if (k == 900) absoluto = 1;
+                    else if (k == 910) absoluto = 0;
+                    else if (k == 901 || k == 911) arco = k;
+                    else if (k == 930) inverso = 1;
+                    else if (k == 940) inverso = 0;
+                    else if (k >= 540 && k <= 590 && k % 10 == 0) sistema = k / 10;
+                    break;
+                case 'M':
+                    if (k == 30 || k == 40 || k == 50) husillo = k / 10;
+                    else if (k == 70 || k == 80 || k == 90) refrigerante = k / 10;
+                    break;
+                case 'X': case 'Y': case 'Z': {
+                    int eje = c - 'X';
+                    pos[eje] = absoluto ? v * escala : pos[eje] + v * escala;
+                    if (eje == 2 && pos[2] > z_max) z_max = pos[2];
+                    break;
+                }
+                case 'F': if (v > 0 && !inverso) feed = v; break;
+                case 'S': velocidad = v; break;
+                default: break;
+            }
+        }
+    }
+    free(lbuf);
+    if (n < linea - 1) {
+        fclose(f); // El archivo es más corto que la línea pedida
+        return -1;
+    }
+
+    FILE *out = fopen(destino, "w");
+    if (!out) {
+        fclose(f);
+        return -1;
+    }
+
+    // Preámbulo: subir a altura segura, ir al punto, prender husillo y bajar
+    // (en mm, absoluto, unidades por minuto y plano XY)
+    float z_seguro = (z_max > pos[2]) ? z_max : pos[2];
+    int pre = 0;
+    pre += fprintf(out, "; Reanudacion desde la linea %d\n", linea) > 0;
+    pre += fprintf(out, "G21 G90 G94 G17 G%d\n", sistema) > 0;
+    pre += fprintf(out, "G0 Z%.3f\n", z_seguro) > 0;
+    pre += fprintf(out, "G0 X%.3f Y%.3f\n", pos[0], pos[1]) > 0;
+    if (husillo != 5) {
+        pre += fprintf(out, "M%d S%.0f\n", husillo, velocidad) > 0;
+        pre += fprintf(out, "G4 P3\n") > 0; // Esperar a que el husillo tome velocidad
+    }
+    if (refrigerante != 9) pre += fprintf(out, "M%d\n", refrigerante) > 0;
+    pre += fprintf(out, "G1 Z%.3f F%.1f\n", pos[2], feed > 0 ? feed * escala : GCODE_FEED_DEFECTO) > 0;
+
+    // Modos del programa en el punto de retome: la cola puede seguir con
+    // "X.. Y.. I.. J.." sin repetir G2, el plano ni el modo de avance
+    char modos[64];
+    int m = snprintf(modos, sizeof(modos), "G%d G%d G%d G%d",
+                     escala != 1.0f ? 20 : 21, absoluto ? 90 : 91, plano, inverso ? 93 : 94);
+    if (arco) m += snprintf(modos + m, sizeof(modos) - m, " G%d.1", arco / 10);
+    if (feed > 0 && !inverso) m += snprintf(modos + m, sizeof(modos) - m, " F%.1f", feed);
+    snprintf(modos + m, sizeof(modos) - m, " G%d", movimiento);
+    pre += fprintf(out, "%s\n", modos) > 0;
+
+    // Resto del programa tal cual
+    char buf[4096];
+    size_t leidos;
+    while ((leidos = fread(buf, 1, sizeof(buf), f)) > 0) {
+        fwrite(buf, 1, leidos, out);
+    }
+    fclose(f);
+
+    return (fclose(out) == 0) ? pre : -1;
+}
@@ -0,0 +1,57 @@
+#ifndef GCODE_ESTIMATE_H
+#define GCODE_ESTIMATE_H
+
+// Velocidad que se asume para G0 si la máquina no informa otra (mm/min)
+#define GCODE_VEL_RAPIDA 3000.0f
+
+// Feed que se asume si el archivo mueve con G1 antes de dar un F (mm/min)
+#define GCODE_FEED_DEFECTO 1000.0f
+
+// Más líneas que esto no se cargan como trayecto (16 bytes por línea)
+#define GCODE_TRAYECTO_MAX_LINEAS 50000
+
+#define GCODE_SIN_MOVIMIENTO 0xFF
+
+// Movimiento de una línea del programa
+typedef struct {
+    float fin[3];           // Destino en mm (coordenadas del programa)
+    unsigned char modo;     // 0..3 (G0..G3), o GCODE_SIN_MOVIMIENTO
+} GcodeSegmento;
+
+/**
+ * @brief Estima la duración de un programa G-code recorriendo sus movimientos.
+ * Suma distancia/feed de G0/G1/G2/G3 (arcos aproximados por su cuerda),
+ * respeta G90/G91, G20/G21 y las pausas G4. No modela aceleraciones, así
+ * que es una cota inferior útil para ordenar y repartir trabajos.
+ * @param ruta Archivo .nc/.gcode.
+ * @param lineas Si no es NULL, devuelve la cantidad de líneas del programa.
+ * @return Segundos estimados, o -1 si no se pudo abrir el archivo.
+ */
+float gcode_estimar_segundos(const char *ruta, int *lineas);
+
+/**
+ * @brief Genera un programa que retoma otro desde una línea dada.
+ * Recorre las líneas anteriores para reconstruir el estado modal (modo de
+ * movimiento G0..G3/G80, plano G17..G19, unidades, G90/G91, G90.1/G91.1,
+ * G93/G94, sistema de coordenadas, F, S, husillo, refrigerante y posición),
+ * escribe un preámbulo que sube a altura segura, va al punto, prende el
+ * husillo y baja, vuelve a poner esos modos y después copia el resto del
+ * archivo desde 'linea'. Las líneas se cuentan por '\n', sin importar su largo.
+ * @param ruta Archivo original.
+ * @param linea Primera línea a ejecutar (1 = desde el principio).
+ * @param destino Archivo a generar.
+ * @return Líneas del preámbulo agregado (para traducir números de línea), o -1 si no se pudo.
+ */
+int gcode_crear_reanudacion(const char *ruta, int linea, const char *destino);
+
+/**
+ * @brief Carga el destino de cada línea de un programa (mismo recorrido que
+ * gcode_estimar_segundos: G90/G91, G20/G21, modo modal).
+ * @param ruta Archivo .nc/.gcode.
+ * @param lineas Devuelve la cantidad de líneas cargadas.
+ * @return Arreglo indexado por línea - 1 (liberar con free), o NULL si no se
+ * pudo abrir o pasa de GCODE_TRAYECTO_MAX_LINEAS.
+ */
+GcodeSegmento *gcode_trayecto_cargar(const char *ruta, int *lineas);
+
+#endif
@@ -0,0 +1,593 @@
+#include "job_scheduler.h"
+#include "job_store.h"
+#include "gcode_estimate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../logger/logger.h"
+#include "../aws/order_sync.h"
+#include "../websocket/ws_pool.h"
+#include "../websocket/fluidnc_formatter.h"
+#include "../config/machine_config.h"
+
+extern SystemState global_state;
+extern pthread_mutex_t state_mutex;
+
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Job jobs[SCHED_MAX_JOBS];
+static int siguiente_id = 1;
+
+// Estado de despacho por máquina (índice = id - 1)
+typedef struct {
+    int job_idx;                             // -1 = sin trabajo
+    int visto_trabajando;                    // Ya salió de IDLE tras el despacho
+    int restaurado;                          // Trabajo recuperado del disco tras un reinicio
+    int desfase_linea;                       // Línea reportada + desfase = línea del archivo original
+    int sin_reportes;                        // Pasó a OFFLINE con la pieza en curso: no se sabe cómo terminó
+    int corte_visto;                         // Alarm o Door desde el despacho
+    unsigned int ev_terminados;              // ws_pool_eventos() al despachar
+    unsigned int ev_cortes;
+    time_t t_despacho;
+    char ultimo_subido[MAX_FILENAME_LEN];    // Archivo que ya está en la SD
+} MaquinaSched;
+
+static MaquinaSched maq[MAX_MAQUINAS];
+
+// Órdenes de la nube ya convertidas en trabajos (persistidas en el job store)
+static int ordenes_importadas[JOBSTORE_MAX_ORDENES];
+static int n_importadas = 0;
+
+// --------------------------------------------------------------------------
+// Cola
+// --------------------------------------------------------------------------
+static int crear_job(const char *archivo, int cantidad, int prioridad, int maquina_fija,
+                     int orden_id, float estimado) {
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        if (jobs[i].estado == JOB_LIBRE || jobs[i].estado == JOB_TERMINADO ||
+            jobs[i].estado == JOB_CANCELADO) {
+            Job *j = &jobs[i];
+            memset(j, 0, sizeof(*j));
+            j->id = siguiente_id++;
+            j->orden_id = orden_id;
+            snprintf(j->archivo, sizeof(j->archivo), "%s", archivo);
+            j->cantidad = cantidad;
+            j->prioridad = prioridad;
+            j->maquina_fija = maquina_fija;
+            j->estimado_seg = estimado;
+            j->estado = JOB_EN_COLA;
+            j->creado = time(NULL);
+            job_store_guardar(j, 1);
+            return j->id;
+        }
+    }
+    return -1;
+}
+
+int sched_encolar(const char *archivo, int cantidad, int prioridad, int maquina_fija, int orden_id) {
+    if (!archivo || archivo[0] == '\0' || cantidad < 1) return -1;
+    if (maquina_fija < 0 || maquina_fija > MAX_MAQUINAS) return -1;
+
+    // La estimación lee el archivo: se hace fuera del mutex
+    char ruta[300];
+    snprintf(ruta, sizeof(ruta), "%s/%s", GCODE_DIR, archivo);
+    float estimado = gcode_estimar_segundos(ruta, NULL);
+    if (estimado < 0) estimado = 0;
+
+    pthread_mutex_lock(&sched_mutex);
+    int primero = -1;
+    if (maquina_fija == 0 && cantidad > 1) {
+        // Trabajo libre de varias piezas: una unidad por trabajo para repartirlas
+        for (int k = 0; k < cantidad; k++) {
+            int id = crear_job(archivo, 1, prioridad, 0, orden_id, estimado);
+            if (id < 0) break;
+            if (primero < 0) primero = id;
+        }
+    } else {
+        primero = crear_job(archivo, cantidad, prioridad, maquina_fija, orden_id, estimado);
+    }
+    pthread_mutex_unlock(&sched_mutex);
+
+    char msg[160];
+    if (primero < 0) {
+        snprintf(msg, sizeof(msg), "Cola llena, no se pudo encolar %s", archivo);
+    } else {
+        snprintf(msg, sizeof(msg), "Encolado J%d: %s x%d (M%d, prio %d, ~%.0fs c/u)",
+                 primero, archivo, cantidad, maquina_fija, prioridad, estimado);
+    }
+    logger_log_maquina("SCHED", maquina_fija, msg);
+    return primero;
+}
+
+int sched_cancelar(int job_id) {
+    int ret = -1;
+    pthread_mutex_lock(&sched_mutex);
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        if (jobs[i].id == job_id &&
+            (jobs[i].estado == JOB_EN_COLA || jobs[i].estado == JOB_INTERRUMPIDO)) {
+            jobs[i].estado = JOB_CANCELADO;
+            job_store_guardar(&jobs[i], 1);
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return ret;
+}
+
+// Vuelve a poner en cola un interrumpido, en su misma máquina: la pieza a
+// medio hacer está ahí
+static int reencolar_interrumpido(int job_id, int desde_ultima) {
+    int ret = -1;
+    pthread_mutex_lock(&sched_mutex);
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        Job *j = &jobs[i];
+        if (j->id == job_id && j->estado == JOB_INTERRUMPIDO) {
+            j->maquina_fija = j->maquina_asignada;
+            j->maquina_asignada = 0;
+            j->linea_inicio = (desde_ultima && j->linea > 1) ? j->linea : 0;
+            j->estado = JOB_EN_COLA;
+            job_store_guardar(j, 1);
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return ret;
+}
+
+int sched_reanudar(int job_id) {
+    return reencolar_interrumpido(job_id, 1);
+}
+
+int sched_reiniciar(int job_id) {
+    return reencolar_interrumpido(job_id, 0);
+}
+
+int sched_buscar_interrumpido(int maquina_id, const char *archivo, int *linea) {
+    int id = -1;
+    pthread_mutex_lock(&sched_mutex);
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        Job *j = &jobs[i];
+        if (j->estado == JOB_INTERRUMPIDO && j->maquina_asignada == maquina_id &&
+            (!archivo || strcmp(j->archivo, archivo) == 0)) {
+            id = j->id;
+            if (linea) *linea = j->linea;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return id;
+}
+
+int sched_listar(int maquina_id, Job *out, int max) {
+    int n = 0;
+    pthread_mutex_lock(&sched_mutex);
+    for (int i = 0; i < SCHED_MAX_JOBS && n < max; i++) {
+        Job *j = &jobs[i];
+        int maquina;
+        if (j->estado == JOB_EN_COLA) maquina = j->maquina_fija;
+        else if (j->estado == JOB_CORRIENDO || j->estado == JOB_INTERRUMPIDO) maquina = j->maquina_asignada;
+        else continue;
+        if (maquina == maquina_id) out[n++] = *j;
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return n;
+}
+
+float sched_backlog_segundos(int maquina_id) {
+    if (maquina_id < 1 || maquina_id > MAX_MAQUINAS) return 0;
+    float total = 0;
+    time_t ahora = time(NULL);
+    pthread_mutex_lock(&sched_mutex);
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        Job *j = &jobs[i];
+        int restantes = j->cantidad - j->completadas;
+        if (j->estado == JOB_EN_COLA && j->maquina_fija == maquina_id) {
+            total += restantes * j->estimado_seg;
+        } else if (j->estado == JOB_CORRIENDO && j->maquina_asignada == maquina_id) {
+            float actual = j->estimado_seg - (float)(ahora - maq[maquina_id - 1].t_despacho);
+            total += (actual > 0 ? actual : 0) + (restantes - 1) * j->estimado_seg;
+        }
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return total;
+}
+
+float sched_progreso(int maquina_id) {
+    if (maquina_id < 1 || maquina_id > MAX_MAQUINAS) return -1;
+    float p = -1;
+    time_t ahora = time(NULL);
+    pthread_mutex_lock(&sched_mutex);
+    MaquinaSched *ms = &maq[maquina_id - 1];
+    if (ms->job_idx >= 0 && jobs[ms->job_idx].estado == JOB_CORRIENDO) {
+        Job *j = &jobs[ms->job_idx];
+        // La pieza en curso avanza con el reloj contra la estimación; no
+        // llega a 1 hasta que la máquina vuelve a IDLE
+        float pieza = 0;
+        if (j->estimado_seg > 0) pieza = (float)(ahora - ms->t_despacho) / j->estimado_seg;
+        if (pieza > 0.99f) pieza = 0.99f;
+        if (pieza < 0) pieza = 0;
+        p = (j->cantidad > 0) ? (j->completadas + pieza) / j->cantidad : pieza;
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return p;
+}
+
+int sched_linea_actual(int maquina_id, int reportada, char *archivo, size_t n) {
+    if (maquina_id < 1 || maquina_id > MAX_MAQUINAS) return 0;
+    // Igual que al guardar el progreso en el loop
+    if (SCHED_STREAM_DIRECTO) ws_pool_stream_progreso(maquina_id, &reportada, NULL);
+    if (reportada <= 0) return 0;
+
+    int linea = 0;
+    pthread_mutex_lock(&sched_mutex);
+    MaquinaSched *ms = &maq[maquina_id - 1];
+    if (ms->job_idx >= 0 && jobs[ms->job_idx].estado == JOB_CORRIENDO) {
+        Job *j = &jobs[ms->job_idx];
+        linea = reportada + ms->desfase_linea;
+        if (linea < j->linea_inicio) linea = j->linea_inicio;
+        snprintf(archivo, n, "%s", j->archivo);
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return linea;
+}
+
+// Mejor trabajo en cola para una máquina: prioridad, luego el más largo, luego el más viejo
+static int elegir_job(int maquina_id) {
+    int mejor = -1;
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        Job *j = &jobs[i];
+        if (j->estado != JOB_EN_COLA) continue;
+        if (j->maquina_fija != 0 && j->maquina_fija != maquina_id) continue;
+        if (mejor < 0) { mejor = i; continue; }
+
+        Job *b = &jobs[mejor];
+        if (j->prioridad != b->prioridad) {
+            if (j->prioridad > b->prioridad) mejor = i;
+        } else if (j->estimado_seg != b->estimado_seg) {
+            if (j->estimado_seg > b->estimado_seg) mejor = i;
+        } else if (j->id < b->id) {
+            mejor = i;
+        }
+    }
+    return mejor;
+}
+
+// Foto de los contadores del pool al despachar una pieza. Con sched_mutex tomado.
+static void marcar_despacho(MaquinaSched *ms, unsigned int terminados, unsigned int cortes) {
+    ms->visto_trabajando = 0;
+    ms->sin_reportes = 0;
+    ms->corte_visto = 0;
+    ms->ev_terminados = terminados;
+    ms->ev_cortes = cortes;
+}
+
+// --------------------------------------------------------------------------
+// Recuperación tras reinicio
+// --------------------------------------------------------------------------
+static void restaurar_estado(void) {
+    pthread_mutex_lock(&sched_mutex);
+    if (job_store_abrir(jobs, ordenes_importadas, &n_importadas) < 0) {
+        logger_log("SCHED", "No se pudo abrir el almacen de trabajos, la cola no se guarda");
+    }
+
+    time_t ahora = time(NULL);
+    char msg[200];
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        Job *j = &jobs[i];
+        if (j->estado == JOB_LIBRE) continue;
+        if (j->id >= siguiente_id) siguiente_id = j->id + 1;
+
+        if (j->estado == JOB_CORRIENDO && j->maquina_asignada >= 1 && j->maquina_asignada <= MAX_MAQUINAS) {
+            // La máquina corre desde su SD: puede que siga trabajando. Se vuelve
+            // a vigilar; si no se la ve trabajando, queda como interrumpido.
+            MaquinaSched *ms = &maq[j->maquina_asignada - 1];
+            ms->job_idx = i;
+            unsigned int terminados, cortes;
+            ws_pool_eventos(j->maquina_asignada, &terminados, &cortes);
+            marcar_despacho(ms, terminados, cortes);
+            ms->restaurado = 1;
+            ms->t_despacho = ahora;
+            snprintf(ms->ultimo_subido, sizeof(ms->ultimo_subido), "%s", j->archivo);
+        } else if (j->estado == JOB_CORRIENDO) {
+            j->estado = JOB_EN_COLA;
+            j->maquina_asignada = 0;
+            job_store_guardar(j, 1);
+        } else if (j->estado == JOB_INTERRUMPIDO) {
+            snprintf(msg, sizeof(msg), "J%d (%s) interrumpido en M%d, linea %d: se puede reanudar",
+                     j->id, j->archivo, j->maquina_asignada, j->linea);
+            logger_log_maquina("SCHED", j->maquina_asignada, msg);
+        }
+    }
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+// --------------------------------------------------------------------------
+// Importar órdenes de la nube
+// --------------------------------------------------------------------------
+static int orden_ya_importada(int id) {
+    for (int i = 0; i < n_importadas; i++) {
+        if (ordenes_importadas[i] == id) return 1;
+    }
+    return 0;
+}
+
+static void importar_ordenes(void) {
+    static OrdenesSnapshot lista;
+    order_sync_get(&lista);
+
+    for (int i = 0; i < lista.count; i++) {
+        Orden *o = &lista.ordenes[i];
+        if (o->id <= 0 || orden_ya_importada(o->id)) continue;
+
+        // Esperar a que el archivo esté descargado
+        char ruta[300];
+        snprintf(ruta, sizeof(ruta), "%s/%s", GCODE_DIR, o->archivo_nombre);
+        if (access(ruta, R_OK) != 0) continue;
+
+        // "cnc2" -> máquina 2; cualquier otra cosa = libre
+        int maquina = 0;
+        if (sscanf(o->maquina, "cnc%d", &maquina) != 1 || maquina < 1 || maquina > MAX_MAQUINAS) {
+            maquina = 0;
+        }
+
+        sched_encolar(o->archivo_nombre, o->cantidad > 0 ? o->cantidad : 1,
+                      SCHED_PRIORIDAD_NORMAL, maquina, o->id);
+
+        pthread_mutex_lock(&sched_mutex);
+        job_store_orden_importada(ordenes_importadas, &n_importadas, o->id);
+        pthread_mutex_unlock(&sched_mutex);
+    }
+}
+
+// --------------------------------------------------------------------------
+// Despacho
+// --------------------------------------------------------------------------
+static int estado_es_idle(const char *estado) {
+    return strncasecmp(estado, "Idle", 4) == 0;
+}
+
+static int estado_es_corte(const char *estado) {
+    return strncasecmp(estado, "Alarm", 5) == 0 || strncasecmp(estado, "Door", 4) == 0;
+}
+
+// Sube (si hace falta) y arranca el archivo. Se llama SIN sched_mutex.
+static int despachar(int maquina_id, const char *ip, const char *path, const char *sd_nombre, int subir) {
+    if (SCHED_STREAM_DIRECTO) {
+        // Sin SD: el pool manda el archivo con conteo de caracteres
+        if (!ws_pool_conectada(maquina_id) || ws_pool_stream_iniciar(maquina_id, path) != 0) return -1;
+        char msg[200];
+        snprintf(msg, sizeof(msg), "M%d: streameando %s", maquina_id, sd_nombre);
+        logger_log_maquina("SCHED", maquina_id, msg);
+        return 0;
+    }
+
+    // La subida va al puerto HTTP de la máquina (80 salvo que machine_config.json diga otro)
+    char destino[80];
+    const MachinesConfigList *conf = config_acquire();
+    const MachineConfig *mc = config_find(conf, maquina_id);
+    if (mc && mc->http_port != CONFIG_DEFAULT_HTTP_PORT) snprintf(destino, sizeof(destino), "%s:%d", ip, mc->http_port);
+    else snprintf(destino, sizeof(destino), "%s", ip);
+    config_release(conf);
+
+    if (subir && upload_file_to_sd(destino, path, sd_nombre) != 0) {
+        return -1;
+    }
+
+    char comando[FLUIDNC_CMD_MAX + 64];
+    snprintf(comando, sizeof(comando), "$SD/Run=/%s", sd_nombre);
+    WsRespuesta r;
+    if (ws_pool_comando(maquina_id, comando, WS_POOL_TIMEOUT_MS, &r) != WS_RES_OK) {
+        return -1;
+    }
+
+    char msg[200];
+    snprintf(msg, sizeof(msg), "M%d: despachado %s", maquina_id, sd_nombre);
+    logger_log_maquina("SCHED", maquina_id, msg);
+    return 0;
+}
+
+// Despachado y nunca se la vio trabajando. Con sched_mutex tomado.
+static void no_arranco(int id, MaquinaSched *ms, Job *j) {
+    char msg[200];
+    if (ms->restaurado) {
+        // Venía corriendo antes del reinicio y la máquina ya está quieta
+        snprintf(msg, sizeof(msg), "M%d: J%d interrumpido en linea %d, se puede reanudar",
+                 id, j->id, j->linea);
+        j->estado = JOB_INTERRUMPIDO;
+    } else {
+        snprintf(msg, sizeof(msg), "M%d: J%d no arrancó, vuelve a la cola", id, j->id);
+        j->estado = JOB_EN_COLA;
+        j->maquina_asignada = 0;
+        ms->ultimo_subido[0] = '\0';
+    }
+    logger_log_maquina("SCHED", id, msg);
+    job_store_guardar(j, 1);
+    ms->job_idx = -1;
+    ms->restaurado = 0;
+}
+
+static void tick(void) {
+    // Copia del estado de la flota (MQTT) para no retener state_mutex
+    MaquinaData flota[MAX_MAQUINAS];
+    pthread_mutex_lock(&state_mutex);
+    memcpy(flota, global_state.maquinas, sizeof(flota));
+    pthread_mutex_unlock(&state_mutex);
+
+    time_t ahora = time(NULL);
+
+    for (int i = 0; i < MAX_MAQUINAS; i++) {
+        int id = i + 1;
+        MaquinaData *m = &flota[i];
+        MaquinaSched *ms = &maq[i];
+        int idle = m->activa && estado_es_idle(m->estado);
+        unsigned int ev_terminados, ev_cortes;
+        ws_pool_eventos(id, &ev_terminados, &ev_cortes);
+
+        char archivo[MAX_FILENAME_LEN] = "";
+        int subir = 0, linea_inicio = 0;
+        char msg[200];
+
+        pthread_mutex_lock(&sched_mutex);
+
+        if (ms->job_idx >= 0) {
+            Job *j = &jobs[ms->job_idx];
+            if (!m->activa) {
+                // OFFLINE: no se sabe si sigue cortando (Wi-Fi) o si se apagó.
+                // No cuenta como trabajando ni como quieta; el plazo de
+                // arranque sigue corriendo.
+                if (ms->visto_trabajando && !ms->sin_reportes) {
+                    ms->sin_reportes = 1;
+                    snprintf(msg, sizeof(msg), "M%d: sin reportes con J%d en curso (linea %d)", id, j->id, j->linea);
+                    logger_log_maquina("SCHED", id, msg);
+                } else if (!ms->visto_trabajando && ahora - ms->t_despacho > SCHED_TIMEOUT_ARRANQUE) {
+                    no_arranco(id, ms, j);
+                }
+            } else if (!idle) {
+                ms->visto_trabajando = 1;
+                ms->restaurado = 0;
+                ms->sin_reportes = 0;   // Volvió y sigue en la pieza
+                if (estado_es_corte(m->estado)) ms->corte_visto = 1;
+
+                // Progreso: se guarda sin fsync, alcanza con perder el último tramo
+                int reportada = m->linea;
+                if (SCHED_STREAM_DIRECTO) ws_pool_stream_progreso(id, &reportada, NULL);
+                int linea = (reportada > 0) ? reportada + ms->desfase_linea : 0;
+                if (linea > 0 && linea < j->linea_inicio) linea = j->linea_inicio;
+                if (linea > 0 && linea != j->linea) {
+                    j->linea = linea;
+                    job_store_guardar(j, 0);
+                }
+            } else if (ms->visto_trabajando &&
+                       (ms->sin_reportes || ms->corte_visto || ev_cortes != ms->ev_cortes ||
+                        ev_terminados == ms->ev_terminados)) {
+                // Volvió a Idle sin que el programa termine limpio: se cortó la
+                // luz, hubo una alarma (y se desbloqueó) o un reset a mitad de
+                // pieza. No se acredita; se puede reanudar desde la línea.
+                const char *motivo = ms->sin_reportes ? "tras perder reportes" :
+                                     (ms->corte_visto || ev_cortes != ms->ev_cortes) ? "tras una alarma o reset" :
+                                     "sin aviso de fin de programa";
+                snprintf(msg, sizeof(msg), "M%d: J%d volvio a Idle %s, interrumpido en linea %d",
+                         id, j->id, motivo, j->linea);
+                logger_log_maquina("SCHED", id, msg);
+                j->estado = JOB_INTERRUMPIDO;
+                job_store_guardar(j, 1);
+                ms->job_idx = -1;
+                ms->sin_reportes = 0;
+            } else if (ms->visto_trabajando) {
+                // Terminó una pieza
+                j->completadas++;
+                j->linea = 0;
+                j->linea_inicio = 0;
+                snprintf(msg, sizeof(msg), "M%d: J%d pieza %d/%d terminada",
+                         id, j->id, j->completadas, j->cantidad);
+                logger_log_maquina("SCHED", id, msg);
+                if (j->completadas >= j->cantidad) {
+                    j->estado = JOB_TERMINADO;
+                    ms->job_idx = -1;
+                } else {
+                    // Repetir en la misma máquina (si ya está en la SD no se sube)
+                    snprintf(archivo, sizeof(archivo), "%s", j->archivo);
+                    subir = strcmp(ms->ultimo_subido, j->archivo) != 0;
+                    marcar_despacho(ms, ev_terminados, ev_cortes);
+                    ms->desfase_linea = 0;
+                    ms->t_despacho = ahora;
+                }
+                job_store_guardar(j, 1);
+            } else if (ahora - ms->t_despacho > SCHED_TIMEOUT_ARRANQUE) {
+                no_arranco(id, ms, j);
+            }
+        } else if (SCHED_AUTO_DESPACHO && idle) {
+            int idx = elegir_job(id);
+            if (idx >= 0) {
+                Job *j = &jobs[idx];
+                j->estado = JOB_CORRIENDO;
+                j->maquina_asignada = id;
+                j->linea = 0;
+                job_store_guardar(j, 1);
+                ms->job_idx = idx;
+                marcar_despacho(ms, ev_terminados, ev_cortes);
+                ms->desfase_linea = 0;
+                ms->t_despacho = ahora;
+                snprintf(archivo, sizeof(archivo), "%s", j->archivo);
+                subir = strcmp(ms->ultimo_subido, j->archivo) != 0;
+                linea_inicio = j->linea_inicio;
+            }
+        }
+        pthread_mutex_unlock(&sched_mutex);
+
+        if (archivo[0] == '\0') continue;
+
+        char path[300];
+        char sd_nombre[MAX_FILENAME_LEN];
+        snprintf(path, sizeof(path), "%s/%s", GCODE_DIR, archivo);
+        snprintf(sd_nombre, sizeof(sd_nombre), "%s", archivo);
+
+        if (linea_inicio > 1) {
+            // Reanudación: programa recortado con preámbulo, siempre se sube
+            char original[300];
+            snprintf(original, sizeof(original), "%s", path);
+            snprintf(sd_nombre, sizeof(sd_nombre), "r_%s", archivo);
+            snprintf(path, sizeof(path), "/tmp/%s", sd_nombre);
+            int pre = gcode_crear_reanudacion(original, linea_inicio, path);
+            if (pre >= 0) {
+                pthread_mutex_lock(&sched_mutex);
+                ms->desfase_linea = (linea_inicio - 1) - pre;
+                pthread_mutex_unlock(&sched_mutex);
+                subir = 1;
+            } else {
+                path[0] = '\0';
+            }
+        }
+
+        char ip[64];
+        if (!ws_pool_ip(id, ip, sizeof(ip)) || path[0] == '\0' || despachar(id, ip, path, sd_nombre, subir) != 0) {
+            // No se pudo subir: devolver a la cola y probar en el próximo tick
+            pthread_mutex_lock(&sched_mutex);
+            if (ms->job_idx >= 0) {
+                Job *j = &jobs[ms->job_idx];
+                j->estado = JOB_EN_COLA;
+                if (j->maquina_fija == 0) j->maquina_asignada = 0;
+                job_store_guardar(j, 1);
+                ms->job_idx = -1;
+            }
+            pthread_mutex_unlock(&sched_mutex);
+            snprintf(msg, sizeof(msg), "M%d: fallo al despachar %s", id, archivo);
+            logger_log_maquina("SCHED", id, msg);
+        } else if (subir) {
+            pthread_mutex_lock(&sched_mutex);
+            // El recorte de reanudación no cuenta como el archivo original
+            if (linea_inicio > 1) ms->ultimo_subido[0] = '\0';
+            else snprintf(ms->ultimo_subido, sizeof(ms->ultimo_subido), "%s", archivo);
+            pthread_mutex_unlock(&sched_mutex);
+        }
+    }
+}
+
+void* thread_scheduler_loop(void* arg) {
+    printf("[SCHED] Planificador iniciado.\n");
+    for (int i = 0; i < MAX_MAQUINAS; i++) maq[i].job_idx = -1;
+    restaurar_estado();
+
+    unsigned int version_ordenes = 0;
+    while (1) {
+        unsigned int v = order_sync_version();
+        if (v != version_ordenes) {
+            version_ordenes = v;
+            importar_ordenes();
+        }
+        tick();
+
+        pthread_mutex_lock(&sched_mutex);
+        if (job_store_necesita_compactar()) {
+            job_store_compactar(jobs, ordenes_importadas, n_importadas);
+        }
+        pthread_mutex_unlock(&sched_mutex);
+
+        usleep(SCHED_TICK_MS * 1000);
+    }
+    return NULL;
+}
@@ -0,0 +1,120 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <time.h>
+#include "../files/file_manager.h"
+#include "../mqtt/mqtt_service.h"
+
+// --- PLANIFICADOR DE TRABAJOS ---
+// Mantiene una cola por máquina y despacha el siguiente archivo cuando la
+// máquina pasa a IDLE (según el estado que llega por MQTT).
+//  - Trabajos fijados (maquina_fija > 0): solo corren en esa máquina.
+//  - Trabajos libres (maquina_fija = 0): los toma la primera máquina que
+//    quede libre. Si la cantidad es > 1 se parten en unidades para repartirlas
+//    entre varias máquinas.
+//  - Mayor prioridad primero; a igual prioridad, el trabajo más largo primero
+//    (reparto LPT) y después el más antiguo.
+
+#define SCHED_MAX_JOBS          128
+#define SCHED_TICK_MS           500
+#define SCHED_TIMEOUT_ARRANQUE  30   // Segundos para ver la máquina trabajando tras despachar
+#define SCHED_AUTO_DESPACHO     1    // 0 = solo encola, el operador despacha a mano
+#define SCHED_STREAM_DIRECTO    0    // 1 = mandar las líneas por WebSocket en vez de subir a la SD
+
+#define SCHED_PRIORIDAD_BAJA    0
+#define SCHED_PRIORIDAD_NORMAL  5
+#define SCHED_PRIORIDAD_URGENTE 10
+
+typedef enum {
+    JOB_LIBRE = 0,      // Hueco sin usar
+    JOB_EN_COLA,
+    JOB_CORRIENDO,
+    JOB_TERMINADO,
+    JOB_CANCELADO,
+    JOB_INTERRUMPIDO    // Se cortó a mitad de pieza; se puede reanudar desde 'linea'
+} JobEstado;
+
+typedef struct {
+    int id;                                  // Identificador local (creciente)
+    int orden_id;                            // ID de la orden en la nube (0 = manual)
+    char archivo[MAX_FILENAME_LEN];          // Nombre dentro de gcode_files/
+    int cantidad;                            // Piezas pedidas en este trabajo
+    int completadas;                         // Piezas ya terminadas
+    int prioridad;
+    int maquina_fija;                        // 0 = cualquiera
+    int maquina_asignada;                    // Máquina donde corre/corrió (0 = ninguna)
+    float estimado_seg;                      // Duración estimada de UNA pieza
+    JobEstado estado;
+    time_t creado;
+    int linea;                               // Línea en ejecución de la pieza actual (0 = no se sabe)
+    int linea_inicio;                        // > 0: la próxima pieza arranca desde esta línea
+} Job;
+
+void* thread_scheduler_loop(void* arg);
+
+/**
+ * @brief Agrega un trabajo a la cola.
+ * @param archivo Nombre del archivo dentro de GCODE_DIR.
+ * @param cantidad Piezas a fabricar (>= 1).
+ * @param prioridad SCHED_PRIORIDAD_*.
+ * @param maquina_fija ID de máquina (1..MAX_MAQUINAS) o 0 para cualquiera.
+ * @param orden_id ID de la orden en la nube, 0 si es manual.
+ * @return ID del (primer) trabajo creado, o -1 si la cola está llena.
+ */
+int sched_encolar(const char *archivo, int cantidad, int prioridad, int maquina_fija, int orden_id);
+
+/**
+ * @brief Cancela un trabajo en cola (los que ya están corriendo no se tocan).
+ * @return 0 si se canceló, -1 si no existe o ya estaba corriendo.
+ */
+int sched_cancelar(int job_id);
+
+/**
+ * @brief Vuelve a encolar un trabajo interrumpido para que siga desde la
+ * última línea registrada (en la misma máquina).
+ * @return 0 si quedó en cola, -1 si el trabajo no estaba interrumpido.
+ */
+int sched_reanudar(int job_id);
+
+/**
+ * @brief Como sched_reanudar, pero la pieza a medio hacer se empieza de cero.
+ * @return 0 si quedó en cola, -1 si el trabajo no estaba interrumpido.
+ */
+int sched_reiniciar(int job_id);
+
+/**
+ * @brief Busca un trabajo interrumpido de una máquina (opcionalmente por archivo).
+ * @param archivo Nombre del archivo o NULL para cualquiera.
+ * @param linea Si no es NULL, devuelve la última línea registrada (0 = no se sabe).
+ * @return ID del trabajo o -1 si no hay.
+ */
+int sched_buscar_interrumpido(int maquina_id, const char *archivo, int *linea);
+
+/**
+ * @brief Copia los trabajos pendientes o en curso de una máquina (0 = libres).
+ * @return Cantidad copiada.
+ */
+int sched_listar(int maquina_id, Job *out, int max);
+
+/**
+ * @brief Segundos estimados de trabajo pendiente en una máquina.
+ */
+float sched_backlog_segundos(int maquina_id);
+
+/**
+ * @brief Avance del trabajo en curso de una máquina (piezas hechas más la
+ * fracción estimada de la actual).
+ * @return 0..1, o -1 si la máquina no tiene trabajo corriendo.
+ */
+float sched_progreso(int maquina_id);
+
+/**
+ * @brief Archivo y línea del programa original que ejecuta una máquina
+ * (traduce la línea reportada si se retomó con preámbulo).
+ * @param reportada Línea que informó la máquina (MaquinaData.linea).
+ * @param archivo Devuelve el nombre dentro de GCODE_DIR.
+ * @return Línea del archivo original, o 0 si no hay trabajo corriendo o no se sabe.
+ */
+int sched_linea_actual(int maquina_id, int reportada, char *archivo, size_t n);
+
+#endif
@@ -0,0 +1,286 @@
+#include "job_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "../logger/logger.h"
+
+#define WAL_MAGIC   0x4A57414Cu  // "JWAL"
+#define SNAP_MAGIC  0x4A534E50u  // "JSNP"
+
+enum { REC_JOB = 1, REC_ORDEN = 2 };
+
+// Registro del WAL. 'tam' detecta un Job con otro layout (binario viejo).
+typedef struct {
+    uint32_t magic;
+    uint32_t tipo;
+    uint32_t tam;
+    uint32_t pad;
+    uint64_t seq;
+    Job job;
+    uint32_t crc;
+} WalRec;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t tam;
+    uint64_t seq;        // Último registro del WAL incluido en la foto
+    uint32_t n_jobs;
+    uint32_t n_ordenes;
+} SnapHeader;
+
+static int fd_wal = -1;
+static uint64_t seq_actual = 0;
+static long wal_bytes = 0;
+static char ruta_wal[256];
+static char ruta_snap[256];
+static char ruta_dir[128];
+
+// CRC-32 (polinomio IEEE) con tabla; se arma en la primera llamada
+static uint32_t crc_tabla[256];
+
+static uint32_t crc32_buf(uint32_t crc, const void *data, size_t len) {
+    if (crc_tabla[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+            crc_tabla[i] = c;
+        }
+    }
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) crc = crc_tabla[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static int job_vivo(const Job *j) {
+    return j->estado == JOB_EN_COLA || j->estado == JOB_CORRIENDO || j->estado == JOB_INTERRUMPIDO;
+}
+
+// Aplica la última versión de un trabajo sobre el arreglo en memoria
+static void aplicar_job(Job *jobs, const Job *j) {
+    int libre = -1;
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        if (jobs[i].estado != JOB_LIBRE && jobs[i].id == j->id) {
+            if (job_vivo(j)) jobs[i] = *j;
+            else memset(&jobs[i], 0, sizeof(Job));
+            return;
+        }
+        if (libre < 0 && jobs[i].estado == JOB_LIBRE) libre = i;
+    }
+    if (job_vivo(j) && libre >= 0) jobs[libre] = *j;
+}
+
+static void agregar_orden(int *ordenes, int *n_ordenes, int orden_id) {
+    for (int i = 0; i < *n_ordenes; i++) {
+        if (ordenes[i] == orden_id) return;
+    }
+    if (*n_ordenes < JOBSTORE_MAX_ORDENES) {
+        ordenes[(*n_ordenes)++] = orden_id;
+    } else {
+        // Lleno: se olvida la más vieja (ya no debería volver del servidor)
+        memmove(ordenes, ordenes + 1, (JOBSTORE_MAX_ORDENES - 1) * sizeof(int));
+        ordenes[JOBSTORE_MAX_ORDENES - 1] = orden_id;
+    }
+}
+
+static void fsync_dir(void) {
+    int fd = open(ruta_dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+static uint64_t cargar_snapshot(Job *jobs, int *ordenes, int *n_ordenes) {
+    FILE *f = fopen(ruta_snap, "rb");
+    if (!f) return 0;
+
+    SnapHeader h;
+    uint64_t seq = 0;
+    int valida = 0;
+    if (fread(&h, sizeof(h), 1, f) == 1 && h.magic == SNAP_MAGIC && h.tam == sizeof(Job) &&
+        h.n_jobs <= SCHED_MAX_JOBS && h.n_ordenes <= JOBSTORE_MAX_ORDENES) {
+        Job tmp_jobs[SCHED_MAX_JOBS];
+        int tmp_ordenes[JOBSTORE_MAX_ORDENES];
+        uint32_t crc_leido = 0;
+        if (fread(tmp_jobs, sizeof(Job), h.n_jobs, f) == h.n_jobs &&
+            fread(tmp_ordenes, sizeof(int), h.n_ordenes, f) == h.n_ordenes &&
+            fread(&crc_leido, sizeof(crc_leido), 1, f) == 1) {
+            uint32_t crc = crc32_buf(0, &h, sizeof(h));
+            crc = crc32_buf(crc, tmp_jobs, h.n_jobs * sizeof(Job));
+            crc = crc32_buf(crc, tmp_ordenes, h.n_ordenes * sizeof(int));
+            if (crc == crc_leido) {
+                for (uint32_t i = 0; i < h.n_jobs; i++) aplicar_job(jobs, &tmp_jobs[i]);
+                memcpy(ordenes, tmp_ordenes, h.n_ordenes * sizeof(int));
+                *n_ordenes = h.n_ordenes;
+                seq = h.seq;
+                valida = 1;
+            }
+        }
+    }
+    fclose(f);
+
+    if (!valida) logger_log("JOBS", "Foto de trabajos invalida, se usa solo el WAL");
+    return seq;
+}
+
+// Reaplica el WAL y corta un posible registro incompleto al final
+static void reproducir_wal(Job *jobs, int *ordenes, int *n_ordenes, uint64_t seq_snap) {
+    WalRec r;
+    long bueno = 0;
+    // Lectura con buffer de stdio: un read() por registro es lo que más tarda
+    FILE *f = fdopen(dup(fd_wal), "rb");
+    if (!f) return;
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        if (r.magic != WAL_MAGIC || r.tam != sizeof(Job) ||
+            crc32_buf(0, &r, offsetof(WalRec, crc)) != r.crc) {
+            break;
+        }
+        bueno += sizeof(r);
+        if (r.seq > seq_actual) seq_actual = r.seq;
+        if (r.seq <= seq_snap) continue; // Ya está en la foto
+
+        if (r.tipo == REC_JOB) aplicar_job(jobs, &r.job);
+        else if (r.tipo == REC_ORDEN) agregar_orden(ordenes, n_ordenes, r.job.orden_id);
+    }
+    fclose(f);
+
+    off_t fin = lseek(fd_wal, 0, SEEK_END);
+    if (fin != bueno) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "WAL cortado: se descartan %ld bytes del final", (long)(fin - bueno));
+        logger_log("JOBS", msg);
+        if (ftruncate(fd_wal, bueno) != 0) perror("[JOBS] ftruncate");
+    }
+    lseek(fd_wal, 0, SEEK_END);
+    wal_bytes = bueno;
+}
+
+int job_store_abrir(Job *jobs, int *ordenes, int *n_ordenes) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    memset(jobs, 0, SCHED_MAX_JOBS * sizeof(Job));
+    *n_ordenes = 0;
+
+    snprintf(ruta_dir, sizeof(ruta_dir), "%s", JOBSTORE_DIR);
+    snprintf(ruta_wal, sizeof(ruta_wal), "%s/jobs.wal", JOBSTORE_DIR);
+    snprintf(ruta_snap, sizeof(ruta_snap), "%s/jobs.snap", JOBSTORE_DIR);
+    if (mkdir(ruta_dir, 0755) != 0 && errno != EEXIST) {
+        perror("[JOBS] mkdir");
+        return -1;
+    }
+
+    uint64_t seq_snap = cargar_snapshot(jobs, ordenes, n_ordenes);
+    seq_actual = seq_snap;
+
+    fd_wal = open(ruta_wal, O_RDWR | O_CREAT, 0644);
+    if (fd_wal < 0) {
+        perror("[JOBS] open wal");
+        return -1;
+    }
+    reproducir_wal(jobs, ordenes, n_ordenes, seq_snap);
+
+    int vivos = 0;
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        if (jobs[i].estado != JOB_LIBRE) vivos++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+    printf("[JOBS] Estado reconstruido: %d trabajos, %d ordenes en %.2f ms\n", vivos, *n_ordenes, ms);
+    return vivos;
+}
+
+static void escribir_rec(uint32_t tipo, const Job *j, int sync) {
+    if (fd_wal < 0) return;
+
+    WalRec r;
+    memset(&r, 0, sizeof(r));  // El CRC cubre también el relleno del struct
+    r.magic = WAL_MAGIC;
+    r.tipo = tipo;
+    r.tam = sizeof(Job);
+    r.seq = ++seq_actual;
+    r.job = *j;
+    r.crc = crc32_buf(0, &r, offsetof(WalRec, crc));
+
+    if (write(fd_wal, &r, sizeof(r)) != (ssize_t)sizeof(r)) {
+        perror("[JOBS] write wal");
+        return;
+    }
+    wal_bytes += sizeof(r);
+    if (sync) fdatasync(fd_wal);
+}
+
+void job_store_guardar(const Job *j, int sync) {
+    escribir_rec(REC_JOB, j, sync);
+}
+
+void job_store_orden_importada(int *ordenes, int *n_ordenes, int orden_id) {
+    agregar_orden(ordenes, n_ordenes, orden_id);
+
+    Job j;
+    memset(&j, 0, sizeof(j));
+    j.orden_id = orden_id;
+    escribir_rec(REC_ORDEN, &j, 1);
+}
+
+int job_store_necesita_compactar(void) {
+    return fd_wal >= 0 && wal_bytes > JOBSTORE_WAL_MAX;
+}
+
+void job_store_compactar(const Job *jobs, const int *ordenes, int n_ordenes) {
+    if (fd_wal < 0) return;
+
+    Job vivos[SCHED_MAX_JOBS];
+    uint32_t n = 0;
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        if (job_vivo(&jobs[i])) vivos[n++] = jobs[i];
+    }
+
+    SnapHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = SNAP_MAGIC;
+    h.tam = sizeof(Job);
+    h.seq = seq_actual;
+    h.n_jobs = n;
+    h.n_ordenes = n_ordenes;
+
+    uint32_t crc = crc32_buf(0, &h, sizeof(h));
+    crc = crc32_buf(crc, vivos, n * sizeof(Job));
+    crc = crc32_buf(crc, ordenes, n_ordenes * sizeof(int));
+
+    char tmp[sizeof(ruta_snap) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", ruta_snap);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        perror("[JOBS] snapshot");
+        return;
+    }
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+             fwrite(vivos, sizeof(Job), n, f) == n &&
+             fwrite(ordenes, sizeof(int), n_ordenes, f) == (size_t)n_ordenes &&
+             fwrite(&crc, sizeof(crc), 1, f) == 1;
+    ok = (fflush(f) == 0) && ok;
+    if (ok) fsync(fileno(f));
+    fclose(f);
+    if (!ok) {
+        unlink(tmp);
+        return;
+    }
+
+    // Primero la foto nueva queda firme; recién ahí se vacía el WAL.
+    // Si se corta entre medio, los registros viejos se saltan por 'seq'.
+    rename(tmp, ruta_snap);
+    fsync_dir();
+    if (ftruncate(fd_wal, 0) == 0) {
+        lseek(fd_wal, 0, SEEK_SET);
+        wal_bytes = 0;
+    }
+}
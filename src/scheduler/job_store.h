@@ -0,0 +1,51 @@
+#ifndef JOB_STORE_H
+#define JOB_STORE_H
+
+#include "job_scheduler.h"
+
+// --- ALMACÉN PERSISTENTE DE TRABAJOS ---
+// Guarda la cola del planificador para que sobreviva a un reinicio o a un
+// corte de luz. Dos archivos en JOBSTORE_DIR:
+//   jobs.snap : foto compacta de todos los trabajos vivos (se reemplaza con rename)
+//   jobs.wal  : log de escritura anticipada; cada cambio de un trabajo agrega
+//               un registro binario con CRC con el trabajo completo.
+// Al arrancar se carga la foto y se reaplica el WAL encima (el último registro
+// de cada trabajo gana). Un registro cortado al final se descarta.
+
+#define JOBSTORE_DIR          "jobstore"
+#define JOBSTORE_WAL_MAX      (256 * 1024)   // Al pasar este tamaño se compacta
+#define JOBSTORE_MAX_ORDENES  256            // Órdenes de la nube ya importadas
+
+/**
+ * @brief Abre el almacén y reconstruye el estado guardado.
+ * @param jobs Arreglo destino (SCHED_MAX_JOBS elementos, se limpia).
+ * @param ordenes Destino para los IDs de órdenes ya importadas.
+ * @param n_ordenes Cantidad de órdenes cargadas.
+ * @return Cantidad de trabajos vivos recuperados, o -1 si no se pudo abrir.
+ */
+int job_store_abrir(Job *jobs, int *ordenes, int *n_ordenes);
+
+/**
+ * @brief Registra el estado actual de un trabajo en el WAL.
+ * @param sync 1 para esperar a que llegue al disco (cambios de estado),
+ *             0 para progreso de línea (se baja con el siguiente sync).
+ */
+void job_store_guardar(const Job *j, int sync);
+
+/**
+ * @brief Registra que una orden de la nube ya se convirtió en trabajos.
+ * La agrega también a la lista en memoria (si está llena se olvida la más vieja).
+ */
+void job_store_orden_importada(int *ordenes, int *n_ordenes, int orden_id);
+
+/**
+ * @brief 1 si el WAL creció lo suficiente como para compactar.
+ */
+int job_store_necesita_compactar(void);
+
+/**
+ * @brief Escribe una foto nueva con los trabajos vivos y vacía el WAL.
+ */
+void job_store_compactar(const Job *jobs, const int *ordenes, int n_ordenes);
+
+#endif
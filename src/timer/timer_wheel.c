@@ -0,0 +1,175 @@
+#include "timer_wheel.h"
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#define RANURAS   (1 << TIMER_BITS)
+#define MASCARA   (RANURAS - 1)
+#define ALCANCE   (1UL << (TIMER_BITS * TIMER_NIVELES))
+
+// Cada ranura es una lista doble circular con cabecera (TimerNodo sin dueño)
+static TimerNodo rueda[TIMER_NIVELES][RANURAS];
+static TimerNodo vencidos;          // Sacados de la rueda, esperando su callback
+static unsigned long tick_actual;   // Próximo tick a procesar
+static long inicio_ms;              // Tick 0
+static pthread_mutex_t rueda_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t rueda_once = PTHREAD_ONCE_INIT;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void lista_vaciar(TimerNodo *cab) {
+    cab->sig = cab;
+    cab->ant = cab;
+}
+
+static void rueda_init(void) {
+    for (int n = 0; n < TIMER_NIVELES; n++) {
+        for (int r = 0; r < RANURAS; r++) lista_vaciar(&rueda[n][r]);
+    }
+    lista_vaciar(&vencidos);
+    inicio_ms = ahora_ms();
+}
+
+static void enganchar(TimerNodo *cab, TimerNodo *t) {
+    t->ant = cab->ant;
+    t->sig = cab;
+    cab->ant->sig = t;
+    cab->ant = t;
+}
+
+static void desenganchar(TimerNodo *t) {
+    t->ant->sig = t->sig;
+    t->sig->ant = t->ant;
+    t->sig = t->ant = NULL;
+}
+
+// Con rueda_mutex tomado. El nivel sale de cuánto falta; la ranura, de los
+// bits de ese nivel del tick de vencimiento.
+static void insertar(TimerNodo *t) {
+    unsigned long falta = t->vence - tick_actual;
+    TimerNodo *cab;
+    if ((long)falta < 0) {
+        cab = &rueda[0][tick_actual & MASCARA];     // Ya vencido: sale en este tick
+    } else {
+        if (falta >= ALCANCE) {
+            falta = ALCANCE - 1;
+            t->vence = tick_actual + falta;
+        }
+        int nivel = 0;
+        while (falta >= (1UL << (TIMER_BITS * (nivel + 1)))) nivel++;
+        cab = &rueda[nivel][(t->vence >> (TIMER_BITS * nivel)) & MASCARA];
+    }
+    enganchar(cab, t);
+}
+
+// Reparte una ranura de un nivel superior en los de abajo.
+// Devuelve el índice, que es 0 cuando hay que seguir subiendo.
+static int cascada(int nivel) {
+    int idx = (int)((tick_actual >> (TIMER_BITS * nivel)) & MASCARA);
+    TimerNodo *cab = &rueda[nivel][idx];
+    while (cab->sig != cab) {
+        TimerNodo *t = cab->sig;
+        desenganchar(t);
+        insertar(t);
+    }
+    return idx;
+}
+
+// Con rueda_mutex tomado: avanza un tick y pasa la ranura actual a vencidos
+static void avanzar_tick(void) {
+    int idx = (int)(tick_actual & MASCARA);
+    if (idx == 0) {
+        for (int n = 1; n < TIMER_NIVELES && cascada(n) == 0; n++) { }
+    }
+    tick_actual++;
+
+    TimerNodo *cab = &rueda[0][idx];
+    while (cab->sig != cab) {
+        TimerNodo *t = cab->sig;
+        desenganchar(t);
+        enganchar(&vencidos, t);
+    }
+}
+
+void timer_init(TimerNodo *t, timer_cb cb, void *ctx) {
+    pthread_once(&rueda_once, rueda_init);
+    t->sig = t->ant = NULL;
+    t->vence = 0;
+    t->cb = cb;
+    t->ctx = ctx;
+    t->pendiente = 0;
+}
+
+void timer_armar(TimerNodo *t, int ms) {
+    pthread_once(&rueda_once, rueda_init);
+    if (ms < 0) ms = 0;
+    pthread_mutex_lock(&rueda_mutex);
+    if (t->pendiente) desenganchar(t);
+    // Desde el reloj, no desde tick_actual (el hilo puede ir un tick atrás),
+    // y redondeando hacia arriba: nunca vence antes de lo pedido
+    t->vence = (unsigned long)((ahora_ms() - inicio_ms + ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS);
+    t->pendiente = 1;
+    insertar(t);
+    pthread_mutex_unlock(&rueda_mutex);
+}
+
+void timer_cancelar(TimerNodo *t) {
+    pthread_mutex_lock(&rueda_mutex);
+    if (t->pendiente) {
+        desenganchar(t);
+        t->pendiente = 0;
+    }
+    pthread_mutex_unlock(&rueda_mutex);
+}
+
+int timer_pendiente(const TimerNodo *t) {
+    pthread_mutex_lock(&rueda_mutex);
+    int p = t->pendiente;
+    pthread_mutex_unlock(&rueda_mutex);
+    return p;
+}
+
+void* thread_timer_loop(void* arg) {
+    (void)arg;
+    pthread_once(&rueda_once, rueda_init);
+    printf("[TIMER] Rueda de timers iniciada (tick %d ms).\n", TIMER_TICK_MS);
+
+    struct timespec proximo;
+    clock_gettime(CLOCK_MONOTONIC, &proximo);
+
+    while (1) {
+        // Se duerme hasta el próximo tick en tiempo absoluto: sin deriva
+        proximo.tv_nsec += TIMER_TICK_MS * 1000000L;
+        if (proximo.tv_nsec >= 1000000000L) {
+            proximo.tv_sec++;
+            proximo.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &proximo, NULL);
+
+        // Si el hilo se atrasó (carga, suspensión) se recuperan todos los ticks
+        unsigned long objetivo = (unsigned long)((ahora_ms() - inicio_ms) / TIMER_TICK_MS);
+        pthread_mutex_lock(&rueda_mutex);
+        while (tick_actual < objetivo) {
+            avanzar_tick();
+
+            // Los callbacks corren sin el lock; uno por vez, porque mientras
+            // tanto otro hilo puede refrescar o cancelar los que esperan
+            while (vencidos.sig != &vencidos) {
+                TimerNodo *t = vencidos.sig;
+                desenganchar(t);
+                t->pendiente = 0;
+                timer_cb cb = t->cb;
+                void *ctx = t->ctx;
+                pthread_mutex_unlock(&rueda_mutex);
+                if (cb) cb(ctx);
+                pthread_mutex_lock(&rueda_mutex);
+            }
+        }
+        pthread_mutex_unlock(&rueda_mutex);
+    }
+    return NULL;
+}
@@ -0,0 +1,54 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- RUEDA DE TIMERS JERÁRQUICA ---
+// Un solo hilo (thread_timer_loop) vence todos los plazos del programa:
+// latidos de las máquinas, reconexiones con backoff, timeouts de comandos.
+// Armar, refrescar o cancelar un timer es O(1) (se engancha en la ranura
+// de su vencimiento); en cada tick solo se mira la ranura actual y, cada 64
+// ticks, se reparte una ranura del nivel de arriba.
+//
+// Los callbacks corren en el hilo de la rueda, sin el lock de la rueda
+// tomado: pueden volver a armar timers. Un callback puede llegar justo
+// después de que otro hilo refrescó el timer, así que si importa hay que
+// confirmar con timer_pendiente() bajo el mismo mutex que usa el refresco.
+
+#define TIMER_TICK_MS       10
+#define TIMER_BITS          6       // 64 ranuras por nivel
+#define TIMER_NIVELES       4       // 64^4 ticks = ~46 h; más lejos se recorta
+
+typedef void (*timer_cb)(void *ctx);
+
+// Intrusivo: va dentro de la estructura dueña (no se reserva memoria)
+typedef struct TimerNodo {
+    struct TimerNodo *sig;
+    struct TimerNodo *ant;
+    unsigned long vence;    // En ticks de la rueda
+    timer_cb cb;
+    void *ctx;
+    int pendiente;
+} TimerNodo;
+
+void timer_init(TimerNodo *t, timer_cb cb, void *ctx);
+
+// Arma el timer para dentro de ms (si ya estaba armado, lo mueve). O(1).
+void timer_armar(TimerNodo *t, int ms);
+
+// Lo desarma si estaba armado. O(1).
+void timer_cancelar(TimerNodo *t);
+
+// 1 si está armado y todavía no venció
+int timer_pendiente(const TimerNodo *t);
+
+// Hilo que hace girar la rueda
+void* thread_timer_loop(void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_WHEEL_H
@@ -100,7 +100,7 @@ void ui_event_btnXpos(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_x_pos(e);
     }
 }
@@ -109,7 +109,7 @@ void ui_event_btnXneg(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_x_neg(e);
     }
 }
@@ -118,7 +118,7 @@ void ui_event_btnYpos(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_y_pos(e);
     }
 }
@@ -127,7 +127,7 @@ void ui_event_btnYneg(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_y_neg(e);
     }
 }
@@ -136,7 +136,7 @@ void ui_event_btnZpos(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_z_pos(e);
     }
 }
@@ -145,7 +145,7 @@ void ui_event_btnZneg(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
 
-    if(event_code == LV_EVENT_CLICKED) {
+    if(event_code == LV_EVENT_PRESSED || event_code == LV_EVENT_RELEASED || event_code == LV_EVENT_PRESS_LOST) {
         mover_z_neg(e);
     }
 }
@@ -14,10 +14,12 @@ lv_obj_t * ui____initial_actions0;
 // IMAGES AND IMAGE SETS
 
 ///////////////////// TEST LVGL SETTINGS ////////////////////
-#if LV_COLOR_DEPTH != 32
-    #error "LV_COLOR_DEPTH should be 32bit to match SquareLine Studio's settings"
+// SquareLine exporta a 32 bpp; el perfil RGB565 (CNC_COLOR_16) usa las
+// imágenes convertidas por tools/img_rgb565 al compilar
+#if LV_COLOR_DEPTH != 32 && LV_COLOR_DEPTH != 16
+    #error "LV_COLOR_DEPTH should be 32bit (or 16bit with CNC_COLOR_16) to match SquareLine Studio's settings"
 #endif
-#if LV_COLOR_16_SWAP !=0
+#if LV_COLOR_16_SWAP != 0 && LV_COLOR_DEPTH != 16
     #error "LV_COLOR_16_SWAP should be 0 to match SquareLine Studio's settings"
 #endif
 
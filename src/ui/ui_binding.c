@@ -0,0 +1,83 @@
+#include "ui_binding.h"
+#include <stdio.h>
+#include <string.h>
+
+int ui_binding_agregar(BindingGrupo *g, lv_obj_t *obj, CampoMaquina campo,
+                       const char *formato, int decimales, binding_estilo_cb estilo) {
+    if (!g || !obj || !formato || g->n >= UI_BINDING_MAX) return -1;
+    Binding *b = &g->b[g->n++];
+    memset(b, 0, sizeof(*b));
+    b->obj = obj;
+    b->campo = campo;
+    b->formato = formato;
+    b->decimales = decimales;
+    b->estilo = estilo;
+    return 0;
+}
+
+static float campo_float(const MaquinaData *m, CampoMaquina campo) {
+    if (campo == CAMPO_POS_X) return m->pos_x;
+    if (campo == CAMPO_POS_Y) return m->pos_y;
+    return m->pos_z;
+}
+
+// 1 si el valor cambió (y lo guarda); con un valor igual no hace falta formatear
+static int valor_cambio(Binding *b, const MaquinaData *m) {
+    switch (b->campo) {
+        case CAMPO_ESTADO: {
+            const char *s = m->estado;
+            if (b->valido && strncmp(b->valor.s, s, sizeof(b->valor.s) - 1) == 0) return 0;
+            snprintf(b->valor.s, sizeof(b->valor.s), "%s", s);
+            return 1;
+        }
+        case CAMPO_POS_X:
+        case CAMPO_POS_Y:
+        case CAMPO_POS_Z: {
+            float f = campo_float(m, b->campo);
+            if (b->valido && b->valor.f == f) return 0;
+            b->valor.f = f;
+            return 1;
+        }
+        case CAMPO_LINEA:
+            if (b->valido && b->valor.i == m->linea) return 0;
+            b->valor.i = m->linea;
+            return 1;
+    }
+    return 0;
+}
+
+static void formatear(const Binding *b, char *out, size_t cap) {
+    switch (b->campo) {
+        case CAMPO_ESTADO:
+            snprintf(out, cap, b->formato, b->valor.s);
+            break;
+        case CAMPO_POS_X:
+        case CAMPO_POS_Y:
+        case CAMPO_POS_Z:
+            snprintf(out, cap, b->formato, b->decimales, (double)b->valor.f);
+            break;
+        case CAMPO_LINEA:
+            snprintf(out, cap, b->formato, b->valor.i);
+            break;
+    }
+}
+
+int ui_binding_aplicar(BindingGrupo *g, const MaquinaData *m) {
+    int cambios = 0;
+    for (int k = 0; k < g->n; k++) {
+        Binding *b = &g->b[k];
+        if (!valor_cambio(b, m)) continue;
+
+        char texto[UI_BINDING_TEXTO];
+        formatear(b, texto, sizeof(texto));
+        int primera = !b->valido;
+        b->valido = 1;
+        if (!primera && strcmp(texto, b->texto) == 0) continue;   // Cambio por debajo de la precisión
+
+        snprintf(b->texto, sizeof(b->texto), "%s", texto);
+        lv_label_set_text(b->obj, b->texto);
+        if (b->estilo) b->estilo(b->obj, m);
+        cambios++;
+    }
+    return cambios;
+}
@@ -0,0 +1,59 @@
+#ifndef UI_BINDING_H
+#define UI_BINDING_H
+
+#include "ui.h"
+#include "../mqtt/mqtt_service.h"
+
+// --- ENLACE ESTADO -> WIDGETS ---
+// Cada label se suscribe a un campo de MaquinaData con su formato. Al
+// aplicar una copia de la máquina se compara campo por campo: si el valor no
+// cambió no se formatea, y si el texto formateado es igual al que ya está
+// (p. ej. ruido por debajo de los decimales) no se toca el label, así LVGL
+// no invalida nada. Solo desde el hilo de la UI.
+
+#define UI_BINDING_MAX      16
+#define UI_BINDING_TEXTO    48
+
+typedef enum {
+    CAMPO_ESTADO = 0,
+    CAMPO_POS_X,
+    CAMPO_POS_Y,
+    CAMPO_POS_Z,
+    CAMPO_LINEA
+} CampoMaquina;
+
+// Se llama solo cuando el texto cambió (colores según el estado, etc.)
+typedef void (*binding_estilo_cb)(lv_obj_t *obj, const MaquinaData *m);
+
+typedef struct {
+    lv_obj_t *obj;
+    CampoMaquina campo;
+    const char *formato;        // printf: "%s", "%d" o "%.*f" (recibe los decimales)
+    int decimales;
+    binding_estilo_cb estilo;
+    int valido;                 // Ya se dibujó una vez
+    union {                     // Último valor visto, para no formatear de nuevo
+        float f;
+        int i;
+        char s[32];
+    } valor;
+    char texto[UI_BINDING_TEXTO];
+} Binding;
+
+typedef struct {
+    Binding b[UI_BINDING_MAX];
+    int n;
+} BindingGrupo;
+
+/**
+ * @brief Suscribe un label a un campo.
+ * @param estilo Opcional (NULL).
+ * @return 0, o -1 si el grupo está lleno.
+ */
+int ui_binding_agregar(BindingGrupo *g, lv_obj_t *obj, CampoMaquina campo,
+                       const char *formato, int decimales, binding_estilo_cb estilo);
+
+// Vuelca una copia de la máquina. Devuelve cuántos labels cambiaron.
+int ui_binding_aplicar(BindingGrupo *g, const MaquinaData *m);
+
+#endif
@@ -0,0 +1,142 @@
+#include "ui.h"
+#include "ui_consola.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define CONSOLA_FILAS_MAX   40          // Tope de líneas visibles (alto / alto de línea)
+#define CONSOLA_FUENTE      (&lv_font_montserrat_12)
+
+extern int maquina_activa_id;
+
+static lv_obj_t * consola;
+static lv_obj_t * btn_filtro;
+static lv_obj_t * lbl_filtro;
+static int filtro = 0;                  // 0 = todas las máquinas
+static unsigned long ancla = 0;         // Última línea visible (0 = seguir a las nuevas)
+static unsigned long dibujado = 0;      // log_ring_ultimo() del último dibujo
+static lv_coord_t arrastre = 0;         // Píxeles arrastrados que todavía no son una línea
+
+static lv_coord_t alto_linea(void) {
+    return lv_font_get_line_height(CONSOLA_FUENTE) + 2;
+}
+
+static lv_color_t color_severidad(LogSeveridad sev) {
+    if (sev == LOG_ERROR) return lv_palette_main(LV_PALETTE_RED);
+    if (sev == LOG_AVISO) return lv_palette_main(LV_PALETTE_ORANGE);
+    return lv_color_hex(0xD0D0D0);
+}
+
+// Solo las líneas que entran: el costo no depende de cuántas hubo
+static void al_dibujar(lv_event_t * e) {
+    lv_draw_ctx_t * draw_ctx = lv_event_get_draw_ctx(e);
+    lv_area_t area;
+    lv_obj_get_content_coords(consola, &area);
+
+    lv_coord_t alto = alto_linea();
+    int filas = lv_area_get_height(&area) / alto;
+    if (filas > CONSOLA_FILAS_MAX) filas = CONSOLA_FILAS_MAX;
+    if (filas <= 0) return;
+
+    static LogLinea vis[CONSOLA_FILAS_MAX];
+    int n = log_ring_leer(filtro, ancla, vis, filas);
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = CONSOLA_FUENTE;
+    dsc.flag = LV_TEXT_FLAG_EXPAND;     // Sin cortar en renglones: lo que sobra se recorta
+
+    // Pegadas abajo, la más nueva al final
+    lv_coord_t y = area.y1 + (filas - n) * alto;
+    for (int i = 0; i < n; i++, y += alto) {
+        char txt[LOG_LINEA_MAX + 16];
+        struct tm tm;
+        localtime_r(&vis[i].ts, &tm);
+        snprintf(txt, sizeof(txt), "%02d:%02d:%02d %s", tm.tm_hour, tm.tm_min, tm.tm_sec, vis[i].texto);
+
+        lv_area_t renglon = { area.x1, y, area.x2, y + alto - 1 };
+        dsc.color = color_severidad(vis[i].sev);
+        lv_draw_label(draw_ctx, &dsc, &renglon, txt, NULL);
+    }
+}
+
+// Arrastrar hacia abajo muestra las viejas; volver al fondo sigue a las nuevas
+static void al_arrastrar(lv_event_t * e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_PRESSED) {
+        arrastre = 0;
+        return;
+    }
+
+    lv_point_t v;
+    lv_indev_get_vect(lv_indev_get_act(), &v);
+    arrastre += v.y;
+    lv_coord_t alto = alto_linea();
+    int lineas = arrastre / alto;
+    if (lineas == 0) return;
+    arrastre -= lineas * alto;
+
+    unsigned long ultimo = log_ring_mover(filtro, 0, 0);
+    ancla = log_ring_mover(filtro, ancla, -lineas);
+    if (ancla == ultimo) ancla = 0;
+    lv_obj_invalidate(consola);
+}
+
+static void poner_filtro(int maquina) {
+    filtro = maquina;
+    ancla = 0;
+    if (filtro) lv_label_set_text_fmt(lbl_filtro, "M%d", filtro);
+    else lv_label_set_text(lbl_filtro, "Todas");
+    lv_obj_invalidate(consola);
+}
+
+static void al_tocar_filtro(lv_event_t * e) {
+    (void)e;
+    poner_filtro(filtro ? 0 : maquina_activa_id);
+}
+
+void ui_consola_init(void) {
+    if (!ui_areaComands || consola) return;
+    lv_obj_t * padre = lv_obj_get_parent(ui_areaComands);
+
+    // Mismo lugar y tamaño que el textarea de SquareLine
+    consola = lv_obj_create(padre);
+    lv_obj_set_width(consola, lv_pct(100));
+    lv_obj_set_height(consola, lv_pct(60));
+    lv_obj_set_align(consola, LV_ALIGN_BOTTOM_MID);
+    lv_obj_clear_flag(consola, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_color(consola, lv_color_hex(0x101010), LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(consola, 255, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_all(consola, 4, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(consola, al_dibujar, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(consola, al_arrastrar, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(consola, al_arrastrar, LV_EVENT_PRESSING, NULL);
+
+    btn_filtro = lv_btn_create(consola);
+    lv_obj_set_size(btn_filtro, 60, 24);
+    lv_obj_set_align(btn_filtro, LV_ALIGN_TOP_RIGHT);
+    lv_obj_add_event_cb(btn_filtro, al_tocar_filtro, LV_EVENT_CLICKED, NULL);
+    lbl_filtro = lv_label_create(btn_filtro);
+    lv_obj_set_align(lbl_filtro, LV_ALIGN_CENTER);
+    lv_obj_set_style_text_font(lbl_filtro, CONSOLA_FUENTE, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_label_set_text(lbl_filtro, "Todas");
+
+    lv_obj_add_flag(ui_areaComands, LV_OBJ_FLAG_HIDDEN);
+}
+
+void ui_consola_refrescar(void) {
+    if (!consola) return;
+
+    // Con el filtro puesto, la consola sigue a la máquina seleccionada
+    if (filtro && filtro != maquina_activa_id) poner_filtro(maquina_activa_id);
+
+    unsigned long ultimo = log_ring_ultimo();
+    if (ultimo == dibujado) return;
+    dibujado = ultimo;
+    // Anclada más arriba, las líneas nuevas no mueven lo que se ve
+    if (ancla == 0) lv_obj_invalidate(consola);
+}
+
+void ui_log(int maquina, LogSeveridad sev, const char *mensaje) {
+    log_ring_agregar(sev, maquina, mensaje);
+}
@@ -0,0 +1,22 @@
+#ifndef UI_CONSOLA_H
+#define UI_CONSOLA_H
+
+#include "ui.h"
+#include "../logger/log_ring.h"
+
+// --- CONSOLA DE COMANDOS ---
+// Reemplaza al textarea ui_areaComands: las líneas viven en el anillo de
+// log_ring.c y la consola dibuja solo las que entran en pantalla. Colores
+// por severidad, filtro por máquina (botón) y arrastre para ver las viejas;
+// abajo del todo sigue a las nuevas.
+
+// Crea la consola en el lugar de ui_areaComands (que queda oculto)
+void ui_consola_init(void);
+
+// Desde el loop de la UI: redibuja si llegaron líneas o cambió la máquina
+void ui_consola_refrescar(void);
+
+// Agrega una línea para una máquina (0 = general). Desde cualquier hilo.
+void ui_log(int maquina, LogSeveridad sev, const char *mensaje);
+
+#endif
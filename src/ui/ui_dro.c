@@ -0,0 +1,101 @@
+#include "ui_dro.h"
+#include "ui_logic.h"
+#include "../dro/dro.h"
+#include "../files/file_manager.h"
+#include "../scheduler/gcode_estimate.h"
+#include "../scheduler/job_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static MaquinaData vista;           // Última muestra de la seleccionada
+static int id_vista = 0;
+static int hay_muestra = 0;         // Llegó algo que todavía no se dibujó
+static Dro dro;
+static long ultimo_ms = 0;
+
+// Trayecto del programa que corre la seleccionada (uno solo a la vez)
+static char tray_archivo[MAX_FILENAME_LEN] = "";
+static GcodeSegmento *tray = NULL;
+static int tray_lineas = 0;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void ui_dro_muestrear(int id, const MaquinaData *m) {
+    if (id != id_vista) {
+        id_vista = id;
+        dro_reset(&dro);
+    } else if (m->version == vista.version && m->pos_ms == vista.pos_ms) {
+        return;
+    }
+    vista = *m;
+    hay_muestra = 1;
+}
+
+// Segmento que ejecuta la máquina: la línea reportada ya entró al
+// planificador, así que se busca hacia atrás el tramo recto que tiene abajo
+// la posición reportada
+static void buscar_segmento(void) {
+    char archivo[MAX_FILENAME_LEN];
+    int linea = sched_linea_actual(id_vista, vista.linea, archivo, sizeof(archivo));
+    if (linea <= 0) return;
+
+    if (strcmp(archivo, tray_archivo) != 0) {
+        // Una vez por archivo; si no se puede (o es muy largo) se anota igual
+        // para no reintentar en cada reporte
+        char ruta[512];
+        snprintf(ruta, sizeof(ruta), "%s/%s", GCODE_DIR, archivo);
+        free(tray);
+        tray = gcode_trayecto_cargar(ruta, &tray_lineas);
+        snprintf(tray_archivo, sizeof(tray_archivo), "%s", archivo);
+        if (!tray) printf("[DRO] %s sin trayecto: se extrapola solo con lo medido\n", archivo);
+    }
+    if (!tray || linea > tray_lineas) return;
+
+    // tray[i] es la línea i + 1; su inicio es el fin de la anterior. Los arcos
+    // no van en línea recta hacia su fin.
+    for (int i = linea - 1; i >= 1 && i >= linea - UI_DRO_LINEAS_ATRAS; i--) {
+        if (tray[i].modo > 1) continue;
+        if (dro_segmento(&dro, tray[i - 1].fin, tray[i].fin)) return;
+    }
+}
+
+void ui_dro_refrescar(void) {
+    if (!id_vista) return;
+    long ahora = ahora_ms();
+
+    if (hay_muestra) {
+        hay_muestra = 0;
+        // Un cambio de estado sin posición nueva no es otra muestra: solo
+        // importa si arranca o se detiene
+        int mueve = dro_estado_mueve(vista.estado);
+        if (vista.pos_ms != dro.t_ms || mueve != dro.en_movimiento) {
+            float pos[3] = { vista.pos_x, vista.pos_y, vista.pos_z };
+            dro_muestra(&dro, pos, vista.pos_ms, vista.feed, mueve);
+            if (mueve) buscar_segmento();
+        }
+        // Quieta: el dato real tal cual. En movimiento, el DRO llega a él
+        // sin saltar (dro_muestra)
+        if (!dro.en_movimiento) {
+            ui_update_maquina(&vista);
+            ultimo_ms = ahora;
+            return;
+        }
+    } else if (!dro.en_movimiento || ahora - ultimo_ms < UI_DRO_PERIODO_MS) {
+        return;
+    }
+    ultimo_ms = ahora;
+
+    float pos[3];
+    dro_estimar(&dro, ahora, pos);
+    MaquinaData estimada = vista;
+    estimada.pos_x = pos[0];
+    estimada.pos_y = pos[1];
+    estimada.pos_z = pos[2];
+    ui_update_maquina(&estimada);
+}
@@ -0,0 +1,22 @@
+#ifndef UI_DRO_H
+#define UI_DRO_H
+
+#include "../mqtt/mqtt_service.h"
+
+// --- DRO DE LA MÁQUINA SELECCIONADA ---
+// Dueño de la copia que se dibuja en ui_main: toma cada reporte de posición
+// (aunque no cambie la versión) y, mientras la máquina se mueve, corre los
+// labels X/Y/Z a la posición estimada (src/dro/dro.h) a UI_DRO_PERIODO_MS.
+// El segmento activo sale del programa que el scheduler le mandó a la
+// máquina, cargado una vez por archivo.
+
+#define UI_DRO_PERIODO_MS   16      // ~60 Hz; el label solo se toca si cambia el texto
+#define UI_DRO_LINEAS_ATRAS 32      // Cuánto puede ir adelantada la línea reportada (planificador)
+
+// Con state_mutex tomado, una vez por vuelta del loop de la UI
+void ui_dro_muestrear(int id, const MaquinaData *m);
+
+// Sin mutex: dibuja la última muestra o la estimación de ahora
+void ui_dro_refrescar(void);
+
+#endif
@@ -9,99 +9,123 @@
 #include "../files/file_manager.h"
 #include "../logger/logger.h"
 #include "../websocket/websocket_cmd.h" // Tu librería de WS
+#include "../websocket/ws_pool.h"
 #include "../websocket/fluidnc_formatter.h"
+#include "../aws/order_sync.h"
+#include "../scheduler/job_scheduler.h"
+#include "../config/machine_config.h"
 #include "ui_logic.h"
+#include "ui_pantallas.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <strings.h>
 
-void ui_update_ip_display(const char * ip);
-
-// --- CONFIGURACIÓN DE MÁQUINAS FIJAS ---
-// Aquí defines tus máquinas manualmente
-typedef struct {
-    int id;
-    const char* nombre;
-    const char* ip;
-} MaquinaFija;
-
-// LISTA DE MÁQUINAS (Edita las IPs aquí)
-MaquinaFija maquinas_fijas[] = {
-    {1, "CNC 01 (Fresadora)", "10.213.126.243"}, // <--- IP MAQUINA 1
-    {2, "CNC 02 (Torno)",     "192.168.1.51"}  // <--- IP MAQUINA 2
-};
-int total_maquinas_fijas = 2;
+// Las máquinas salen de machine_config.json (se recarga solo al editarlo)
+// más las que se anuncian por MQTT sin estar en el archivo.
 
 // Variables Globales
 int maquina_activa_id = 1;      // ID seleccionado (1, 2...)
-char ip_maquina_objetivo[32] = ""; // IP seleccionada
+char ip_maquina_objetivo[64] = ""; // IP (o nombre) seleccionada
 extern FileList mis_archivos;
-
-// --- HELPER: BUSCAR IP ---
-const char* obtener_ip_por_id(int id) {
-    for(int i=0; i<total_maquinas_fijas; i++) {
-        if(maquinas_fijas[i].id == id) {
-            return maquinas_fijas[i].ip;
-        }
+extern pthread_mutex_t state_mutex;
+
+// Qué máquina hay en cada renglón del roller
+static int roller_ids[MAX_MAQUINAS];
+static int roller_total = 0;
+
+// --- HELPER: IP A MOSTRAR (MQTT primero, si no la configurada) ---
+// Llamar con state_mutex tomado
+static void ip_de_maquina(int id, char *ip, size_t cap) {
+    snprintf(ip, cap, "%s", global_state.maquinas[id - 1].ip);
+    if (ip[0] == '\0') {
+        const MachinesConfigList *conf = config_acquire();
+        const char *fija = config_get_machine_ip(conf, id);
+        if (fija) snprintf(ip, cap, "%s", fija);
+        config_release(conf);
     }
-    return ""; // No encontrada
+}
+
+static void seleccionar_maquina(int id) {
+    maquina_activa_id = id;
+    pthread_mutex_lock(&state_mutex);
+    ip_de_maquina(id, ip_maquina_objetivo, sizeof(ip_maquina_objetivo));
+    pthread_mutex_unlock(&state_mutex);
 }
 
 // --- FUNCIÓN DE INICIO: LLENAR ROLLER (Llamar al iniciar) ---
+// Se llama con state_mutex tomado (desde el loop de la UI)
 void ActualizarRollerMaquinas(void) {
     // CAMBIA 'ui_listMaquinas' POR EL NOMBRE REAL DE TU ROLLER DE MÁQUINAS (EN DASHBOARD)
     lv_obj_t * roller = ui_listMaquinas;
 
     if (!roller) return;
 
-    char opciones[1024] = "";
+    const MachinesConfigList *conf = config_acquire();
+    char opciones[MAX_MAQUINAS * 80] = "";
     int count = 0;
-
-    for(int i=0; i<MAX_MAQUINAS; i++) {
-        if (global_state.maquinas[i].activa) {
-            char linea[64];
-            // Mostrar "M1 - 192.168.1.50"
-            if (strlen(global_state.maquinas[i].ip) > 0) {
-                snprintf(linea, 64, "M%d - %s", global_state.maquinas[i].id, global_state.maquinas[i].ip);
-            } else {
-                snprintf(linea, 64, "Maquina %d", global_state.maquinas[i].id);
-            }
-
-            if (count > 0) strcat(opciones, "\n");
-            strcat(opciones, linea);
-            count++;
-        }
+    int seleccion = 0;
+
+    for (int id = 1; id <= MAX_MAQUINAS; id++) {
+        const MachineConfig *mc = config_find(conf, id);
+        if (!mc && !global_state.maquinas[id - 1].activa) continue;
+
+        char ip[64];
+        char linea[128];
+        ip_de_maquina(id, ip, sizeof(ip));
+        // "CNC 01 (Fresadora) - 192.168.1.50" o "M3 - 192.168.1.52"
+        if (mc) snprintf(linea, sizeof(linea), "%s%s%s", mc->name, ip[0] ? " - " : "", ip);
+        else if (ip[0]) snprintf(linea, sizeof(linea), "M%d - %s", id, ip);
+        else snprintf(linea, sizeof(linea), "Maquina %d", id);
+
+        if (count > 0) strncat(opciones, "\n", sizeof(opciones) - strlen(opciones) - 1);
+        strncat(opciones, linea, sizeof(opciones) - strlen(opciones) - 1);
+        if (id == maquina_activa_id) seleccion = count;
+        roller_ids[count++] = id;
     }
+    config_release(conf);
+    roller_total = count;
 
     if (count == 0) {
         lv_roller_set_options(roller, "Esperando maquinas...", LV_ROLLER_MODE_NORMAL);
     } else {
         lv_roller_set_options(roller, opciones, LV_ROLLER_MODE_NORMAL);
+        lv_roller_set_selected(roller, seleccion, LV_ANIM_OFF);
     }
 }
 
 // Esta función debe llamarse una vez al arrancar la UI
 void InicializarListaMaquinas(void) {
-    lv_obj_t * roller = ui_listMaquinas;
-    if (!roller) return;
-
-    char opciones[512] = "";
+    pthread_mutex_lock(&state_mutex);
+    ActualizarRollerMaquinas();
+    pthread_mutex_unlock(&state_mutex);
 
-    // Construir string: "CNC 01\nCNC 02"
-    for(int i=0; i<total_maquinas_fijas; i++) {
-        strcat(opciones, maquinas_fijas[i].nombre);
-        if (i < total_maquinas_fijas - 1) strcat(opciones, "\n");
+    // Seleccionar la primera por defecto
+    if (roller_total > 0) {
+        if (ui_listMaquinas) lv_roller_set_selected(ui_listMaquinas, 0, LV_ANIM_OFF);
+        seleccionar_maquina(roller_ids[0]);
     }
 
-    lv_roller_set_options(roller, opciones, LV_ROLLER_MODE_NORMAL);
+    CargarPasosJog();
+}
 
-    // Seleccionar la primera por defecto
-    lv_roller_set_selected(roller, 0, LV_ANIM_OFF);
-    maquina_activa_id = maquinas_fijas[0].id;
-    strcpy(ip_maquina_objetivo, maquinas_fijas[0].ip);
+// Selección completa: ID, IP, log y pasos de jog
+static void mostrar_seleccion(int id) {
+    seleccionar_maquina(id);
+
+    // Logs y Visualización
+    char nombre[MAX_NAME_LEN + 16];
+    const MachinesConfigList *conf = config_acquire();
+    const MachineConfig *mc = config_find(conf, maquina_activa_id);
+    if (mc) snprintf(nombre, sizeof(nombre), "%s", mc->name);
+    else snprintf(nombre, sizeof(nombre), "Maquina %d", maquina_activa_id);
+    config_release(conf);
+
+    char buf[160];
+    snprintf(buf, sizeof(buf), "Sel: %s (%s)", nombre, ip_maquina_objetivo);
+    ui_add_log(id, buf);
 
-    // Actualizar Label de IP
-    ui_update_ip_display(ip_maquina_objetivo);
+    CargarPasosJog();
 }
 
 // --- EVENTO: AL CAMBIAR EL ROLLER ---
@@ -109,53 +133,43 @@ void listar_maquinas(lv_event_t * e) {
     lv_obj_t * roller = lv_event_get_target(e);
     int index = lv_roller_get_selected(roller); // 0, 1...
 
-    // Actualizar ID y IP según el array fijo
-    if (index < total_maquinas_fijas) {
-        maquina_activa_id = maquinas_fijas[index].id;
-        strcpy(ip_maquina_objetivo, maquinas_fijas[index].ip);
-
-        // Logs y Visualización
-        char buf[64];
-        snprintf(buf, 64, "Sel: %s (%s)", maquinas_fijas[index].nombre, ip_maquina_objetivo);
-        ui_add_log(buf);
+    // Actualizar ID y IP según lo que se mostró en el roller
+    if (index < roller_total) mostrar_seleccion(roller_ids[index]);
+}
 
-        ui_update_ip_display(ip_maquina_objetivo);
+// --- DESDE LA PANTALLA DE FLOTA: ELEGIR UNA MÁQUINA ---
+void SeleccionarMaquina(int id) {
+    for (int i = 0; i < roller_total; i++) {
+        if (roller_ids[i] != id) continue;
+        if (ui_listMaquinas) lv_roller_set_selected(ui_listMaquinas, i, LV_ANIM_OFF);
+        mostrar_seleccion(id);
+        return;
     }
 }
 
 // --- HELPER DE ENVÍO (WEBSOCKET) ---
 void enviar_orden_cnc(const char* comando) {
+    int id = maquina_activa_id;
     if (strlen(ip_maquina_objetivo) == 0) {
-        ui_add_log("ERROR: Sin IP de destino");
+        ui_add_log(id, "ERROR: Sin IP de destino");
         return;
     }
 
-    char ip_con_puerto[40];
-    snprintf(ip_con_puerto, 40, "%s:81", ip_maquina_objetivo); // Puerto WebSocket estándar
-
-    // Llamada a tu función de WebSocket
-    run_websocket_cmd(ip_con_puerto, comando);
-
-    // Log visual
+    // Por la conexión persistente de la máquina; no se espera el ok para no
+    // trabar la UI (los error:/ALARM los registra el pool)
     char log[64];
-    snprintf(log, 64, "M%d TX: %s", maquina_activa_id, comando);
-    ui_add_log(log);
+    if (ws_pool_enviar(id, comando) < 0) {
+        snprintf(log, 64, "M%d sin conexion: %s", id, comando);
+    } else {
+        snprintf(log, 64, "M%d TX: %s", id, comando);
+    }
+    ui_add_log(id, log);
 }
 
 // --- RESTO DE EVENTOS (Archivos y Movimiento) ---
-// Función auxiliar para leer el estado de la DB (escrito por Python)
+// Estado de la DB según la última consulta del hilo de sincronización
 int verificar_estado_db() {
-    FILE *f = fopen("db_status.txt", "r");
-    if (!f) return 0; // Asumimos error si no existe
-
-    char buffer[16];
-    if (fgets(buffer, sizeof(buffer), f)) {
-        fclose(f);
-        if (strstr(buffer, "OK")) return 1;
-    } else {
-        fclose(f);
-    }
-    return 0; // Error
+    return order_sync_db_ok();
 }
 
 void RefrescarListaArchivos(lv_event_t * e) {
@@ -208,22 +222,22 @@ void RefrescarListaArchivos(lv_event_t * e) {
 
 // ... (El resto de funciones agregar_tarea, retrocederMain, etc. se mantienen IGUAL) ...
 void agregar_tarea(lv_event_t * e) {
-    system("python3 /home/merry/proyecto_cnc_hmi/src/aws/sync_cloud.py once");
-    if (ui_seleccionarTarea) {
-        _ui_screen_change(&ui_seleccionarTarea, LV_SCR_LOAD_ANIM_NONE, 0, 0, &ui_seleccionarTarea_screen_init);
-        RefrescarListaArchivos(NULL);
-    }
+    // La sincronización corre en segundo plano: solo pedimos que se adelante.
+    // Si llegan archivos nuevos, thread_ui_loop vuelve a refrescar la lista.
+    order_sync_trigger();
+    ui_pantalla_ir(PANTALLA_TAREAS, LV_SCR_LOAD_ANIM_NONE, 0);
+    RefrescarListaArchivos(NULL);
 }
 
 void retrocederMain(lv_event_t * e) {
-    _ui_screen_change(&ui_main, LV_SCR_LOAD_ANIM_FADE_ON, 200, 0, &ui_main_screen_init);
+    ui_pantalla_ir(PANTALLA_MAIN, LV_SCR_LOAD_ANIM_FADE_ON, 200);
 }
 
 void asignar_tarea(lv_event_t * e) {
     // 1. Obtener el objeto Roller
     lv_obj_t * roller = ui_listaTareas1;
     if (!roller) {
-        ui_add_log("ERROR: No se encuentra la lista de tareas.");
+        ui_add_log(0, "ERROR: No se encuentra la lista de tareas.");
         return;
     }
 
@@ -233,98 +247,163 @@ void asignar_tarea(lv_event_t * e) {
     
     // 3. Validaciones básicas
     if (strlen(seleccion) == 0 || strcmp(seleccion, "Sin archivos") == 0 || strcmp(seleccion, "Vacio") == 0) {
-        ui_add_log("ADVERTENCIA: Seleccione un archivo válido.");
+        ui_add_log(0, "ADVERTENCIA: Seleccione un archivo válido.");
         return; 
     }
 
-    // --- CORRECCIÓN IP (Lógica momentánea) ---
-    const char *ip_destino = NULL;
-    // Calculamos el tamaño del array automáticamente
-    int total_maquinas = sizeof(maquinas_fijas) / sizeof(maquinas_fijas[0]);
-
-    // Buscamos la IP que corresponde al ID activo
-    for (int i = 0; i < total_maquinas; i++) {
-        if (maquinas_fijas[i].id == maquina_activa_id) {
-            ip_destino = maquinas_fijas[i].ip;
-            break; // Encontrado, salimos del bucle
-        }
-    }
-
-    // Si no encontramos la IP, abortamos para evitar crash
-    if (ip_destino == NULL) {
-        ui_add_log("ERROR: No se encontró IP para la máquina activa.");
-        return;
-    }
-    // ------------------------------------------
+    // 4. Encolar en la máquina activa; el planificador lo sube y lo arranca
+    //    cuando la máquina quede en IDLE (ver scheduler/job_scheduler.c)
+    int id = maquina_activa_id;
+    int job_id = sched_encolar(seleccion, 1, SCHED_PRIORIDAD_NORMAL, id, 0);
 
-    // 4. Feedback en consola visual
     char log_msg[256];
-    // Nota: cambié %d por %s en el log para mostrar la IP, o puedes dejar el ID si prefieres
-    snprintf(log_msg, sizeof(log_msg), "Asignando '%s' a %s...", seleccion, ip_destino);
-    ui_add_log(log_msg);
-    
-    // Forzamos actualización visual antes de bloquear (opcional pero recomendado)
-    lv_task_handler(); 
-
-    // 5. Construir ruta
-    char path[256];
-    snprintf(path, sizeof(path), "gcode_files/%s", seleccion);
-    
-    // CORRECCIÓN PRINCIPAL: Pasamos 'ip_destino' (cadena) en lugar del ID (entero)
-    upload_file_to_sd(ip_destino, path, seleccion);
+    if (job_id < 0) {
+        snprintf(log_msg, sizeof(log_msg), "ERROR: Cola llena, no se pudo asignar '%s'.", seleccion);
+    } else {
+        snprintf(log_msg, sizeof(log_msg), "'%s' en cola de M%d (J%d, ~%.0f min pendientes)",
+                 seleccion, id, job_id, sched_backlog_segundos(id) / 60.0f);
+    }
+    ui_add_log(id, log_msg);
 
     // 6. Regresar al Dashboard automáticamente
     retrocederMain(NULL);
 }
 
-// --- EVENTOS DE MOVIMIENTO (JOG) IGUALES QUE ANTES ---
-void mover_x_pos(lv_event_t * e) { 
-    char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('X',10, 7000, output);
-    enviar_orden_cnc(output);
-
-}
+// --- EVENTOS DE MOVIMIENTO (JOG) ---
+// El perfil (pasos, feed, límites) se lee de la configuración en cada uso:
+// si se edita machine_config.json vale desde el próximo toque.
 
-void mover_x_neg(lv_event_t * e) { 
-    char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('X',-10, 7000, output);
-    enviar_orden_cnc(output); 
+// Llena ui_pasos con los pasos del perfil: "Continuo" (mantener apretado) + pasos fijos
+void CargarPasosJog(void) {
+    if (!ui_pasos) return;
+    JogProfile perfil;
+    config_get_jog_profile(maquina_activa_id, &perfil);
 
+    char opciones[256] = "Continuo";
+    for (int i = 0; i < perfil.step_count; i++) {
+        size_t n = strlen(opciones);
+        snprintf(opciones + n, sizeof(opciones) - n, "\n%g mm", perfil.steps[i]);
+    }
+    // Si la recarga no cambió la cantidad de pasos se conserva la elección
+    uint16_t anterior = lv_dropdown_get_selected(ui_pasos);
+    lv_dropdown_set_options(ui_pasos, opciones);
+    lv_dropdown_set_selected(ui_pasos, anterior <= perfil.step_count ? anterior : 0);
 }
 
-void mover_y_pos(lv_event_t * e) { 
-    char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('Y',10, 7000, output);
-    enviar_orden_cnc(output); 
-
-}
+// Mantener apretado (modo "Continuo"): la máquina se mueve mientras el dedo
+// esté en el botón y al soltar se manda jog cancel. Con un paso elegido se
+// manda un solo $J de ese largo. Los límites de software se revisan acá
+// contra la última MPos: un jog fuera de rango ni sale de la central.
+static void jog_evento(lv_event_t * e, char eje, int sentido) {
+    lv_event_code_t code = lv_event_get_code(e);
+    int id = maquina_activa_id;
+    if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST) {
+        ws_pool_jog_parar(id);
+        return;
+    }
+    if (code != LV_EVENT_PRESSED) return;
+
+    JogProfile conf;
+    config_get_jog_profile(id, &conf);
+    const JogProfile *perfil = &conf;
+    int paso = ui_pasos ? (int)lv_dropdown_get_selected(ui_pasos) : 0;
+    int eje_idx = eje - 'X';
+    float mpos[3];
+    int hay_mpos = ws_pool_mpos(id, mpos);
+    char log[96];
+
+    if (paso == 0 || paso > perfil->step_count) {
+        // Continuo: el recorrido se corta en el límite
+        float tope = 0;
+        if (perfil->has_limits && hay_mpos) {
+            tope = (sentido > 0) ? perfil->limit_max[eje_idx] - mpos[eje_idx]
+                                 : mpos[eje_idx] - perfil->limit_min[eje_idx];
+            if (tope <= 0.001f) {
+                snprintf(log, sizeof(log), "M%d JOG %c%c: en el limite", id, eje, sentido > 0 ? '+' : '-');
+                ui_add_log(id, log);
+                return;
+            }
+        }
+        if (ws_pool_jog_iniciar(id, eje, sentido, perfil->feed, tope) < 0) {
+            snprintf(log, sizeof(log), "M%d sin conexion: JOG %c%c", id, eje, sentido > 0 ? '+' : '-');
+            ui_add_log(id, log);
+        }
+        return;
+    }
 
-void mover_y_neg(lv_event_t * e) { 
+    float distancia = sentido * perfil->steps[paso - 1];
+    if (hay_mpos && !config_jog_within_limits(perfil, eje_idx, mpos[eje_idx] + distancia)) {
+        snprintf(log, sizeof(log), "M%d JOG %c%+g: fuera de limites", id, eje, distancia);
+        ui_add_log(id, log);
+        return;
+    }
     char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('Y',-10, 7000, output);
-    enviar_orden_cnc(output); 
-
+    fluidnc_format_jog(eje, distancia, perfil->feed, output);
+    enviar_orden_cnc(output);
 }
 
-void mover_z_pos(lv_event_t * e) { 
-    char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('Z',10, 7000, output);
-    enviar_orden_cnc(output); 
-
+void mover_x_pos(lv_event_t * e) { jog_evento(e, 'X', +1); }
+void mover_x_neg(lv_event_t * e) { jog_evento(e, 'X', -1); }
+void mover_y_pos(lv_event_t * e) { jog_evento(e, 'Y', +1); }
+void mover_y_neg(lv_event_t * e) { jog_evento(e, 'Y', -1); }
+void mover_z_pos(lv_event_t * e) { jog_evento(e, 'Z', +1); }
+void mover_z_neg(lv_event_t * e) { jog_evento(e, 'Z', -1); }
+
+// --- CONFIRMAR REANUDACIÓN DE UN TRABAJO INTERRUMPIDO ---
+// La máquina puede haber quedado en otro lugar (la movieron a mano, se cambió
+// la herramienta): retomar a ciegas no es seguro
+static const char *botones_reanudacion[] = {"Reanudar", "Reiniciar", "Cancelar", ""};
+static int reanudacion_job = -1;
+static int reanudacion_maquina = 0;
+static char reanudacion_archivo[MAX_FILENAME_LEN];
+static int reanudacion_linea = 0;
+
+static void al_elegir_reanudacion(lv_event_t * e) {
+    lv_obj_t * mbox = lv_event_get_current_target(e);
+    uint16_t boton = lv_msgbox_get_active_btn(mbox);
+    char log_msg[160];
+
+    if (boton == 0 && sched_reanudar(reanudacion_job) == 0) {
+        snprintf(log_msg, sizeof(log_msg), "Reanudando J%d (%s) desde la linea %d",
+                 reanudacion_job, reanudacion_archivo, reanudacion_linea);
+        ui_add_log(reanudacion_maquina, log_msg);
+    } else if (boton == 1 && sched_reiniciar(reanudacion_job) == 0) {
+        snprintf(log_msg, sizeof(log_msg), "Reiniciando J%d (%s) desde el principio",
+                 reanudacion_job, reanudacion_archivo);
+        ui_add_log(reanudacion_maquina, log_msg);
+    } else if (boton <= 1) {
+        ui_add_log(reanudacion_maquina, "ADVERTENCIA: El trabajo ya no esta interrumpido.");
+    }
+    reanudacion_job = -1;
+    lv_msgbox_close(mbox);
 }
 
-void mover_z_neg(lv_event_t * e) { 
-    char output[FLUIDNC_CMD_MAX];
-    fluidnc_format_jog('Z',-10, 7000, output);
-    enviar_orden_cnc(output); 
-
+static void preguntar_reanudacion(int job_id, int maquina, const char *archivo, int linea) {
+    if (reanudacion_job > 0) return;    // Ya hay una pregunta abierta
+    reanudacion_job = job_id;
+    reanudacion_maquina = maquina;
+    reanudacion_linea = linea;
+    snprintf(reanudacion_archivo, sizeof(reanudacion_archivo), "%s", archivo);
+
+    char texto[200];
+    if (linea > 1) {
+        snprintf(texto, sizeof(texto), "%s quedo cortado en M%d.\n"
+                 "Reanudar desde la linea %d, reiniciar la pieza o cancelar?",
+                 archivo, maquina, linea);
+    } else {
+        snprintf(texto, sizeof(texto), "%s quedo cortado en M%d sin linea registrada.\n"
+                 "Reiniciar la pieza o cancelar?", archivo, maquina);
+    }
+    lv_obj_t * mbox = lv_msgbox_create(NULL, "Trabajo interrumpido", texto, botones_reanudacion, false);
+    lv_obj_add_event_cb(mbox, al_elegir_reanudacion, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_center(mbox);
 }
 
 void iniciarCorte(lv_event_t * e) { 
     // 1. Obtener el objeto Roller
     lv_obj_t * roller = ui_listaTareas1;
     if (!roller) {
-        // ui_add_log("ERROR: No se encuentra la lista de tareas.");
+        // ui_add_log(0, "ERROR: No se encuentra la lista de tareas.");
         return;
     }
 
@@ -334,9 +413,18 @@ void iniciarCorte(lv_event_t * e) {
     
     // 3. Validaciones básicas
     if (strlen(seleccion) == 0 || strcmp(seleccion, "Sin archivos") == 0 || strcmp(seleccion, "Vacio") == 0) {
-        ui_add_log("ADVERTENCIA: Seleccione un archivo válido.");
+        ui_add_log(0, "ADVERTENCIA: Seleccione un archivo válido.");
         return; 
     }
+    // Si este archivo quedó cortado en esta máquina (reinicio, corte de luz),
+    // el operador elige si se retoma desde la última línea registrada
+    int linea = 0;
+    int interrumpido = sched_buscar_interrumpido(maquina_activa_id, seleccion, &linea);
+    if (interrumpido > 0) {
+        preguntar_reanudacion(interrumpido, maquina_activa_id, seleccion, linea);
+        return;
+    }
+
     char command[256];
     snprintf(command, sizeof(command), "$SD/Run=/%s", seleccion);
     
@@ -344,9 +432,30 @@ void iniciarCorte(lv_event_t * e) {
     enviar_orden_cnc(command); 
 }
 
+// Comandos de tiempo real: van por el carril prioritario del pool, no esperan
+// detrás de las líneas en cola ni del streamer
+static void enviar_tiempo_real(unsigned char byte, const char *nombre) {
+    int id = maquina_activa_id;
+    char log[64];
+    if (ws_pool_tiempo_real(id, byte) < 0) {
+        snprintf(log, sizeof(log), "M%d sin conexion: %s", id, nombre);
+    } else {
+        snprintf(log, sizeof(log), "M%d RT: %s", id, nombre);
+    }
+    ui_add_log(id, log);
+}
+
 void pauseMachine(lv_event_t * e) { 
-    
-    enviar_orden_cnc("PAUSE"); 
+    // El mismo botón pausa (feed hold) y reanuda (cycle start)
+    int en_hold = 0;
+    pthread_mutex_lock(&state_mutex);
+    if (maquina_activa_id >= 1 && maquina_activa_id <= MAX_MAQUINAS) {
+        en_hold = strncasecmp(global_state.maquinas[maquina_activa_id - 1].estado, "hold", 4) == 0;
+    }
+    pthread_mutex_unlock(&state_mutex);
+
+    if (en_hold) enviar_tiempo_real(FLUIDNC_RT_CYCLE_START, "REANUDAR");
+    else enviar_tiempo_real(FLUIDNC_RT_FEED_HOLD, "PAUSA");
 }
 
 void home_positions(lv_event_t * e) { 
@@ -355,9 +464,20 @@ void home_positions(lv_event_t * e) {
 }
 
 void parado_de_emergencia(lv_event_t * e) { 
-    
-    enviar_orden_cnc("STOP"); 
+    // Feed hold + soft reset: frena ya y vacía el buffer del controlador
+    enviar_tiempo_real(FLUIDNC_RT_FEED_HOLD, "HOLD");
+    enviar_tiempo_real(FLUIDNC_RT_RESET, "RESET");
 }
 
-void parado_total(lv_event_t * e) { mqtt_send_command("todas", "EMERGENCIA"); ui_add_log("PARO TOTAL"); }
+void parado_total(lv_event_t * e) {
+    // Tiempo real a todas las conectadas (no hay "ok" que esperar);
+    // MQTT queda para las que no tienen WebSocket
+    ws_pool_tiempo_real_todas(FLUIDNC_RT_FEED_HOLD);
+    int n = ws_pool_tiempo_real_todas(FLUIDNC_RT_RESET);
+    mqtt_send_command("todas", "EMERGENCIA");
+
+    char log[96];
+    snprintf(log, sizeof(log), "PARO TOTAL: %d maquinas por WebSocket + MQTT", n);
+    ui_add_log(0, log);
+}
 
@@ -13,6 +13,8 @@ extern "C" {
 #endif
 
 void InicializarListaMaquinas(void);
+void CargarPasosJog(void);
+void RefrescarListaArchivos(lv_event_t * e);
 
 void IrSeleccionarTarea(lv_event_t * e);
 void retrocederMain(lv_event_t * e);
@@ -20,6 +22,7 @@ void EnviarArchivoDesdeRoller(lv_event_t * e);
 void agregar_tarea(lv_event_t * e);
 void asignar_tarea(lv_event_t * e);
 void listar_maquinas(lv_event_t * e);
+void SeleccionarMaquina(int id);
 void parado_total(lv_event_t * e);
 void mqtt_send_command(const char *topic, const char *cmd);
 
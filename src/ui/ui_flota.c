@@ -0,0 +1,371 @@
+#include "ui.h"
+#include "ui_flota.h"
+#include "ui_pantallas.h"
+#include "../mqtt/mqtt_service.h"
+#include "../config/machine_config.h"
+#include "../scheduler/job_scheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <pthread.h>
+
+extern pthread_mutex_t state_mutex;
+
+// Geometría pensada para el panel de 800x480
+#define FLOTA_COLS      4
+#define TILE_W          184
+#define TILE_H          100
+#define TILE_GAP        8
+#define PASO_Y          (TILE_H + TILE_GAP)
+#define GRILLA_W        780
+#define GRILLA_H        400
+#define FILAS_POOL      (GRILLA_H / PASO_Y + 2)     // Las que entran + la que asoma arriba y abajo
+#define N_TILES         (FILAS_POOL * FLOTA_COLS)
+#define FLOTA_LENTO_MS  1000                        // Edad y avance: cambian con el reloj, no con la versión
+
+typedef struct {
+    lv_obj_t *obj;
+    lv_obj_t *nombre;
+    lv_obj_t *estado;
+    lv_obj_t *pos;
+    lv_obj_t *barra;
+    lv_obj_t *edad;
+    int idx;                    // Posición en flota_ids (-1 = sin usar)
+    int id;
+    int sucio;                  // Recién asignada: dibujar todo
+    unsigned int version;       // Versión de MaquinaData ya dibujada
+    int progreso;               // % dibujado (-1 = sin trabajo)
+    // Último texto puesto: un label que no cambia no se invalida
+    char txt_estado[32];
+    char txt_pos[48];
+    char txt_edad[24];
+} Tile;
+
+lv_obj_t * ui_flota = NULL;
+static lv_obj_t * barra_sup;
+static lv_obj_t * lbl_resumen;
+static lv_obj_t * grilla;
+static lv_obj_t * relleno;      // Estira el área de scroll hasta la última fila
+static lv_obj_t * btn_flota;    // En la barra de ui_main (residente)
+
+static Tile tiles[N_TILES];
+static int flota_ids[MAX_MAQUINAS];
+static int flota_total = 0;
+static long ultimo_lento = 0;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void poner_texto(lv_obj_t *lbl, char *cache, size_t cap, const char *txt) {
+    if (strncmp(cache, txt, cap - 1) == 0) return;
+    snprintf(cache, cap, "%s", txt);
+    lv_label_set_text(lbl, cache);
+}
+
+static lv_color_t color_estado(const char *e, int activa) {
+    if (!activa) return lv_palette_main(LV_PALETTE_GREY);
+    if (strncasecmp(e, "Run", 3) == 0 || strncasecmp(e, "Jog", 3) == 0 || strstr(e, "TRABAJANDO"))
+        return lv_palette_main(LV_PALETTE_GREEN);
+    if (strncasecmp(e, "Alarm", 5) == 0 || strstr(e, "ERROR"))
+        return lv_palette_main(LV_PALETTE_RED);
+    if (strncasecmp(e, "Hold", 4) == 0 || strncasecmp(e, "Door", 4) == 0)
+        return lv_palette_main(LV_PALETTE_ORANGE);
+    return lv_palette_main(LV_PALETTE_BLUE);
+}
+
+// --------------------------------------------------------------------------
+// Dibujo de una tarjeta
+// --------------------------------------------------------------------------
+static void dibujar_nombre(Tile *t) {
+    const MachinesConfigList *conf = config_acquire();
+    const MachineConfig *mc = config_find(conf, t->id);
+    if (mc) lv_label_set_text(t->nombre, mc->name);
+    else lv_label_set_text_fmt(t->nombre, "Maquina %d", t->id);
+    config_release(conf);
+    t->txt_estado[0] = '\0';
+    t->txt_pos[0] = '\0';
+    t->txt_edad[0] = '\0';
+    t->progreso = -2;
+}
+
+static void dibujar_datos(Tile *t, const MaquinaData *m) {
+    const char *estado = m->estado[0] ? m->estado : "SIN DATOS";
+    if (strcmp(estado, t->txt_estado) != 0) {
+        lv_color_t c = color_estado(estado, m->activa);
+        lv_obj_set_style_border_color(t->obj, c, LV_PART_MAIN | LV_STATE_DEFAULT);
+        lv_obj_set_style_text_color(t->estado, c, LV_PART_MAIN | LV_STATE_DEFAULT);
+    }
+    poner_texto(t->estado, t->txt_estado, sizeof(t->txt_estado), estado);
+
+    char txt[48];
+    snprintf(txt, sizeof(txt), "X%.1f Y%.1f Z%.1f", m->pos_x, m->pos_y, m->pos_z);
+    poner_texto(t->pos, t->txt_pos, sizeof(t->txt_pos), txt);
+    t->version = m->version;
+}
+
+static void dibujar_lentos(Tile *t, long visto_ms, long ahora) {
+    char txt[24];
+    if (visto_ms == 0) {
+        snprintf(txt, sizeof(txt), "--");
+    } else {
+        long s = (ahora - visto_ms) / 1000;
+        if (s < 60) snprintf(txt, sizeof(txt), "hace %ld s", s);
+        else if (s < 3600) snprintf(txt, sizeof(txt), "hace %ld min", s / 60);
+        else snprintf(txt, sizeof(txt), "hace %ld h", s / 3600);
+    }
+    poner_texto(t->edad, t->txt_edad, sizeof(t->txt_edad), txt);
+
+    float p = sched_progreso(t->id);
+    int pct = (p < 0) ? -1 : (int)(p * 100.0f + 0.5f);
+    if (pct == t->progreso) return;
+    if (pct < 0) {
+        lv_obj_add_flag(t->barra, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_clear_flag(t->barra, LV_OBJ_FLAG_HIDDEN);
+        lv_bar_set_value(t->barra, pct, LV_ANIM_OFF);
+    }
+    t->progreso = pct;
+}
+
+// --------------------------------------------------------------------------
+// Virtualización: la fila f de la grilla usa las tarjetas de la fila
+// f % FILAS_POOL del pool. Al desplazar una fila solo se reasignan las
+// tarjetas de la fila que entra; las demás siguen donde estaban.
+// --------------------------------------------------------------------------
+static void ubicar_tiles(int forzar) {
+    lv_coord_t y = lv_obj_get_scroll_y(grilla);
+    int primera = (y > 0) ? y / PASO_Y : 0;
+
+    for (int f = primera; f < primera + FILAS_POOL; f++) {
+        for (int c = 0; c < FLOTA_COLS; c++) {
+            Tile *t = &tiles[(f % FILAS_POOL) * FLOTA_COLS + c];
+            int idx = f * FLOTA_COLS + c;
+            if (idx >= flota_total) {
+                if (t->idx != -1) {
+                    lv_obj_add_flag(t->obj, LV_OBJ_FLAG_HIDDEN);
+                    t->idx = -1;
+                }
+                continue;
+            }
+            if (t->idx == idx && !forzar) continue;
+            t->idx = idx;
+            t->id = flota_ids[idx];
+            t->sucio = 1;
+            lv_obj_set_pos(t->obj, TILE_GAP + c * (TILE_W + TILE_GAP), TILE_GAP + f * PASO_Y);
+            lv_obj_clear_flag(t->obj, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+// Eventos
+// --------------------------------------------------------------------------
+// Corre dentro de lv_timer_handler, nunca con state_mutex tomado
+static void al_desplazar(lv_event_t * e) {
+    (void)e;
+    ubicar_tiles(0);
+    ui_flota_refrescar();   // Las que entraron se dibujan en este mismo frame
+}
+
+static void al_tocar_tile(lv_event_t * e) {
+    Tile *t = lv_event_get_user_data(e);
+    if (t->idx < 0) return;
+    SeleccionarMaquina(t->id);
+    retrocederMain(e);
+}
+
+static void al_mostrar(lv_event_t * e) {
+    (void)e;
+    ultimo_lento = 0;       // La edad quedó vieja mientras no se veía
+}
+
+static void ir_flota(lv_event_t * e) {
+    (void)e;
+    ui_pantalla_ir(PANTALLA_FLOTA, LV_SCR_LOAD_ANIM_NONE, 0);
+}
+
+// --------------------------------------------------------------------------
+// Construcción
+// --------------------------------------------------------------------------
+static void crear_tile(Tile *t) {
+    t->obj = lv_obj_create(grilla);
+    lv_obj_set_size(t->obj, TILE_W, TILE_H);
+    lv_obj_clear_flag(t->obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(t->obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_style_pad_all(t->obj, 6, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(t->obj, 3, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(t->obj, al_tocar_tile, LV_EVENT_CLICKED, t);
+
+    t->nombre = lv_label_create(t->obj);
+    lv_obj_set_width(t->nombre, lv_pct(100));
+    lv_label_set_long_mode(t->nombre, LV_LABEL_LONG_DOT);
+    lv_obj_set_align(t->nombre, LV_ALIGN_TOP_LEFT);
+    lv_obj_set_style_text_font(t->nombre, &lv_font_montserrat_14, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    t->estado = lv_label_create(t->obj);
+    lv_obj_set_align(t->estado, LV_ALIGN_LEFT_MID);
+    lv_obj_set_y(t->estado, -8);
+    lv_obj_set_style_text_font(t->estado, &lv_font_montserrat_14, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    t->pos = lv_label_create(t->obj);
+    lv_obj_set_align(t->pos, LV_ALIGN_LEFT_MID);
+    lv_obj_set_y(t->pos, 10);
+    lv_obj_set_style_text_font(t->pos, &lv_font_montserrat_12, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    t->barra = lv_bar_create(t->obj);
+    lv_obj_set_size(t->barra, 90, 8);
+    lv_obj_set_align(t->barra, LV_ALIGN_BOTTOM_LEFT);
+    lv_bar_set_range(t->barra, 0, 100);
+    lv_obj_clear_flag(t->barra, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(t->barra, LV_OBJ_FLAG_HIDDEN);
+
+    t->edad = lv_label_create(t->obj);
+    lv_obj_set_align(t->edad, LV_ALIGN_BOTTOM_RIGHT);
+    lv_obj_set_style_text_font(t->edad, &lv_font_montserrat_12, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_text_color(t->edad, lv_color_hex(0x737373), LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    t->idx = -1;
+    t->progreso = -2;
+}
+
+void ui_flota_screen_init(void) {
+    if (ui_flota) return;
+
+    ui_flota = lv_obj_create(NULL);
+    lv_obj_clear_flag(ui_flota, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_color(ui_flota, lv_color_hex(0x202020), LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(ui_flota, 255, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(ui_flota, al_mostrar, LV_EVENT_SCREEN_LOADED, NULL);
+
+    barra_sup = lv_obj_create(ui_flota);
+    lv_obj_set_size(barra_sup, GRILLA_W, 50);
+    lv_obj_set_y(barra_sup, 10);
+    lv_obj_set_align(barra_sup, LV_ALIGN_TOP_MID);
+    lv_obj_clear_flag(barra_sup, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *titulo = lv_label_create(barra_sup);
+    lv_obj_set_align(titulo, LV_ALIGN_CENTER);
+    lv_label_set_text(titulo, "FLOTA");
+
+    lbl_resumen = lv_label_create(barra_sup);
+    lv_obj_set_align(lbl_resumen, LV_ALIGN_LEFT_MID);
+    lv_label_set_text(lbl_resumen, "--");
+    lv_obj_set_style_text_font(lbl_resumen, &lv_font_montserrat_12, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    lv_obj_t *atras = lv_btn_create(barra_sup);
+    lv_obj_set_size(atras, 100, 40);
+    lv_obj_set_align(atras, LV_ALIGN_RIGHT_MID);
+    lv_obj_add_event_cb(atras, retrocederMain, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_atras = lv_label_create(atras);
+    lv_obj_set_align(lbl_atras, LV_ALIGN_CENTER);
+    lv_label_set_text(lbl_atras, "Atras");
+
+    grilla = lv_obj_create(ui_flota);
+    lv_obj_set_size(grilla, GRILLA_W, GRILLA_H);
+    lv_obj_set_y(grilla, -10);
+    lv_obj_set_align(grilla, LV_ALIGN_BOTTOM_MID);
+    lv_obj_set_style_pad_all(grilla, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(grilla, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(grilla, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_scroll_dir(grilla, LV_DIR_VER);
+    lv_obj_add_event_cb(grilla, al_desplazar, LV_EVENT_SCROLL, NULL);
+
+    relleno = lv_obj_create(grilla);
+    lv_obj_remove_style_all(relleno);
+    lv_obj_set_size(relleno, 1, 1);
+    lv_obj_clear_flag(relleno, LV_OBJ_FLAG_CLICKABLE);
+
+    for (int k = 0; k < N_TILES; k++) crear_tile(&tiles[k]);
+
+    pthread_mutex_lock(&state_mutex);
+    ui_flota_lista();
+    pthread_mutex_unlock(&state_mutex);
+}
+
+void ui_flota_screen_destroy(void) {
+    if (ui_flota) lv_obj_del(ui_flota);
+    ui_flota = NULL;
+    barra_sup = NULL;
+    lbl_resumen = NULL;
+    grilla = NULL;
+    relleno = NULL;
+    for (int k = 0; k < N_TILES; k++) tiles[k].idx = -1;
+    flota_total = 0;
+    ultimo_lento = 0;
+}
+
+// Acceso desde la barra de la pantalla principal, junto a STOP ALL
+void ui_flota_acceso_init(void) {
+    if (btn_flota || !ui_topBar) return;
+    btn_flota = lv_btn_create(ui_topBar);
+    lv_obj_set_size(btn_flota, 90, 40);
+    lv_obj_set_x(btn_flota, -110);
+    lv_obj_set_align(btn_flota, LV_ALIGN_RIGHT_MID);
+    lv_obj_add_event_cb(btn_flota, ir_flota, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn_flota);
+    lv_obj_set_align(lbl, LV_ALIGN_CENTER);
+    lv_label_set_text(lbl, "FLOTA");
+}
+
+// --------------------------------------------------------------------------
+// Lista y refresco
+// --------------------------------------------------------------------------
+void ui_flota_lista(void) {
+    if (!ui_flota) return;
+
+    const MachinesConfigList *conf = config_acquire();
+    int n = 0, en_linea = 0;
+    for (int id = 1; id <= MAX_MAQUINAS; id++) {
+        int activa = global_state.maquinas[id - 1].activa;
+        if (!activa && !config_find(conf, id)) continue;
+        flota_ids[n++] = id;
+        en_linea += activa;
+    }
+    config_release(conf);
+    flota_total = n;
+
+    int filas = (n + FLOTA_COLS - 1) / FLOTA_COLS;
+    lv_obj_set_pos(relleno, 0, TILE_GAP + filas * PASO_Y - 1);
+    lv_label_set_text_fmt(lbl_resumen, "%d maquinas, %d en linea", n, en_linea);
+    ubicar_tiles(1);        // Los IDs pudieron correrse de lugar
+}
+
+void ui_flota_refrescar(void) {
+    if (!ui_flota || lv_scr_act() != ui_flota) return;
+
+    // Copia solo de las visibles que cambiaron; el dibujo va sin state_mutex
+    static MaquinaData copia[N_TILES];
+    int cambio[N_TILES];
+    long visto[N_TILES];
+
+    pthread_mutex_lock(&state_mutex);
+    for (int k = 0; k < N_TILES; k++) {
+        Tile *t = &tiles[k];
+        cambio[k] = 0;
+        if (t->idx < 0) continue;
+        const MaquinaData *m = &global_state.maquinas[t->id - 1];
+        visto[k] = m->visto_ms;
+        if (t->sucio || m->version != t->version) {
+            copia[k] = *m;
+            cambio[k] = 1;
+        }
+    }
+    pthread_mutex_unlock(&state_mutex);
+
+    long ahora = ahora_ms();
+    int lentos = (ahora - ultimo_lento >= FLOTA_LENTO_MS);
+    if (lentos) ultimo_lento = ahora;
+
+    for (int k = 0; k < N_TILES; k++) {
+        Tile *t = &tiles[k];
+        if (t->idx < 0) continue;
+        if (t->sucio) dibujar_nombre(t);
+        if (cambio[k]) dibujar_datos(t, &copia[k]);
+        if (lentos || t->sucio) dibujar_lentos(t, visto[k], ahora);
+        t->sucio = 0;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef UI_FLOTA_H
+#define UI_FLOTA_H
+
+#include "ui.h"
+
+// --- PANTALLA DE FLOTA ---
+// Grilla de tarjetas (estado, posición, avance del trabajo, hace cuánto
+// reportó) con scroll virtualizado: solo existen las tarjetas que entran en
+// pantalla más una fila, y se reciclan al desplazar. Cada tarjeta se redibuja
+// solo cuando cambia la versión de su máquina.
+
+extern lv_obj_t * ui_flota;
+
+// Crea el botón "FLOTA" en la barra de ui_main; la pantalla se construye
+// al entrar por primera vez (ui_pantallas.h)
+void ui_flota_acceso_init(void);
+
+// Crea la pantalla y carga la lista. Sin state_mutex tomado.
+void ui_flota_screen_init(void);
+void ui_flota_screen_destroy(void);
+
+// Rehace la lista de máquinas (config + activas). Con state_mutex tomado.
+void ui_flota_lista(void);
+
+// Desde el loop de la UI: redibuja las tarjetas visibles que cambiaron.
+// Toma state_mutex; no hace nada si la pantalla no está activa.
+void ui_flota_refrescar(void);
+
+#endif
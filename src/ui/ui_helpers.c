@@ -342,9 +342,3 @@ void _ui_switch_theme(int val)
     ui_theme_set(val);
 #endif
 }
-
-
-void ui_update_ip_display(const char *ip) {
-    // código que actualiza la UI
-}
-
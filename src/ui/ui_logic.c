@@ -1,18 +1,31 @@
 #include "ui.h"
 #include "ui_logic.h"
+#include "ui_consola.h"
+#include "ui_binding.h"
 #include <stdio.h>
 #include <string.h>
 
+// Labels de la pantalla principal enlazados a la máquina seleccionada
+static BindingGrupo grupo_main;
+
+static void color_estado(lv_obj_t *lbl, const char *estado) {
+    if (strstr(estado, "TRABAJANDO"))
+        lv_obj_set_style_text_color(lbl, lv_palette_main(LV_PALETTE_GREEN), 0);
+    else if (strstr(estado, "ERROR"))
+        lv_obj_set_style_text_color(lbl, lv_palette_main(LV_PALETTE_RED), 0);
+    else
+        lv_obj_set_style_text_color(lbl, lv_palette_main(LV_PALETTE_GREY), 0);
+}
+
+static void estilo_estado(lv_obj_t *lbl, const MaquinaData *m) {
+    color_estado(lbl, m->estado);
+}
+
 // --- ACTUALIZAR ESTADO (Verde/Rojo) ---
 void ui_update_status(const char* estado) {
     if (ui_lblState) {
         lv_label_set_text(ui_lblState, estado);
-        if (strstr(estado, "TRABAJANDO"))
-            lv_obj_set_style_text_color(ui_lblState, lv_palette_main(LV_PALETTE_GREEN), 0);
-        else if (strstr(estado, "ERROR"))
-            lv_obj_set_style_text_color(ui_lblState, lv_palette_main(LV_PALETTE_RED), 0);
-        else
-            lv_obj_set_style_text_color(ui_lblState, lv_palette_main(LV_PALETTE_GREY), 0);
+        color_estado(ui_lblState, estado);
     }
 }
 
@@ -24,11 +37,13 @@ void ui_update_coords(float x, float y, float z) {
 }
 
 // --- LOGS EN PANTALLA ---
-void ui_add_log(const char* mensaje) {
-    if (ui_areaComands) {
-        lv_textarea_add_text(ui_areaComands, mensaje);
-        lv_textarea_add_text(ui_areaComands, "\n");
-    }
+// Van al anillo de la consola a nombre de la máquina de la que hablan (0 =
+// general); la severidad sale del prefijo que ya usan los mensajes.
+void ui_add_log(int maquina, const char* mensaje) {
+    LogSeveridad sev = LOG_INFO;
+    if (strncmp(mensaje, "ERROR", 5) == 0) sev = LOG_ERROR;
+    else if (strncmp(mensaje, "ADVERTENCIA", 11) == 0 || strncmp(mensaje, "ALERTA", 6) == 0) sev = LOG_AVISO;
+    ui_log(maquina, sev, mensaje);
 }
 
 // --- SEMÁFORO DE CONEXIÓN ---
@@ -44,4 +59,15 @@ void ui_set_connection_status(int tipo, int estado) {
     }
 }
 
-void ui_init_custom_label(void) {}
+// --- MÁQUINA SELECCIONADA: solo cambia lo que cambió ---
+void ui_update_maquina(const MaquinaData *m) {
+    ui_binding_aplicar(&grupo_main, m);
+}
+
+void ui_init_custom_label(void) {
+    grupo_main.n = 0;
+    if (ui_lblposx) ui_binding_agregar(&grupo_main, ui_lblposx, CAMPO_POS_X, "X: %.*f", 2, NULL);
+    if (ui_lblposy) ui_binding_agregar(&grupo_main, ui_lblposy, CAMPO_POS_Y, "Y: %.*f", 2, NULL);
+    if (ui_lblposz) ui_binding_agregar(&grupo_main, ui_lblposz, CAMPO_POS_Z, "Z: %.*f", 2, NULL);
+    if (ui_lblState) ui_binding_agregar(&grupo_main, ui_lblState, CAMPO_ESTADO, "%s", 0, estilo_estado);
+}
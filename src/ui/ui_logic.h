@@ -1,11 +1,15 @@
 #ifndef UI_LOGIC_H
 #define UI_LOGIC_H
 #include <stdint.h>
+#include "../mqtt/mqtt_service.h"
 
 void ui_update_status(const char* estado);
 void ui_update_coords(float x, float y, float z);
-void ui_add_log(const char* mensaje);
+// Línea de consola sobre una máquina (0 = general)
+void ui_add_log(int maquina, const char* mensaje);
 void ui_set_connection_status(int tipo, int estado);
 void ui_init_custom_label(void);
+// Vuelca una copia de la máquina en los labels enlazados (ui_binding.h)
+void ui_update_maquina(const MaquinaData *m);
 void ui_set_ip_label(const char* ip_texto);
 #endif
@@ -0,0 +1,48 @@
+#include "ui_memoria.h"
+#include "../mem/heap_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static lv_obj_t * lbl_memoria;
+static long ultimo_ms = 0;
+static unsigned long max_allocs_frame = 0;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void ui_memoria_init(void) {
+    const char *v = getenv("CNC_DEBUG_HEAP");
+    if (!v || strcmp(v, "1") != 0 || lbl_memoria) return;
+
+    lbl_memoria = lv_label_create(lv_layer_top());
+    lv_obj_set_align(lbl_memoria, LV_ALIGN_BOTTOM_LEFT);
+    lv_obj_set_style_text_font(lbl_memoria, &lv_font_montserrat_12, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_text_color(lbl_memoria, lv_color_hex(0xFFFF00), LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_color(lbl_memoria, lv_color_hex(0x000000), LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(lbl_memoria, 180, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_clear_flag(lbl_memoria, LV_OBJ_FLAG_CLICKABLE);
+    lv_label_set_text(lbl_memoria, "heap --");
+}
+
+void ui_memoria_refrescar(void) {
+    heap_frame_marcar();
+    if (!lbl_memoria) return;
+
+    HeapStats h;
+    heap_stats(&h);
+    if (h.allocs_frame > max_allocs_frame) max_allocs_frame = h.allocs_frame;
+
+    long ahora = ahora_ms();
+    if (ahora - ultimo_ms < UI_MEMORIA_REFRESCO_MS) return;
+    ultimo_ms = ahora;
+
+    lv_label_set_text_fmt(lbl_memoria, "heap %zu/%lu KB  pico %zu KB  frag %d%%  %d slabs  arena %zu KB  %lu allocs/frame",
+                          h.usado / 1024, HEAP_PRESUPUESTO / 1024, h.pico / 1024, h.frag_pct,
+                          h.slabs, h.arena / 1024, max_allocs_frame);
+    max_allocs_frame = 0;
+}
@@ -0,0 +1,18 @@
+#ifndef UI_MEMORIA_H
+#define UI_MEMORIA_H
+
+#include "ui.h"
+
+// --- OVERLAY DE MEMORIA (depuración) ---
+// Una línea arriba de todo (lv_layer_top) con el heap de LVGL: usado contra
+// el presupuesto, pico, fragmentación, slabs y allocs por frame (el máximo
+// del último medio segundo). Solo con CNC_DEBUG_HEAP=1 en el entorno.
+
+#define UI_MEMORIA_REFRESCO_MS  500
+
+void ui_memoria_init(void);
+
+// Desde el loop de la UI, una vez por vuelta (cierra el frame del heap)
+void ui_memoria_refrescar(void);
+
+#endif
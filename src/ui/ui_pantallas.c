@@ -0,0 +1,83 @@
+#include "ui_pantallas.h"
+#include "ui_flota.h"
+#include "../mem/heap_pool.h"
+#include <stdio.h>
+#include <time.h>
+
+typedef struct {
+    const char *nombre;
+    lv_obj_t **obj;
+    void (*init)(void);
+    void (*destroy)(void);
+    int residente;              // Nunca se libera por memoria
+    long ultimo_uso_ms;
+} Pantalla;
+
+static Pantalla pantallas[PANTALLA_TOTAL] = {
+    [PANTALLA_MAIN]   = { "main",   &ui_main,             ui_main_screen_init,             ui_main_screen_destroy,             1, 0 },
+    [PANTALLA_TAREAS] = { "tareas", &ui_seleccionarTarea, ui_seleccionarTarea_screen_init, ui_seleccionarTarea_screen_destroy, 0, 0 },
+    [PANTALLA_FLOTA]  = { "flota",  &ui_flota,            ui_flota_screen_init,            ui_flota_screen_destroy,            0, 0 },
+};
+
+static long ultimo_mantener = 0;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void ui_pantallas_init(void) {
+    long ahora = ahora_ms();
+    for (int i = 0; i < PANTALLA_TOTAL; i++) {
+        if (*pantallas[i].obj) pantallas[i].ultimo_uso_ms = ahora;
+    }
+    ultimo_mantener = ahora;
+}
+
+void ui_pantalla_ir(PantallaId id, lv_scr_load_anim_t anim, int ms) {
+    if (id < 0 || id >= PANTALLA_TOTAL) return;
+    Pantalla *p = &pantallas[id];
+
+    // Solo la primera vez (o si se liberó por memoria)
+    if (*p->obj == NULL) {
+        p->init();
+        printf("[UI] Pantalla '%s' construida\n", p->nombre);
+    }
+    p->ultimo_uso_ms = ahora_ms();
+
+    if (lv_scr_act() == *p->obj) return;
+    // Sin auto_del: la pantalla que se va queda armada para volver
+    lv_scr_load_anim(*p->obj, anim, ms, 0, false);
+}
+
+// En uso: la activa y las que participan de una animación de carga
+static int en_uso(lv_obj_t *scr) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (scr == lv_scr_act()) return 1;
+    return disp && (scr == disp->prev_scr || scr == disp->scr_to_load);
+}
+
+void ui_pantallas_mantener(void) {
+    long ahora = ahora_ms();
+    if (ahora - ultimo_mantener < UI_MANTENER_MS) return;
+    ultimo_mantener = ahora;
+
+    HeapStats h;
+    heap_stats(&h);
+    int usado_pct = (int)(h.usado * 100 / HEAP_PRESUPUESTO);
+    if (usado_pct < UI_MEM_PRESION_PCT) return;
+
+    // Una por vuelta: la no residente que hace más que no se usa
+    Pantalla *victima = NULL;
+    for (int i = 0; i < PANTALLA_TOTAL; i++) {
+        Pantalla *p = &pantallas[i];
+        if (p->residente || *p->obj == NULL || en_uso(*p->obj)) continue;
+        if (!victima || p->ultimo_uso_ms < victima->ultimo_uso_ms) victima = p;
+    }
+    if (!victima) return;
+
+    printf("[UI] Memoria al %d%%: se libera la pantalla '%s' (sin uso hace %ld s)\n",
+           usado_pct, victima->nombre, (ahora - victima->ultimo_uso_ms) / 1000);
+    victima->destroy();
+}
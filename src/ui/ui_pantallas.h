@@ -0,0 +1,33 @@
+#ifndef UI_PANTALLAS_H
+#define UI_PANTALLAS_H
+
+#include "ui.h"
+
+// --- PANTALLAS RESIDENTES ---
+// Cada pantalla se construye una sola vez (la primera vez que se entra) y
+// queda en memoria: navegar es cargar el objeto que ya existe. Si el heap de
+// LVGL pasa de UI_MEM_PRESION_PCT de HEAP_PRESUPUESTO (mem/heap_pool.h) se
+// libera la pantalla no residente que hace más tiempo que no se usa; se
+// vuelve a construir si se entra de nuevo.
+// ui_main es residente: la consola, la flota y los bindings cuelgan de ella.
+
+#define UI_MEM_PRESION_PCT      75
+#define UI_MANTENER_MS          1000
+
+typedef enum {
+    PANTALLA_MAIN = 0,
+    PANTALLA_TAREAS,
+    PANTALLA_FLOTA,
+    PANTALLA_TOTAL
+} PantallaId;
+
+// Adopta las pantallas que ya construyó ui_init()
+void ui_pantallas_init(void);
+
+// Construye la pantalla si hace falta y la carga
+void ui_pantalla_ir(PantallaId id, lv_scr_load_anim_t anim, int ms);
+
+// Desde el loop de la UI: aplica la política de memoria (cada UI_MANTENER_MS)
+void ui_pantallas_mantener(void);
+
+#endif
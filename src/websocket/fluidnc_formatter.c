@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include "fluidnc_formatter.h"
+#include "fluidnc_status.h"
 
 // --------------------------------------------------------------------------
 // Formateador de movimiento (Jog)
@@ -42,38 +43,29 @@ void fluidnc_format_status(char *cmd) {
 int fluidnc_parse_mpos(const char *response, float *x, float *y, float *z) {
     if (!response || !x || !y || !z) return 0;
 
-    const char *ptr = NULL;
-
-    // 1. Intento de parseo Formato Legado (Grbl Style)
-    // Ejemplo: <Idle|MPos:10.000,20.000,30.000|FS:0,0>
-    ptr = strstr(response, "MPos:");
-    if (ptr) {
-        // Avanzamos el puntero después de "MPos:"
-        ptr += 5; 
-        if (sscanf(ptr, "%f,%f,%f", x, y, z) == 3) {
-            return 1; // Éxito
+    // 1. Reporte de estado Grbl: <Idle|MPos:10.000,20.000,30.000|FS:0,0>
+    //    Si viene WPos sin WCO no hay forma de saber la posición de máquina.
+    if (response[0] == '<') {
+        FluidncStatus st;
+        if (!fluidnc_parse_status(response, &st, NULL) || !(st.campos & FLUIDNC_CAMPO_MPOS)) {
+            return 0;
         }
+        *x = st.mpos[0];
+        *y = st.mpos[1];
+        *z = st.mpos[2];
+        return 1;
     }
 
-    // 2. Intento de parseo Formato JSON (FluidNC moderno)
-    // FluidNC a veces devuelve JSON si está configurado así en el canal.
-    // Ejemplo simplificado: "MPos":[10.00, 20.00, 30.00] o similar.
-    // Buscamos "MPos" seguido de caracteres hasta encontrar un numero o corchete.
-    
-    // Reiniciamos búsqueda
-    ptr = strstr(response, "\"MPos\""); // Busca la clave JSON con comillas
-    if (!ptr) ptr = strstr(response, "pos"); // Algunos reportes usan "pos"
-
+    // 2. Formato JSON (FluidNC moderno): "MPos":[10.00, 20.00, 30.00]
+    //    Solo la clave exacta: buscar cualquier "pos" agarraba "WPos" o
+    //    cualquier mensaje que tuviera esas letras.
+    const char *ptr = strstr(response, "\"MPos\"");
     if (ptr) {
-        // Buscar el inicio del array o los valores. 
-        // Avanzamos hasta encontrar un dígito o un signo menos
-        while (*ptr && !isdigit(*ptr) && *ptr != '-') {
+        ptr += 6;
+        while (*ptr == ' ' || *ptr == ':' || *ptr == '[') {
             ptr++;
         }
-        
-        // Parsear formato JSON array [x, y, z] o x,y,z
-        // Nota: sscanf maneja espacios en blanco automáticamente
-        // El formato string "%f , %f , %f" intenta saltar comas y espacios
+        // sscanf maneja espacios en blanco automáticamente
         if (*ptr && sscanf(ptr, "%f , %f , %f", x, y, z) == 3) {
             return 1; // Éxito
         }
@@ -8,6 +8,14 @@ extern "C" {
 // Tamaño recomendado para el buffer de comandos
 #define FLUIDNC_CMD_MAX 128
 
+// Comandos de tiempo real: un solo byte, sin '\n' y sin "ok" de respuesta.
+// El controlador los atiende apenas llegan, aunque tenga el buffer lleno.
+#define FLUIDNC_RT_STATUS       '?'
+#define FLUIDNC_RT_CYCLE_START  '~'
+#define FLUIDNC_RT_FEED_HOLD    '!'
+#define FLUIDNC_RT_RESET        0x18    // Ctrl-X: soft reset
+#define FLUIDNC_RT_JOG_CANCEL   0x85
+
 /**
  * @brief Formatea comandos de movimiento manual (jogging).
  * @param axis El eje a mover ('X', 'Y', 'Z').
@@ -45,7 +53,8 @@ void fluidnc_format_upload(const char *local_path, const char *remote_filename,
 
 /**
  * @brief Parsea la respuesta de FluidNC para extraer posición XYZ (MPos).
- * Soporta formato legado (Grbl) y busca patrones JSON básicos.
+ * Soporta el reporte de estado de Grbl (ver fluidnc_status.h para el resto
+ * de los campos) y la clave JSON "MPos".
  * * @param response La cadena recibida desde el WebSocket.
  * @param x Puntero para guardar la posición X.
  * @param y Puntero para guardar la posición Y.
@@ -0,0 +1,277 @@
+#include <string.h>
+#include "fluidnc_status.h"
+
+// --------------------------------------------------------------------------
+// Número decimal de Grbl: signo opcional, enteros, punto y decimales.
+// Grbl nunca manda exponente, así que alcanza con esto (y evita strtof, que
+// depende del locale).
+// --------------------------------------------------------------------------
+static int leer_numero(const char **pp, float *valor) {
+    const char *p = *pp;
+    int negativo = 0;
+    if (*p == '-' || *p == '+') negativo = (*p++ == '-');
+
+    float v = 0.0f;
+    int digitos = 0;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10.0f + (float)(*p++ - '0');
+        digitos++;
+    }
+    if (*p == '.') {
+        p++;
+        float escala = 0.1f;
+        while (*p >= '0' && *p <= '9') {
+            v += (float)(*p++ - '0') * escala;
+            escala *= 0.1f;
+            digitos++;
+        }
+    }
+    if (digitos == 0) return 0;
+
+    *valor = negativo ? -v : v;
+    *pp = p;
+    return 1;
+}
+
+// Entero sin signo; se satura en vez de desbordar (la línea viene de la red)
+static int leer_entero(const char **pp, long *valor) {
+    const char *p = *pp;
+    long v = 0;
+    if (*p < '0' || *p > '9') return 0;
+    while (*p >= '0' && *p <= '9') {
+        if (v < 100000000L) v = v * 10 + (*p - '0');
+        p++;
+    }
+    *valor = v;
+    *pp = p;
+    return 1;
+}
+
+// Lee hasta max números separados por coma. Devuelve cuántos leyó.
+static int leer_lista(const char **pp, float *valores, int max) {
+    int n = 0;
+    while (n < max && leer_numero(pp, &valores[n])) {
+        n++;
+        if (**pp != ',') break;
+        (*pp)++;
+    }
+    return n;
+}
+
+static int leer_enteros(const char **pp, long *valores, int max) {
+    int n = 0;
+    while (n < max && leer_entero(pp, &valores[n])) {
+        n++;
+        if (**pp != ',') break;
+        (*pp)++;
+    }
+    return n;
+}
+
+// Compara el nombre del campo ("MPos", "FS"...) con lo que hay antes de ':'
+static int campo_es(const char *campo, int largo, const char *nombre, int largo_nombre) {
+    return largo == largo_nombre && memcmp(campo, nombre, (size_t)largo) == 0;
+}
+
+#define CAMPO(nombre) campo_es(campo, largo, nombre, (int)sizeof(nombre) - 1)
+
+static FluidncEstado codigo_estado(const char *s, int largo) {
+    static const struct { const char *nombre; FluidncEstado codigo; } tabla[] = {
+        { "Idle", FLUIDNC_IDLE }, { "Run", FLUIDNC_RUN }, { "Hold", FLUIDNC_HOLD },
+        { "Jog", FLUIDNC_JOG }, { "Alarm", FLUIDNC_ALARM }, { "Door", FLUIDNC_DOOR },
+        { "Check", FLUIDNC_CHECK }, { "Home", FLUIDNC_HOME }, { "Sleep", FLUIDNC_SLEEP },
+    };
+    for (size_t i = 0; i < sizeof(tabla) / sizeof(tabla[0]); i++) {
+        if ((int)strlen(tabla[i].nombre) == largo && memcmp(s, tabla[i].nombre, (size_t)largo) == 0) {
+            return tabla[i].codigo;
+        }
+    }
+    return FLUIDNC_DESCONOCIDO;
+}
+
+static unsigned bits_pines(const char **pp) {
+    unsigned bits = 0;
+    for (const char *p = *pp; ; p++) {
+        switch (*p) {
+        case 'X': bits |= FLUIDNC_PIN_X; break;
+        case 'Y': bits |= FLUIDNC_PIN_Y; break;
+        case 'Z': bits |= FLUIDNC_PIN_Z; break;
+        case 'A': bits |= FLUIDNC_PIN_A; break;
+        case 'B': bits |= FLUIDNC_PIN_B; break;
+        case 'C': bits |= FLUIDNC_PIN_C; break;
+        case 'P': bits |= FLUIDNC_PIN_PROBE; break;
+        case 'D': bits |= FLUIDNC_PIN_DOOR; break;
+        case 'H': bits |= FLUIDNC_PIN_HOLD; break;
+        case 'R': bits |= FLUIDNC_PIN_RESET; break;
+        case 'S': bits |= FLUIDNC_PIN_START; break;
+        default: *pp = p; return bits;
+        }
+    }
+}
+
+static unsigned bits_accesorios(const char **pp) {
+    unsigned bits = 0;
+    for (const char *p = *pp; ; p++) {
+        switch (*p) {
+        case 'S': bits |= FLUIDNC_ACC_SPINDLE_CW; break;
+        case 'C': bits |= FLUIDNC_ACC_SPINDLE_CCW; break;
+        case 'F': bits |= FLUIDNC_ACC_FLOOD; break;
+        case 'M': bits |= FLUIDNC_ACC_MIST; break;
+        default: *pp = p; return bits;
+        }
+    }
+}
+
+int fluidnc_parse_status(const char *linea, FluidncStatus *st, FluidncWcoCache *cache) {
+    if (!linea || !st || linea[0] != '<') return 0;
+    memset(st, 0, sizeof(*st));
+    st->subestado = -1;
+
+    // 1. Estado: "Nombre" o "Nombre:sub", hasta el primer '|' o '>'
+    const char *p = linea + 1;
+    const char *nombre = p;
+    while (*p && *p != '|' && *p != '>' && *p != ':') p++;
+    int largo_nombre = (int)(p - nombre);
+    if (*p == ':') {
+        p++;
+        long sub;
+        if (leer_entero(&p, &sub)) st->subestado = (int)sub;
+        while (*p && *p != '|' && *p != '>') p++;
+    }
+    size_t n = (size_t)(p - nombre);
+    if (largo_nombre == 0 || *p == '\0') return 0;
+    if (n > sizeof(st->estado) - 1) n = sizeof(st->estado) - 1;
+    memcpy(st->estado, nombre, n);
+    st->estado[n] = '\0';
+    st->codigo = codigo_estado(nombre, largo_nombre);
+
+    // 2. Campos "Nombre:valores" separados por '|'
+    float pos[FLUIDNC_MAX_EJES];
+    int ejes_pos = 0;
+    int es_wpos = 0;
+    int ejes_wco = 0;
+    while (*p == '|') {
+        const char *campo = ++p;
+        while (*p && *p != ':' && *p != '|' && *p != '>') p++;
+        int largo = (int)(p - campo);
+        if (*p == ':') p++;
+
+        float v[FLUIDNC_MAX_EJES];
+        long e[3];
+        int k;
+        switch (campo[0]) {
+        case 'M':
+        case 'W':
+            if (CAMPO("MPos") || CAMPO("WPos")) {
+                if ((k = leer_lista(&p, v, FLUIDNC_MAX_EJES)) > 0) {
+                    memcpy(pos, v, sizeof(float) * (size_t)k);
+                    ejes_pos = k;
+                    es_wpos = (campo[0] == 'W');
+                }
+            } else if (CAMPO("WCO")) {
+                if ((k = leer_lista(&p, v, FLUIDNC_MAX_EJES)) > 0) {
+                    memcpy(st->wco, v, sizeof(float) * (size_t)k);
+                    ejes_wco = k;
+                    st->campos |= FLUIDNC_CAMPO_WCO;
+                }
+            }
+            break;
+        case 'F':
+            if (CAMPO("FS")) {
+                if (leer_lista(&p, v, 2) == 2) {
+                    st->feed = v[0];
+                    st->spindle = v[1];
+                    st->campos |= FLUIDNC_CAMPO_FS;
+                }
+            } else if (CAMPO("F")) {
+                if (leer_lista(&p, v, 1) == 1) {
+                    st->feed = v[0];
+                    st->campos |= FLUIDNC_CAMPO_FS;
+                }
+            }
+            break;
+        case 'O':
+            if (CAMPO("Ov") && leer_enteros(&p, e, 3) == 3) {
+                st->ov_feed = (int)e[0];
+                st->ov_rapid = (int)e[1];
+                st->ov_spindle = (int)e[2];
+                st->campos |= FLUIDNC_CAMPO_OV;
+            }
+            break;
+        case 'P':
+            if (CAMPO("Pn")) {
+                st->pines = bits_pines(&p);
+                st->campos |= FLUIDNC_CAMPO_PN;
+            }
+            break;
+        case 'B':
+            if (CAMPO("Bf") && leer_enteros(&p, e, 2) == 2) {
+                st->bf_planner = (int)e[0];
+                st->bf_rx = (int)e[1];
+                st->campos |= FLUIDNC_CAMPO_BF;
+            }
+            break;
+        case 'L':
+            if (CAMPO("Ln") && leer_entero(&p, &e[0])) {
+                st->linea = e[0];
+                st->campos |= FLUIDNC_CAMPO_LN;
+            }
+            break;
+        case 'A':
+            if (CAMPO("A")) {
+                st->accesorios = bits_accesorios(&p);
+                st->campos |= FLUIDNC_CAMPO_A;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Lo que no se entendió (o campos que todavía no usamos) se saltea
+        while (*p && *p != '|' && *p != '>') p++;
+    }
+    if (*p != '>') return 0;
+
+    // 3. WCO: el del reporte pisa el recordado; si no vino, se usa el recordado
+    if (ejes_wco > 0 && cache) {
+        memcpy(cache->wco, st->wco, sizeof(cache->wco));
+        cache->ejes = ejes_wco;
+        cache->valido = 1;
+    } else if (ejes_wco == 0 && cache && cache->valido) {
+        memcpy(st->wco, cache->wco, sizeof(st->wco));
+        ejes_wco = cache->ejes;
+    }
+
+    // 4. Posición: la que vino y, si se conoce el WCO, la otra (WPos = MPos - WCO)
+    if (ejes_pos > 0) {
+        st->ejes = ejes_pos;
+        float *dada = es_wpos ? st->wpos : st->mpos;
+        float *otra = es_wpos ? st->mpos : st->wpos;
+        memcpy(dada, pos, sizeof(float) * (size_t)ejes_pos);
+        st->campos |= es_wpos ? FLUIDNC_CAMPO_WPOS : FLUIDNC_CAMPO_MPOS;
+
+        if (ejes_wco >= ejes_pos) {
+            for (int i = 0; i < ejes_pos; i++) {
+                otra[i] = es_wpos ? pos[i] + st->wco[i] : pos[i] - st->wco[i];
+            }
+            st->campos |= es_wpos ? FLUIDNC_CAMPO_MPOS : FLUIDNC_CAMPO_WPOS;
+        }
+    }
+    return 1;
+}
+
+int fluidnc_estado_en_movimiento(const FluidncStatus *st) {
+    if (!st) return 0;
+    switch (st->codigo) {
+    case FLUIDNC_RUN:
+    case FLUIDNC_JOG:
+    case FLUIDNC_HOME:
+        return 1;
+    case FLUIDNC_HOLD:
+        return st->subestado == 1;      // Hold:1 = todavía frenando; Hold:0 ya está quieta
+    case FLUIDNC_DOOR:
+        return st->subestado >= 2;      // Door:2/3 = estacionando o volviendo
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef FLUIDNC_STATUS_H
+#define FLUIDNC_STATUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- REPORTE DE ESTADO DE GRBL / FLUIDNC ---
+// Respuesta al comando de tiempo real '?':
+//   <Run|MPos:10.000,20.000,30.000|Bf:15,128|FS:500,8000|Ov:100,100,100|WCO:0.000,0.000,-5.000>
+// El parser recorre la línea una sola vez, sin strstr/sscanf ni memoria
+// dinámica: se llama en el hilo de E/S varias veces por segundo por máquina.
+
+#define FLUIDNC_MAX_EJES 6      // FluidNC maneja hasta X Y Z A B C
+
+typedef enum {
+    FLUIDNC_DESCONOCIDO = 0,
+    FLUIDNC_IDLE,
+    FLUIDNC_RUN,
+    FLUIDNC_HOLD,
+    FLUIDNC_JOG,
+    FLUIDNC_ALARM,
+    FLUIDNC_DOOR,
+    FLUIDNC_CHECK,
+    FLUIDNC_HOME,
+    FLUIDNC_SLEEP
+} FluidncEstado;
+
+// Campos presentes en el reporte (FluidncStatus.campos)
+#define FLUIDNC_CAMPO_MPOS  (1u << 0)
+#define FLUIDNC_CAMPO_WPOS  (1u << 1)
+#define FLUIDNC_CAMPO_WCO   (1u << 2)
+#define FLUIDNC_CAMPO_FS    (1u << 3)   // FS: o F:
+#define FLUIDNC_CAMPO_OV    (1u << 4)
+#define FLUIDNC_CAMPO_PN    (1u << 5)
+#define FLUIDNC_CAMPO_BF    (1u << 6)
+#define FLUIDNC_CAMPO_LN    (1u << 7)
+#define FLUIDNC_CAMPO_A     (1u << 8)
+
+// Pines activos (Pn:XYZPDHRS...)
+#define FLUIDNC_PIN_X       (1u << 0)   // Fines de carrera
+#define FLUIDNC_PIN_Y       (1u << 1)
+#define FLUIDNC_PIN_Z       (1u << 2)
+#define FLUIDNC_PIN_A       (1u << 3)
+#define FLUIDNC_PIN_B       (1u << 4)
+#define FLUIDNC_PIN_C       (1u << 5)
+#define FLUIDNC_PIN_PROBE   (1u << 6)   // P
+#define FLUIDNC_PIN_DOOR    (1u << 7)   // D
+#define FLUIDNC_PIN_HOLD    (1u << 8)   // H
+#define FLUIDNC_PIN_RESET   (1u << 9)   // R
+#define FLUIDNC_PIN_START   (1u << 10)  // S
+
+// Accesorios (A:SFM)
+#define FLUIDNC_ACC_SPINDLE_CW  (1u << 0)   // S
+#define FLUIDNC_ACC_SPINDLE_CCW (1u << 1)   // C
+#define FLUIDNC_ACC_FLOOD       (1u << 2)   // F
+#define FLUIDNC_ACC_MIST        (1u << 3)   // M
+
+typedef struct {
+    char estado[16];        // Tal cual vino: "Idle", "Hold:0"...
+    FluidncEstado codigo;
+    int subestado;          // Número después de ':' (Hold:1, Door:2...), -1 si no hay
+    unsigned campos;        // FLUIDNC_CAMPO_*
+
+    int ejes;               // Cantidad de ejes del reporte de posición
+    float mpos[FLUIDNC_MAX_EJES];
+    float wpos[FLUIDNC_MAX_EJES];   // Válidas si campos tiene MPOS/WPOS (reconstruidas con el WCO)
+    float wco[FLUIDNC_MAX_EJES];
+
+    float feed;             // mm/min
+    float spindle;          // RPM
+    int ov_feed, ov_rapid, ov_spindle;  // Overrides en %
+    unsigned pines;         // FLUIDNC_PIN_*
+    unsigned accesorios;    // FLUIDNC_ACC_*
+    int bf_planner;         // Bloques libres en el planner
+    int bf_rx;              // Bytes libres en el buffer RX
+    long linea;             // Ln: número de línea en ejecución
+} FluidncStatus;
+
+// Grbl manda el WCO solo cada tanto (cada 10-30 reportes o cuando cambia), así
+// que hay que recordarlo por máquina para pasar de MPos a WPos y viceversa.
+typedef struct {
+    int valido;
+    int ejes;
+    float wco[FLUIDNC_MAX_EJES];
+} FluidncWcoCache;
+
+/**
+ * @brief Parsea un reporte de estado "<...>".
+ * @param linea Línea recibida (sin '\n').
+ * @param st Salida; los campos que no vienen en el reporte quedan en 0.
+ * @param cache WCO recordado de la máquina (puede ser NULL). Se actualiza si el
+ * reporte trae WCO y se usa para completar MPos/WPos.
+ * @return 1 si la línea es un reporte de estado válido, 0 si no.
+ */
+int fluidnc_parse_status(const char *linea, FluidncStatus *st, FluidncWcoCache *cache);
+
+/**
+ * @brief 1 si el estado implica movimiento (Run, Jog, Home, Hold mientras frena...).
+ */
+int fluidnc_estado_en_movimiento(const FluidncStatus *st);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLUIDNC_STATUS_H
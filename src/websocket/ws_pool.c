@@ -0,0 +1,1405 @@
+#include "ws_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/random.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include "../logger/logger.h"
+#include "fluidnc_formatter.h"
+#include "fluidnc_status.h"
+#include "../config/machine_config.h"
+#include "../timer/timer_wheel.h"
+
+extern SystemState global_state;
+extern pthread_mutex_t state_mutex;
+
+#define WS_RX_MAX     4096
+#define WS_LINEA_MAX  256
+#define WS_TX_MAX     1024
+#define WS_TX_COLA    8192      // Bytes que el socket todavía no aceptó (los manda el hilo de E/S)
+#define WS_POLL_MS    50
+#define WS_POOL_REPASO_MS 500   // Cada cuánto se revisan IPs y reconexiones
+#define WS_RT_COLA    16        // Bytes de tiempo real esperando que termine un frame
+
+typedef enum {
+    WS_DESCONECTADA = 0,
+    WS_CONECTANDO,      // connect() no bloqueante en curso
+    WS_HANDSHAKE,       // Esperando "HTTP/1.1 101"
+    WS_ABIERTA
+} WsEstado;
+
+typedef struct {
+    long ticket;
+    long t_envio_ms;
+    int bytes_stream;           // > 0: línea del streamer (bytes que ocupa en el RX del controlador)
+    int linea_archivo;          // Número de línea en el archivo que se está streameando
+    int es_jog;                 // Segmento del jog continuo
+    WsRespuesta r;
+} WsPendiente;
+
+typedef struct {
+    int id;
+    char ip[64];                // IP o nombre (machine_config.json admite hostnames)
+    int puerto;
+    int fd;
+    WsEstado estado;
+    pthread_mutex_t tx_mutex;   // Serializa las escrituras al socket
+
+    // Protegidos por tx_mutex
+    unsigned char azar[64];     // Bytes al azar para máscaras y clave (getrandom)
+    size_t azar_pos;            // Consumidos de azar (= sizeof: hay que rellenar)
+    unsigned int semilla;       // Solo si getrandom no puede dar todavía (arranque)
+    unsigned char tx[WS_TX_COLA];   // Frames que no entraron en el socket, en orden
+    size_t tx_len;
+
+    // Protegidos por pool_mutex
+    long enviados;              // Último ticket entregado
+    long respondidos;           // Último ticket con respuesta (o descartado)
+    WsPendiente pend[WS_POOL_PENDIENTES];
+    int pedida;                 // Alguien espera esta conexión: saltear backoff
+    unsigned char rt_cola[WS_RT_COLA];  // Tiempo real que llegó con tx_mutex ocupado
+    int rt_n;
+    int tx_pendiente;           // tx_len > 0: el hilo de E/S espera POLLOUT
+    int reintentar;             // Venció el backoff (t_reconexion)
+    int conexion_vencida;       // Venció el plazo de conexión (t_conexion)
+    char stream_pedido[256];    // Archivo a streamear (lo toma el hilo de E/S)
+    int stream_cancelar;
+    int stream_activo;
+    int stream_en_vuelo;        // Bytes enviados sin "ok" (conteo de caracteres de Grbl)
+    int stream_linea_ok;        // Última línea del archivo confirmada
+    long t_actividad_ms;        // Última línea enviada (sondeo rápido un rato)
+    int bf_planner;             // Último "Bf:" (bloques libres / bytes libres en RX)
+    int bf_rx;
+    long bf_ms;                 // Cuándo llegó (0 = el controlador no manda Bf)
+    long bf_respondidos;        // respondidos al llegar: un "ok" posterior lo deja viejo
+    int rx_total;               // Tamaño del RX: Bf con nada sin "ok" (0 = no se sabe)
+    int jog_activo;             // Botón apretado: hay que mantener el planner con segmentos
+    char jog_eje;
+    int jog_sentido;            // +1 / -1
+    int jog_feed;
+    int jog_en_vuelo;           // Segmentos sin "ok"
+    long jog_fin_ms;            // Cuándo termina (estimado) el movimiento ya encolado
+    float jog_recorrido;        // mm mandados desde que se apretó el botón
+    float jog_max;              // Tope de recorrido (límites de software), <= 0 = sin tope
+    float mpos[3];              // Última posición de máquina reportada
+    int mpos_valida;
+    int jog_cancelando;         // Se mandó 0x85: esperando los "ok" que falten
+    int rtt_ms;                 // Ida y vuelta medido con los "ok" de los segmentos
+    unsigned int trabajos_ok;   // Programas terminados limpios (stream completo o "job succeeded" de la SD)
+    unsigned int cortes;        // Alarmas, puerta y resets (los dos crecen desde el arranque)
+    int resolviendo;            // Hay un hilo con getaddrinfo para dns_nombre
+    int dns_listo;              // Terminó: dns_ok / dns_addr esperan al próximo intento
+    int dns_ok;
+    char dns_nombre[64];
+    struct in_addr dns_addr;
+
+    // Solo los toca el hilo de E/S
+    unsigned char rx[WS_RX_MAX];
+    size_t rx_len;
+    unsigned long long frame_restante;  // Payload pendiente del frame de datos en curso
+    int frame_enmascarado;
+    unsigned char frame_mascara[4];
+    unsigned long long frame_pos;
+    int frame_fin;
+    int mensaje_texto;          // FluidNC manda avisos en frames de texto sin '\n'
+    char linea[WS_LINEA_MAX];
+    size_t linea_len;
+    int backoff_ms;
+    FILE *stream;
+    int stream_linea_leida;     // Líneas del archivo ya leídas
+    char stream_siguiente[WS_LINEA_MAX];  // Línea leída que todavía no entra en el buffer
+    int stream_hay_siguiente;
+    long t_status_ms;           // Último '?' enviado
+    int status_esperando;       // Se mandó '?' y todavía no llegó el reporte
+    int en_movimiento;          // Según el último reporte
+    int en_corte;               // El último reporte fue Alarm o Door
+    FluidncWcoCache wco;        // Grbl no manda el WCO en todos los reportes
+
+    // Plazos en la rueda de timers (los callbacks toman pool_mutex)
+    TimerNodo t_reconexion;     // Fin del backoff
+    TimerNodo t_conexion;       // connect() + handshake
+    TimerNodo t_jog_cancel;     // "ok" que faltan después del 0x85
+} WsConexion;
+
+static WsConexion conns[MAX_MAQUINAS];
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static long enviar_linea(WsConexion *c, const char *linea, int bytes_stream, int linea_archivo, int es_jog);
+static void descartar_pendientes(WsConexion *c, const char *motivo);
+static void soltar_tx(WsConexion *c);
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// --------------------------------------------------------------------------
+// Callbacks de la rueda de timers. Solo levantan banderas (o descartan los
+// pendientes del jog); cerrar y reconectar sigue siendo cosa del hilo de E/S.
+// Un callback puede llegar tarde, cuando el timer ya se volvió a armar: por
+// eso se confirma con timer_pendiente() bajo pool_mutex.
+// --------------------------------------------------------------------------
+static void vencio_backoff(void *ctx) {
+    WsConexion *c = ctx;
+    pthread_mutex_lock(&pool_mutex);
+    if (!timer_pendiente(&c->t_reconexion) && c->estado == WS_DESCONECTADA) c->reintentar = 1;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+static void vencio_conexion(void *ctx) {
+    WsConexion *c = ctx;
+    pthread_mutex_lock(&pool_mutex);
+    if (!timer_pendiente(&c->t_conexion) && (c->estado == WS_CONECTANDO || c->estado == WS_HANDSHAKE)) {
+        c->conexion_vencida = 1;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+static void vencio_jog_cancel(void *ctx) {
+    WsConexion *c = ctx;
+    pthread_mutex_lock(&pool_mutex);
+    if (!timer_pendiente(&c->t_jog_cancel) && c->jog_cancelando) {
+        // Los segmentos descartados por el 0x85 no van a tener "ok": sin
+        // esto todas las respuestas siguientes quedarían corridas
+        c->jog_cancelando = 0;
+        descartar_pendientes(c, "jog cancelado");
+    }
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+static void pool_init(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&pool_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    for (int i = 0; i < MAX_MAQUINAS; i++) {
+        conns[i].id = i + 1;
+        conns[i].fd = -1;
+        conns[i].rtt_ms = WS_POOL_JOG_RTT_INICIAL_MS;
+        conns[i].reintentar = 1;        // La primera conexión no espera
+        conns[i].azar_pos = sizeof(conns[i].azar);
+        pthread_mutex_init(&conns[i].tx_mutex, NULL);
+        timer_init(&conns[i].t_reconexion, vencio_backoff, &conns[i]);
+        timer_init(&conns[i].t_conexion, vencio_conexion, &conns[i]);
+        timer_init(&conns[i].t_jog_cancel, vencio_jog_cancel, &conns[i]);
+    }
+}
+
+static WsConexion *conexion(int maquina_id) {
+    pthread_once(&pool_once, pool_init);
+    if (maquina_id < 1 || maquina_id > MAX_MAQUINAS) return NULL;
+    return &conns[maquina_id - 1];
+}
+
+static void deadline_ts(struct timespec *ts, long deadline_ms) {
+    ts->tv_sec = deadline_ms / 1000;
+    ts->tv_nsec = (deadline_ms % 1000) * 1000000L;
+}
+
+int ws_pool_ip(int maquina_id, char *ip, size_t cap) {
+    if (maquina_id < 1 || maquina_id > MAX_MAQUINAS || cap == 0) return 0;
+    ip[0] = '\0';
+
+    pthread_mutex_lock(&state_mutex);
+    snprintf(ip, cap, "%s", global_state.maquinas[maquina_id - 1].ip);
+    pthread_mutex_unlock(&state_mutex);
+
+    if (ip[0] == '\0') {
+        const MachinesConfigList *conf = config_acquire();
+        const char *fija = config_get_machine_ip(conf, maquina_id);
+        if (fija) snprintf(ip, cap, "%s", fija);
+        config_release(conf);
+    }
+    return ip[0] != '\0';
+}
+
+// Puerto del WebSocket según machine_config.json (81 si la máquina no está)
+static int puerto_ws(int maquina_id) {
+    const MachinesConfigList *conf = config_acquire();
+    const MachineConfig *m = config_find(conf, maquina_id);
+    int puerto = (m && m->ws_port > 0) ? m->ws_port : WS_POOL_PUERTO;
+    config_release(conf);
+    return puerto;
+}
+
+// --------------------------------------------------------------------------
+// Escritura (cualquier hilo, con tx_mutex tomado)
+// --------------------------------------------------------------------------
+// Nunca se espera al socket: quien escribe puede ser el hilo de la UI.
+// send() sin bloquear; devuelve lo que entró, o -1 si el socket falló.
+static ssize_t enviar_sin_esperar(int fd, const unsigned char *buf, size_t len) {
+    size_t hecho = 0;
+    while (hecho < len) {
+        ssize_t n = send(fd, buf + hecho, len - hecho, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            hecho += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return -1;
+        }
+    }
+    return (ssize_t)hecho;
+}
+
+// Manda lo que quedó en la cola de la conexión. El hilo de E/S lo llama con
+// POLLOUT; los demás, antes de escribir algo nuevo (el orden se mantiene).
+static int vaciar_tx(WsConexion *c, int fd) {
+    if (c->tx_len > 0) {
+        ssize_t n = enviar_sin_esperar(fd, c->tx, c->tx_len);
+        if (n < 0) return -1;
+        memmove(c->tx, c->tx + n, c->tx_len - (size_t)n);
+        c->tx_len -= (size_t)n;
+    }
+    pthread_mutex_lock(&pool_mutex);
+    c->tx_pendiente = (c->tx_len > 0);
+    pthread_mutex_unlock(&pool_mutex);
+    return 0;
+}
+
+// Lo que el socket no acepta ahora queda en c->tx. Devuelve -1 si el socket
+// falló o si la cola se llenó (el otro lado dejó de leer).
+static int escribir_todo(WsConexion *c, int fd, const unsigned char *buf, size_t len) {
+    if (vaciar_tx(c, fd) != 0) return -1;
+    if (c->tx_len == 0) {
+        ssize_t n = enviar_sin_esperar(fd, buf, len);
+        if (n < 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    if (len == 0) return 0;
+    if (c->tx_len + len > sizeof(c->tx)) return -1;
+    memcpy(c->tx + c->tx_len, buf, len);
+    c->tx_len += len;
+    pthread_mutex_lock(&pool_mutex);
+    c->tx_pendiente = 1;
+    pthread_mutex_unlock(&pool_mutex);
+    return 0;
+}
+
+// Bytes al azar de la conexión, con tx_mutex tomado. Se piden al kernel de a
+// un bloque; al arrancar, si todavía no tiene entropía, no se espera: se usa
+// una semilla propia de la conexión.
+static void azar(WsConexion *c, unsigned char *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (c->azar_pos >= sizeof(c->azar)) {
+            ssize_t r = getrandom(c->azar, sizeof(c->azar), GRND_NONBLOCK);
+            if (r != (ssize_t)sizeof(c->azar)) {
+                if (c->semilla == 0) c->semilla = (unsigned int)ahora_ms() ^ (unsigned int)getpid() ^ (unsigned int)(c->id * 2654435761u);
+                for (size_t k = 0; k < sizeof(c->azar); k++) c->azar[k] = (unsigned char)(rand_r(&c->semilla) >> 7);
+            }
+            c->azar_pos = 0;
+        }
+        out[i] = c->azar[c->azar_pos++];
+    }
+}
+
+// Frame cliente -> servidor (siempre enmascarado, RFC 6455). Con tx_mutex tomado.
+static int escribir_frame(WsConexion *c, int fd, int opcode, const void *data, size_t len) {
+    if (len > WS_TX_MAX) return -1;
+
+    unsigned char frame[WS_TX_MAX + 14];
+    size_t h = 0;
+    frame[h++] = 0x80 | (opcode & 0x0F);
+    if (len < 126) {
+        frame[h++] = 0x80 | (unsigned char)len;
+    } else {
+        frame[h++] = 0x80 | 126;
+        frame[h++] = (unsigned char)(len >> 8);
+        frame[h++] = (unsigned char)len;
+    }
+
+    unsigned char mascara[4];
+    azar(c, mascara, sizeof(mascara));
+    memcpy(frame + h, mascara, 4);
+    h += 4;
+
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) frame[h + i] = p[i] ^ mascara[i & 3];
+    return escribir_todo(c, fd, frame, h + len);
+}
+
+// Con tx_mutex tomado: los bytes de tiempo real que se encolaron mientras
+// este hilo escribía salen ahora, entre frames (nunca en medio de uno) y
+// antes que cualquier línea que esté esperando tx_mutex.
+static void drenar_tiempo_real(WsConexion *c) {
+    while (1) {
+        pthread_mutex_lock(&pool_mutex);
+        if (c->rt_n == 0 || c->estado != WS_ABIERTA) {
+            c->rt_n = 0;
+            pthread_mutex_unlock(&pool_mutex);
+            return;
+        }
+        unsigned char byte = c->rt_cola[0];
+        memmove(c->rt_cola, c->rt_cola + 1, (size_t)--c->rt_n);
+        int fd = c->fd;
+        pthread_mutex_unlock(&pool_mutex);
+
+        // Frame binario: 0x85/0x18 no son UTF-8 válido para un frame de texto
+        if (escribir_frame(c, fd, 0x2, &byte, 1) != 0) {
+            shutdown(fd, SHUT_RDWR);
+            return;
+        }
+        if (byte == FLUIDNC_RT_RESET) {
+            // El reset vacía el buffer del controlador: esas líneas no van a tener "ok"
+            pthread_mutex_lock(&pool_mutex);
+            descartar_pendientes(c, "reset");
+            c->stream_cancelar = 1;
+            pthread_mutex_unlock(&pool_mutex);
+        }
+    }
+}
+
+// Suelta tx_mutex sin dejar tiempo real en la cola: si alguien encoló justo
+// después del drenaje y no pudo tomar tx_mutex, lo manda este mismo hilo
+static void soltar_tx(WsConexion *c) {
+    while (1) {
+        drenar_tiempo_real(c);
+        pthread_mutex_unlock(&c->tx_mutex);
+        pthread_mutex_lock(&pool_mutex);
+        int quedan = c->rt_n > 0;
+        pthread_mutex_unlock(&pool_mutex);
+        if (!quedan || pthread_mutex_trylock(&c->tx_mutex) != 0) return;
+    }
+}
+
+// --------------------------------------------------------------------------
+// Conexión (solo hilo de E/S)
+// --------------------------------------------------------------------------
+// Con pool_mutex tomado: lo que quedó esperando respuesta ya no la va a tener
+static void descartar_pendientes(WsConexion *c, const char *motivo) {
+    for (long t = c->respondidos + 1; t <= c->enviados; t++) {
+        WsPendiente *p = &c->pend[t % WS_POOL_PENDIENTES];
+        p->ticket = t;
+        p->bytes_stream = 0;
+        p->r.maquina_id = c->id;
+        p->r.resultado = WS_RES_SIN_CONEXION;
+        snprintf(p->r.detalle, sizeof(p->r.detalle), "%s", motivo);
+    }
+    c->respondidos = c->enviados;
+    c->stream_en_vuelo = 0;
+    c->jog_en_vuelo = 0;
+    pthread_cond_broadcast(&pool_cond);
+}
+
+static void cerrar(WsConexion *c, const char *motivo) {
+    pthread_mutex_lock(&c->tx_mutex);
+    pthread_mutex_lock(&pool_mutex);
+
+    if (c->fd >= 0) close(c->fd);
+    if (c->estado == WS_ABIERTA && motivo) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "M%d: conexion cerrada (%s)", c->id, motivo);
+        logger_log_maquina("WS", c->id, msg);
+    }
+    c->fd = -1;
+    c->estado = WS_DESCONECTADA;
+    c->rt_n = 0;
+    c->tx_len = 0;
+    c->tx_pendiente = 0;
+    c->rx_len = 0;
+    c->linea_len = 0;
+    c->frame_restante = 0;
+    c->t_status_ms = 0;         // Al reconectar se pide estado enseguida
+    c->status_esperando = 0;
+    c->en_movimiento = 0;
+    c->wco.valido = 0;          // Puede cambiar mientras no la vemos
+    c->bf_ms = 0;
+    c->rx_total = 0;
+
+    descartar_pendientes(c, "desconectada");
+    c->stream_cancelar = 1;
+    c->jog_activo = 0;
+    c->jog_cancelando = 0;
+    timer_cancelar(&c->t_jog_cancel);
+    c->mpos_valida = 0;
+
+    timer_cancelar(&c->t_conexion);
+    c->conexion_vencida = 0;
+    c->backoff_ms = (c->backoff_ms == 0) ? WS_POOL_BACKOFF_MIN_MS : c->backoff_ms * 2;
+    if (c->backoff_ms > WS_POOL_BACKOFF_MAX_MS) c->backoff_ms = WS_POOL_BACKOFF_MAX_MS;
+    timer_armar(&c->t_reconexion, c->backoff_ms);
+
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_mutex);
+    pthread_mutex_unlock(&c->tx_mutex);
+}
+
+static void base64(const unsigned char *in, size_t len, char *out) {
+    static const char t[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        unsigned int v = in[i] << 16;
+        if (i + 1 < len) v |= in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[o++] = t[(v >> 18) & 63];
+        out[o++] = t[(v >> 12) & 63];
+        out[o++] = (i + 1 < len) ? t[(v >> 6) & 63] : '=';
+        out[o++] = (i + 2 < len) ? t[v & 63] : '=';
+    }
+    out[o] = '\0';
+}
+
+static int enviar_handshake(WsConexion *c) {
+    unsigned char clave[16];
+    pthread_mutex_lock(&c->tx_mutex);
+    azar(c, clave, sizeof(clave));
+    char clave64[32];
+    base64(clave, sizeof(clave), clave64);
+
+    // No se verifica Sec-WebSocket-Accept: alcanza con el 101 en la red del taller
+    char req[256];
+    int n = snprintf(req, sizeof(req),
+                     "GET / HTTP/1.1\r\n"
+                     "Host: %s:%d\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Key: %s\r\n"
+                     "Sec-WebSocket-Version: 13\r\n\r\n",
+                     c->ip, c->puerto, clave64);
+    int r = escribir_todo(c, c->fd, (const unsigned char *)req, (size_t)n);
+    pthread_mutex_unlock(&c->tx_mutex);
+    return r;
+}
+
+// Hilo de un solo uso: getaddrinfo puede tardar segundos (mDNS, DNS caído) y
+// el hilo de E/S atiende a todas las máquinas. Deja el resultado en la
+// conexión y pide otro intento.
+static void *resolver_nombre(void *arg) {
+    WsConexion *c = arg;
+    char nombre[sizeof(c->dns_nombre)];
+    pthread_mutex_lock(&pool_mutex);
+    snprintf(nombre, sizeof(nombre), "%s", c->dns_nombre);
+    pthread_mutex_unlock(&pool_mutex);
+
+    struct addrinfo pista, *res = NULL;
+    memset(&pista, 0, sizeof(pista));
+    pista.ai_family = AF_INET;
+    pista.ai_socktype = SOCK_STREAM;
+    int ok = getaddrinfo(nombre, NULL, &pista, &res) == 0 && res;
+
+    pthread_mutex_lock(&pool_mutex);
+    c->dns_ok = ok;
+    if (ok) c->dns_addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+    c->dns_listo = 1;
+    c->resolviendo = 0;
+    c->reintentar = 1;
+    pthread_mutex_unlock(&pool_mutex);
+    if (res) freeaddrinfo(res);
+    return NULL;
+}
+
+// Nombre ("cnc1.local") a dirección sin bloquear: la primera vez lanza
+// resolver_nombre y devuelve 0; cuando terminó, el próximo intento usa el
+// resultado (una vez: cada reconexión vuelve a resolver, por si cambió).
+// -1 si no se pudo resolver.
+static int direccion_de_nombre(WsConexion *c, const char *nombre, struct in_addr *out) {
+    int r = 0;
+    pthread_mutex_lock(&pool_mutex);
+    if (c->resolviendo) {
+        pthread_mutex_unlock(&pool_mutex);
+        return 0;
+    }
+    if (c->dns_listo && strcmp(c->dns_nombre, nombre) == 0) {
+        c->dns_listo = 0;
+        if (c->dns_ok) {
+            *out = c->dns_addr;
+            r = 1;
+        } else {
+            r = -1;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+        return r;
+    }
+    c->dns_listo = 0;
+    c->resolviendo = 1;
+    snprintf(c->dns_nombre, sizeof(c->dns_nombre), "%s", nombre);
+    pthread_mutex_unlock(&pool_mutex);
+
+    pthread_t hilo;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&hilo, &attr, resolver_nombre, c) != 0) {
+        pthread_mutex_lock(&pool_mutex);
+        c->resolviendo = 0;
+        pthread_mutex_unlock(&pool_mutex);
+        r = -1;
+    }
+    pthread_attr_destroy(&attr);
+    return r;
+}
+
+static void iniciar_conexion(WsConexion *c, const char *ip, int puerto) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)puerto);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        int r = direccion_de_nombre(c, ip, &addr.sin_addr);
+        if (r == 0) return;             // Resolviendo: reintentar vuelve a 1 al terminar
+        if (r < 0) {
+            timer_armar(&c->t_reconexion, WS_POOL_BACKOFF_MAX_MS);
+            return;
+        }
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        timer_armar(&c->t_reconexion, WS_POOL_BACKOFF_MIN_MS);
+        return;
+    }
+    int uno = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno)); // Comandos cortos: sin Nagle
+
+    int r = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (r < 0 && errno != EINPROGRESS) {
+        close(fd);
+        c->backoff_ms = c->backoff_ms ? c->backoff_ms : WS_POOL_BACKOFF_MIN_MS;
+        timer_armar(&c->t_reconexion, c->backoff_ms);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    snprintf(c->ip, sizeof(c->ip), "%s", ip);
+    c->puerto = puerto;
+    c->fd = fd;
+    c->estado = WS_CONECTANDO;
+    c->conexion_vencida = 0;
+    timer_armar(&c->t_conexion, WS_POOL_CONNECT_MS);
+    c->rx_len = 0;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (r == 0) {
+        if (enviar_handshake(c) == 0) {
+            pthread_mutex_lock(&pool_mutex);
+            c->estado = WS_HANDSHAKE;
+            pthread_mutex_unlock(&pool_mutex);
+        } else {
+            cerrar(c, NULL);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+// Lectura (solo hilo de E/S)
+// --------------------------------------------------------------------------
+static int empieza_con(const char *s, const char *prefijo) {
+    return strncmp(s, prefijo, strlen(prefijo)) == 0;
+}
+
+static void procesar_status(WsConexion *c, const char *linea) {
+    FluidncStatus st;
+    if (!fluidnc_parse_status(linea, &st, &c->wco)) return;
+    c->status_esperando = 0;
+    c->en_movimiento = fluidnc_estado_en_movimiento(&st);
+    int corte = (st.codigo == FLUIDNC_ALARM || st.codigo == FLUIDNC_DOOR);
+
+    pthread_mutex_lock(&pool_mutex);
+    if (corte && !c->en_corte) c->cortes++;
+    if (st.campos & FLUIDNC_CAMPO_BF) {
+        c->bf_planner = st.bf_planner;
+        c->bf_rx = st.bf_rx;
+        c->bf_ms = ahora_ms();
+        c->bf_respondidos = c->respondidos;
+        if (c->enviados == c->respondidos) c->rx_total = st.bf_rx;
+    }
+    if (st.campos & FLUIDNC_CAMPO_MPOS) {
+        memcpy(c->mpos, st.mpos, sizeof(c->mpos));
+        c->mpos_valida = 1;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    c->en_corte = corte;
+
+    // En pantalla va la posición de trabajo; si todavía no llegó el WCO, la de máquina
+    const float *pos = NULL;
+    if (st.campos & FLUIDNC_CAMPO_WPOS) pos = st.wpos;
+    else if (st.campos & FLUIDNC_CAMPO_MPOS) pos = st.mpos;
+    maquina_reportar(c->id, st.estado, pos, (st.campos & FLUIDNC_CAMPO_LN) ? st.linea : -1,
+                     (st.campos & FLUIDNC_CAMPO_FS) ? st.feed : -1);
+}
+
+static void procesar_linea(WsConexion *c, const char *linea) {
+    if (linea[0] == '\0') return;
+    if (linea[0] == '<') {
+        procesar_status(c, linea);
+        return;
+    }
+    // Mensajes propios de FluidNC por WebSocket, no son respuestas
+    if (empieza_con(linea, "PING:") || empieza_con(linea, "CURRENT_ID:") ||
+        empieza_con(linea, "ACTIVE_ID:")) {
+        return;
+    }
+
+    int es_ok = strcmp(linea, "ok") == 0;
+    int es_error = empieza_con(linea, "error");
+    if (es_ok || es_error) {
+        pthread_mutex_lock(&pool_mutex);
+        if (c->respondidos < c->enviados) {
+            long t = ++c->respondidos;
+            WsPendiente *p = &c->pend[t % WS_POOL_PENDIENTES];
+            p->ticket = t;
+            p->r.maquina_id = c->id;
+            p->r.resultado = es_ok ? WS_RES_OK : WS_RES_ERROR;
+            p->r.ms = (int)(ahora_ms() - p->t_envio_ms);
+            snprintf(p->r.detalle, sizeof(p->r.detalle), "%s", linea);
+            if (p->bytes_stream > 0) {
+                c->stream_en_vuelo -= p->bytes_stream;
+                c->stream_linea_ok = p->linea_archivo;
+                // Un error a mitad de programa no se arregla mandando el resto
+                if (es_error) c->stream_cancelar = 1;
+            }
+            if (p->es_jog) {
+                c->jog_en_vuelo--;
+                c->rtt_ms = (c->rtt_ms * 7 + p->r.ms) / 8;
+                // error:15 (fuera de recorrido) o similar: no tiene sentido seguir
+                if (es_error) c->jog_activo = 0;
+            }
+            pthread_cond_broadcast(&pool_cond);
+        }
+        pthread_mutex_unlock(&pool_mutex);
+    }
+
+    // Lo que dice cómo terminó un programa: FluidNC avisa el fin del archivo
+    // de la SD; una alarma o un reset (vuelve a mandar el saludo "Grbl ...")
+    // lo cortan aunque después quede en Idle
+    int alarma = empieza_con(linea, "ALARM");
+    int reset = empieza_con(linea, "Grbl ");
+    int exito = strstr(linea, "job succeeded") != NULL;
+    if (alarma || reset || exito) {
+        pthread_mutex_lock(&pool_mutex);
+        if (exito) c->trabajos_ok++;
+        else c->cortes++;
+        pthread_mutex_unlock(&pool_mutex);
+    }
+
+    if (es_error || alarma || reset) {
+        char msg[WS_LINEA_MAX + 16];
+        snprintf(msg, sizeof(msg), "M%d: %s", c->id, linea);
+        logger_log_maquina("WS", c->id, msg);
+    }
+}
+
+static void cerrar_linea(WsConexion *c) {
+    if (c->linea_len > 0 && c->linea[c->linea_len - 1] == '\r') c->linea_len--;
+    c->linea[c->linea_len] = '\0';
+    procesar_linea(c, c->linea);
+    c->linea_len = 0;
+}
+
+static void payload_datos(WsConexion *c, const unsigned char *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned char b = p[i];
+        if (c->frame_enmascarado) b ^= c->frame_mascara[c->frame_pos & 3];
+        c->frame_pos++;
+
+        if (b == '\n') {
+            cerrar_linea(c);
+        } else if (c->linea_len < WS_LINEA_MAX - 1) {
+            c->linea[c->linea_len++] = (char)b;
+        }
+    }
+}
+
+// Consume frames completos (o el pedazo disponible de uno de datos).
+// Devuelve -1 si hay que cerrar la conexión.
+static int procesar_frames(WsConexion *c) {
+    size_t pos = 0;
+    while (pos < c->rx_len) {
+        if (c->frame_restante > 0) {
+            size_t n = c->rx_len - pos;
+            if (n > c->frame_restante) n = (size_t)c->frame_restante;
+            payload_datos(c, c->rx + pos, n);
+            pos += n;
+            c->frame_restante -= n;
+            if (c->frame_restante == 0 && c->frame_fin && c->mensaje_texto && c->linea_len > 0) {
+                cerrar_linea(c);
+            }
+            continue;
+        }
+
+        const unsigned char *f = c->rx + pos;
+        size_t disp = c->rx_len - pos;
+        if (disp < 2) break;
+
+        int op = f[0] & 0x0F;
+        int enmascarado = (f[1] & 0x80) != 0;
+        unsigned long long len = f[1] & 0x7F;
+        size_t h = 2;
+        if (len == 126) {
+            if (disp < 4) break;
+            len = ((unsigned)f[2] << 8) | f[3];
+            h = 4;
+        } else if (len == 127) {
+            if (disp < 10) break;
+            len = 0;
+            for (int i = 2; i < 10; i++) len = (len << 8) | f[i];
+            h = 10;
+        }
+        if (enmascarado) {
+            if (disp < h + 4) break;
+            memcpy(c->frame_mascara, f + h, 4);
+            h += 4;
+        }
+
+        if (op == 0x0 || op == 0x1 || op == 0x2) {
+            // Datos: el payload se procesa a medida que llega
+            // Un mensaje de texto completo es una línea aunque no traiga '\n'
+            if (op != 0x0) c->mensaje_texto = (op == 0x1);
+            c->frame_fin = (f[0] & 0x80) != 0;
+            c->frame_enmascarado = enmascarado;
+            c->frame_pos = 0;
+            c->frame_restante = len;
+            pos += h;
+            if (len == 0 && c->frame_fin && c->mensaje_texto && c->linea_len > 0) cerrar_linea(c);
+            continue;
+        }
+
+        // Control: siempre <= 125 bytes y en un solo frame
+        if (len > 125) return -1;
+        if (disp < h + len) break;
+        unsigned char datos[125];
+        for (size_t i = 0; i < len; i++) {
+            datos[i] = f[h + i] ^ (enmascarado ? c->frame_mascara[i & 3] : 0);
+        }
+        pos += h + (size_t)len;
+
+        if (op == 0x8) return -1;
+        if (op == 0x9) {
+            pthread_mutex_lock(&c->tx_mutex);
+            escribir_frame(c, c->fd, 0xA, datos, (size_t)len);
+            soltar_tx(c);
+        }
+    }
+
+    memmove(c->rx, c->rx + pos, c->rx_len - pos);
+    c->rx_len -= pos;
+    return 0;
+}
+
+static int leer_handshake(WsConexion *c) {
+    c->rx[c->rx_len < WS_RX_MAX ? c->rx_len : WS_RX_MAX - 1] = '\0';
+    char *fin = strstr((char *)c->rx, "\r\n\r\n");
+    if (!fin) return (c->rx_len >= WS_RX_MAX - 1) ? -1 : 0;
+    if (strncmp((char *)c->rx, "HTTP/1.1 101", 12) != 0) return -1;
+
+    size_t usados = (size_t)(fin + 4 - (char *)c->rx);
+    memmove(c->rx, c->rx + usados, c->rx_len - usados);
+    c->rx_len -= usados;
+
+    pthread_mutex_lock(&pool_mutex);
+    c->estado = WS_ABIERTA;
+    timer_cancelar(&c->t_conexion);
+    c->conexion_vencida = 0;
+    c->backoff_ms = 0;
+    c->pedida = 0;
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_mutex);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "M%d: conectada (%s:%d)", c->id, c->ip, c->puerto);
+    logger_log_maquina("WS", c->id, msg);
+    return 1;
+}
+
+static void atender(WsConexion *c, short revents) {
+    if (c->estado == WS_CONECTANDO) {
+        int err = 0;
+        socklen_t l = sizeof(err);
+        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &l);
+        if (err != 0 || (revents & (POLLERR | POLLHUP))) {
+            cerrar(c, NULL);
+        } else if (enviar_handshake(c) == 0) {
+            pthread_mutex_lock(&pool_mutex);
+            c->estado = WS_HANDSHAKE;
+            pthread_mutex_unlock(&pool_mutex);
+        } else {
+            cerrar(c, NULL);
+        }
+        return;
+    }
+
+    // El socket tiene lugar: sale lo que quedó en la cola
+    if (revents & POLLOUT) {
+        pthread_mutex_lock(&c->tx_mutex);
+        int r = vaciar_tx(c, c->fd);
+        soltar_tx(c);
+        if (r != 0) {
+            cerrar(c, "error de escritura");
+            return;
+        }
+    }
+
+    // Reservar 1 byte para el '\0' del handshake
+    ssize_t n = recv(c->fd, c->rx + c->rx_len, WS_RX_MAX - 1 - c->rx_len, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        cerrar(c, "el otro lado corto");
+        return;
+    }
+    if (n < 0) return;
+    c->rx_len += (size_t)n;
+
+    if (c->estado == WS_HANDSHAKE) {
+        int r = leer_handshake(c);
+        if (r < 0) { cerrar(c, NULL); return; }
+        if (r == 0) return;
+    }
+    if (procesar_frames(c) < 0) cerrar(c, "frame de cierre");
+}
+
+// --------------------------------------------------------------------------
+// Streamer (solo hilo de E/S)
+// --------------------------------------------------------------------------
+static void terminar_stream(WsConexion *c, const char *motivo, int completo) {
+    if (c->stream) fclose(c->stream);
+    c->stream = NULL;
+    c->stream_hay_siguiente = 0;
+
+    pthread_mutex_lock(&pool_mutex);
+    if (completo) c->trabajos_ok++;
+    c->stream_activo = 0;
+    c->stream_cancelar = 0;
+    int linea = c->stream_linea_ok;
+    pthread_mutex_unlock(&pool_mutex);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "M%d: stream %s (linea %d)", c->id, motivo, linea);
+    logger_log_maquina("WS", c->id, msg);
+}
+
+// Lee la siguiente línea útil: sin comentarios ni espacios al final.
+// Cuenta líneas físicas (como gcode_crear_reanudacion); devuelve -1 si un
+// comando no entra en WS_LINEA_MAX, antes que mandarlo en pedazos.
+static int leer_linea_stream(WsConexion *c) {
+    char buf[WS_LINEA_MAX];
+    while (fgets(buf, sizeof(buf), c->stream)) {
+        c->stream_linea_leida++;
+        size_t largo = strlen(buf);
+        if (largo > 0 && buf[largo - 1] != '\n' && !feof(c->stream)) {
+            int ch;
+            while ((ch = fgetc(c->stream)) != EOF && ch != '\n') {}
+            if (!strchr(buf, ';')) return -1;   // Lo que sobra no era solo comentario
+        }
+        char *fin = strpbrk(buf, ";\r\n");
+        if (fin) *fin = '\0';
+        size_t n = strlen(buf);
+        while (n > 0 && (buf[n - 1] == ' ' || buf[n - 1] == '\t')) buf[--n] = '\0';
+        char *p = buf;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '%') continue;
+
+        snprintf(c->stream_siguiente, sizeof(c->stream_siguiente), "%s", p);
+        c->stream_hay_siguiente = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Con pool_mutex tomado. Lo que dice "Bf:" además del conteo de caracteres:
+// el RX del controlador puede ser más chico que WS_POOL_RX_GRBL (se mide con
+// un reporte sin nada en vuelo), y con el planner sin bloques libres la línea
+// solo ocuparía el RX. Lo del planner vale hasta el próximo "ok", que es
+// información más nueva, o hasta que el reporte envejece; mientras se
+// streamea el sondeo rápido trae otro enseguida.
+static int controlador_lleno(WsConexion *c, int en_vuelo, int bytes) {
+    if (c->rx_total > 0 && en_vuelo > 0 && en_vuelo + bytes > c->rx_total) return 1;
+    if (c->bf_ms == 0 || c->respondidos != c->bf_respondidos) return 0;
+    if (ahora_ms() - c->bf_ms > WS_POOL_STATUS_LENTO_MS) return 0;
+    return c->bf_planner <= 0;
+}
+
+// Conteo de caracteres: se manda mientras lo pendiente entre en el RX del controlador
+static void atender_stream(WsConexion *c) {
+    pthread_mutex_lock(&pool_mutex);
+    int cancelar = c->stream_cancelar;
+    char pedido[sizeof(c->stream_pedido)];
+    snprintf(pedido, sizeof(pedido), "%s", c->stream_pedido);
+    c->stream_pedido[0] = '\0';
+    if (pedido[0] && !cancelar) {
+        c->stream_activo = 1;
+        c->stream_linea_ok = 0;
+        c->stream_en_vuelo = 0;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (pedido[0] && !cancelar) {
+        if (c->stream) fclose(c->stream);
+        c->stream = fopen(pedido, "r");
+        c->stream_linea_leida = 0;
+        c->stream_hay_siguiente = 0;
+        if (!c->stream) {
+            terminar_stream(c, "sin archivo", 0);
+            return;
+        }
+    }
+    if (!c->stream) return;
+    if (cancelar) {
+        terminar_stream(c, "cancelado", 0);
+        return;
+    }
+
+    int leida = 0;
+    while (c->stream_hay_siguiente || (leida = leer_linea_stream(c)) > 0) {
+        int bytes = (int)strlen(c->stream_siguiente) + 1;
+        pthread_mutex_lock(&pool_mutex);
+        int en_vuelo = c->stream_en_vuelo;
+        long sin_ok = c->enviados - c->respondidos;
+        int lleno = controlador_lleno(c, en_vuelo, bytes);
+        pthread_mutex_unlock(&pool_mutex);
+
+        if (en_vuelo + bytes > WS_POOL_RX_GRBL || sin_ok >= WS_POOL_PENDIENTES / 2 || lleno) return;
+        if (enviar_linea(c, c->stream_siguiente, bytes, c->stream_linea_leida, 0) < 0) return;
+        c->stream_hay_siguiente = 0;
+    }
+    if (leida < 0) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "M%d: linea %d demasiado larga", c->id, c->stream_linea_leida);
+        logger_log_maquina("WS", c->id, msg);
+        terminar_stream(c, "cortado", 0);
+        return;
+    }
+
+    // Fin de archivo: se termina cuando llegó el último "ok"
+    pthread_mutex_lock(&pool_mutex);
+    int vacio = (c->stream_en_vuelo <= 0);
+    pthread_mutex_unlock(&pool_mutex);
+    if (vacio) terminar_stream(c, "terminado", 1);
+}
+
+// --------------------------------------------------------------------------
+// Jog continuo (cualquier hilo)
+// --------------------------------------------------------------------------
+// Mantiene segmentos cortos en el planner. Cada uno dura lo justo para que,
+// entre todos, cubran la ida y vuelta de la red: el planner nunca se vacía
+// mientras el botón está apretado y al soltar queda poco movimiento encolado.
+// Grbl contesta "ok" apenas el segmento entra al planner, así que además de
+// los segmentos sin "ok" se limita el tiempo de movimiento encolado.
+static void llenar_jog(WsConexion *c) {
+    while (1) {
+        long ahora = ahora_ms();
+        pthread_mutex_lock(&pool_mutex);
+        int rtt = c->rtt_ms;
+        int dt_ms = (rtt + WS_POOL_JOG_MARGEN_MS) / (WS_POOL_JOG_SEGMENTOS - 1);
+        if (dt_ms < WS_POOL_JOG_SEG_MIN_MS) dt_ms = WS_POOL_JOG_SEG_MIN_MS;
+        if (dt_ms > WS_POOL_JOG_SEG_MAX_MS) dt_ms = WS_POOL_JOG_SEG_MAX_MS;
+        // Horizonte: la vuelta del próximo "ok" más lo que tarda el hilo de E/S en despertar
+        long cola_ms = (c->jog_fin_ms > ahora) ? c->jog_fin_ms - ahora : 0;
+        int seguir = c->jog_activo && c->jog_en_vuelo < WS_POOL_JOG_SEGMENTOS &&
+                     cola_ms < rtt + WS_POOL_JOG_MARGEN_MS + WS_POLL_MS;
+        char eje = c->jog_eje;
+        int sentido = c->jog_sentido;
+        int feed = c->jog_feed;
+
+        float distancia = (float)feed / 60000.0f * (float)dt_ms;  // mm/min -> mm en dt
+        if (distancia < 0.001f) distancia = 0.001f;
+        // Cerca del límite el último segmento se acorta y después no se manda más
+        if (c->jog_max > 0 && c->jog_recorrido + distancia > c->jog_max) {
+            distancia = c->jog_max - c->jog_recorrido;
+            if (distancia < 0.001f) seguir = 0;
+        }
+        if (seguir) {
+            c->jog_fin_ms = ahora + cola_ms + dt_ms;
+            c->jog_recorrido += distancia;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+        if (!seguir) return;
+
+        char cmd[FLUIDNC_CMD_MAX];
+        fluidnc_format_jog(eje, sentido * distancia, feed, cmd);
+        if (enviar_linea(c, cmd, 0, 0, 1) < 0) return;
+    }
+}
+
+// Solo hilo de E/S: repone segmentos y cierra la cancelación (si faltan
+// "ok" pasado WS_POOL_TIMEOUT_MS, los descarta vencio_jog_cancel)
+static void atender_jog(WsConexion *c) {
+    llenar_jog(c);
+
+    pthread_mutex_lock(&pool_mutex);
+    if (c->jog_cancelando && c->jog_en_vuelo <= 0) {
+        c->jog_cancelando = 0;
+        timer_cancelar(&c->t_jog_cancel);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+// --------------------------------------------------------------------------
+// Sondeo de estado (solo hilo de E/S)
+// --------------------------------------------------------------------------
+static void sondear_estado(WsConexion *c, long ahora) {
+    pthread_mutex_lock(&pool_mutex);
+    int abierta = (c->estado == WS_ABIERTA);
+    int activa = c->stream_activo || (ahora - c->t_actividad_ms < WS_POOL_STATUS_ACTIVIDAD_MS);
+    pthread_mutex_unlock(&pool_mutex);
+    if (!abierta) return;
+
+    int intervalo = (activa || c->en_movimiento) ? WS_POOL_STATUS_RAPIDO_MS : WS_POOL_STATUS_LENTO_MS;
+    // Sin reporte del '?' anterior no se apilan más (enlace lento o controlador
+    // ocupado); pasado el intervalo lento se da por perdido y se vuelve a pedir.
+    if (c->status_esperando) intervalo = WS_POOL_STATUS_LENTO_MS;
+    if (c->t_status_ms != 0 && ahora - c->t_status_ms < intervalo) return;
+
+    if (ws_pool_tiempo_real(c->id, FLUIDNC_RT_STATUS) == 0) {
+        c->t_status_ms = ahora;
+        c->status_esperando = 1;
+    }
+}
+
+void* thread_ws_pool_loop(void* arg) {
+    pthread_once(&pool_once, pool_init);
+    printf("[WS] Pool de conexiones iniciado.\n");
+
+    long ultimo_repaso = 0;
+    while (1) {
+        long ahora = ahora_ms();
+
+        // 1. Abrir / renovar conexiones (los nombres se resuelven en otro hilo).
+        //    Cada WS_POOL_REPASO_MS, o enseguida si alguien pidió una conexión
+        //    o si la rueda de timers avisó que venció un backoff o un connect.
+        int repasar = (ahora - ultimo_repaso >= WS_POOL_REPASO_MS);
+        pthread_mutex_lock(&pool_mutex);
+        for (int i = 0; i < MAX_MAQUINAS && !repasar; i++) {
+            WsConexion *c = &conns[i];
+            if (c->estado == WS_DESCONECTADA && (c->pedida || c->reintentar)) repasar = 1;
+            if (c->conexion_vencida) repasar = 1;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+        if (repasar) ultimo_repaso = ahora;
+
+        for (int i = 0; i < MAX_MAQUINAS && repasar; i++) {
+            WsConexion *c = &conns[i];
+            char ip[64];
+            int hay_ip = ws_pool_ip(c->id, ip, sizeof(ip));
+            int puerto = puerto_ws(c->id);
+
+            pthread_mutex_lock(&pool_mutex);
+            int pedida = c->pedida;
+            int reintentar = c->reintentar;
+            int vencida = c->conexion_vencida;
+            pthread_mutex_unlock(&pool_mutex);
+
+            if (c->estado != WS_DESCONECTADA) {
+                if (!hay_ip || strcmp(ip, c->ip) != 0 || puerto != c->puerto) {
+                    cerrar(c, "cambio de IP o puerto");
+                    // A la dirección nueva se conecta sin esperar el backoff
+                    pthread_mutex_lock(&pool_mutex);
+                    timer_cancelar(&c->t_reconexion);
+                    c->backoff_ms = 0;
+                    c->reintentar = 1;
+                    pthread_mutex_unlock(&pool_mutex);
+                } else if (c->estado != WS_ABIERTA && vencida) {
+                    cerrar(c, NULL);
+                }
+                continue;
+            }
+
+            if (hay_ip && (pedida || reintentar)) {
+                pthread_mutex_lock(&pool_mutex);
+                c->reintentar = 0;
+                pthread_mutex_unlock(&pool_mutex);
+                iniciar_conexion(c, ip, puerto);
+            }
+        }
+
+        // 2. Esperar actividad en todos los sockets a la vez
+        struct pollfd fds[MAX_MAQUINAS];
+        WsConexion *due[MAX_MAQUINAS];
+        int n = 0;
+        pthread_mutex_lock(&pool_mutex);
+        for (int i = 0; i < MAX_MAQUINAS; i++) {
+            WsConexion *c = &conns[i];
+            if (c->fd < 0) continue;
+            fds[n].fd = c->fd;
+            if (c->estado == WS_CONECTANDO) fds[n].events = POLLOUT;
+            else fds[n].events = POLLIN | (c->tx_pendiente ? POLLOUT : 0);
+            fds[n].revents = 0;
+            due[n++] = c;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+
+        if (n == 0) {
+            usleep(WS_POLL_MS * 1000);
+            continue;
+        }
+        if (poll(fds, n, WS_POLL_MS) > 0) {
+            for (int k = 0; k < n; k++) {
+                if (fds[k].revents) atender(due[k], fds[k].revents);
+            }
+        }
+
+        // 3. Rellenar el buffer de las máquinas que están streameando o en jog
+        ahora = ahora_ms();
+        for (int i = 0; i < MAX_MAQUINAS; i++) {
+            atender_stream(&conns[i]);
+            atender_jog(&conns[i]);
+        }
+
+        // 4. Pedir reportes de estado
+        for (int i = 0; i < MAX_MAQUINAS; i++) {
+            sondear_estado(&conns[i], ahora);
+        }
+    }
+    return NULL;
+}
+
+// --------------------------------------------------------------------------
+// API
+// --------------------------------------------------------------------------
+// Manda una línea con ticket. bytes_stream > 0 la marca como línea del streamer.
+static long enviar_linea(WsConexion *c, const char *linea, int bytes_stream, int linea_archivo, int es_jog) {
+    char buf[WS_TX_MAX];
+    int len = snprintf(buf, sizeof(buf), "%s\n", linea);
+    if (len <= 0 || len >= (int)sizeof(buf)) return -1;
+
+    // El ticket se toma con tx_mutex tomado: el orden de tickets es el orden en el cable
+    pthread_mutex_lock(&c->tx_mutex);
+    pthread_mutex_lock(&pool_mutex);
+    // Un segmento de jog que llega tarde no puede salir después del 0x85
+    if (c->estado != WS_ABIERTA || (es_jog && !c->jog_activo)) {
+        pthread_mutex_unlock(&pool_mutex);
+        soltar_tx(c);           // El 0x85 que lo frenó puede estar en la cola
+        return -1;
+    }
+    long ticket = ++c->enviados;
+    WsPendiente *p = &c->pend[ticket % WS_POOL_PENDIENTES];
+    memset(p, 0, sizeof(*p));
+    p->ticket = ticket;
+    p->t_envio_ms = ahora_ms();
+    p->bytes_stream = bytes_stream;
+    p->linea_archivo = linea_archivo;
+    p->es_jog = es_jog;
+    c->stream_en_vuelo += bytes_stream;
+    c->jog_en_vuelo += es_jog;
+    c->t_actividad_ms = p->t_envio_ms;
+    int fd = c->fd;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (escribir_frame(c, fd, 0x1, buf, (size_t)len) != 0) {
+        // El hilo de E/S ve el socket cerrado y da por perdido el ticket
+        shutdown(fd, SHUT_RDWR);
+    }
+    soltar_tx(c);
+    return ticket;
+}
+
+long ws_pool_enviar(int maquina_id, const char *linea) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c || !linea) return -1;
+    return enviar_linea(c, linea, 0, 0, 0);
+}
+
+int ws_pool_tiempo_real(int maquina_id, unsigned char byte) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return -1;
+
+    // No toma ticket ni espera lugar en el buffer del controlador, y nunca
+    // espera tx_mutex: otro hilo puede estar escribiendo un frame. Se encola
+    // y lo escribe quien tenga tx_mutex al terminar su frame, o este hilo si
+    // está libre.
+    pthread_mutex_lock(&pool_mutex);
+    if (c->estado != WS_ABIERTA || c->rt_n >= WS_RT_COLA) {
+        pthread_mutex_unlock(&pool_mutex);
+        return -1;
+    }
+    c->rt_cola[c->rt_n++] = byte;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (pthread_mutex_trylock(&c->tx_mutex) == 0) soltar_tx(c);
+    return 0;
+}
+
+int ws_pool_tiempo_real_todas(unsigned char byte) {
+    int n = 0;
+    for (int id = 1; id <= MAX_MAQUINAS; id++) {
+        if (ws_pool_tiempo_real(id, byte) == 0) n++;
+    }
+    return n;
+}
+
+int ws_pool_jog_iniciar(int maquina_id, char eje, int sentido, int feed, float distancia_max) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c || feed <= 0 || sentido == 0) return -1;
+
+    pthread_mutex_lock(&pool_mutex);
+    if (c->estado != WS_ABIERTA || c->stream_activo) {
+        pthread_mutex_unlock(&pool_mutex);
+        return -1;
+    }
+    c->jog_eje = eje;
+    c->jog_sentido = (sentido > 0) ? 1 : -1;
+    c->jog_feed = feed;
+    c->jog_activo = 1;
+    c->jog_fin_ms = 0;
+    c->jog_recorrido = 0;
+    c->jog_max = distancia_max;
+    c->t_actividad_ms = ahora_ms();     // Sondeo de estado rápido mientras se mueve
+    pthread_mutex_unlock(&pool_mutex);
+
+    // Los primeros segmentos salen desde acá, sin esperar la vuelta del hilo de E/S
+    llenar_jog(c);
+    return 0;
+}
+
+void ws_pool_jog_parar(int maquina_id) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return;
+
+    pthread_mutex_lock(&pool_mutex);
+    int estaba = c->jog_activo || c->jog_en_vuelo > 0;
+    c->jog_activo = 0;      // A partir de acá enviar_linea rechaza segmentos
+    pthread_mutex_unlock(&pool_mutex);
+    if (!estaba) return;
+
+    // El 0x85 sale entre frames: cualquier segmento que ya estaba saliendo va
+    // antes en el cable y el controlador lo descarta junto con el resto
+    if (ws_pool_tiempo_real(maquina_id, FLUIDNC_RT_JOG_CANCEL) == 0) {
+        pthread_mutex_lock(&pool_mutex);
+        if (c->jog_en_vuelo > 0) {
+            c->jog_cancelando = 1;
+            timer_armar(&c->t_jog_cancel, WS_POOL_TIMEOUT_MS);
+        }
+        pthread_mutex_unlock(&pool_mutex);
+    }
+}
+
+int ws_pool_stream_iniciar(int maquina_id, const char *ruta) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c || !ruta || strlen(ruta) >= sizeof(c->stream_pedido)) return -1;
+
+    pthread_mutex_lock(&pool_mutex);
+    int ok = (c->estado == WS_ABIERTA && !c->stream_activo && c->stream_pedido[0] == '\0');
+    if (ok) {
+        snprintf(c->stream_pedido, sizeof(c->stream_pedido), "%s", ruta);
+        c->stream_cancelar = 0;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return ok ? 0 : -1;
+}
+
+void ws_pool_stream_cancelar(int maquina_id) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return;
+    pthread_mutex_lock(&pool_mutex);
+    c->stream_cancelar = 1;
+    c->stream_pedido[0] = '\0';
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+int ws_pool_stream_progreso(int maquina_id, int *linea, int *en_vuelo) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return 0;
+    pthread_mutex_lock(&pool_mutex);
+    int activo = c->stream_activo || c->stream_pedido[0] != '\0';
+    if (linea) *linea = c->stream_linea_ok;
+    if (en_vuelo) *en_vuelo = c->stream_en_vuelo;
+    pthread_mutex_unlock(&pool_mutex);
+    return activo;
+}
+
+void ws_pool_eventos(int maquina_id, unsigned int *terminados, unsigned int *cortes) {
+    WsConexion *c = conexion(maquina_id);
+    pthread_mutex_lock(&pool_mutex);
+    if (terminados) *terminados = c ? c->trabajos_ok : 0;
+    if (cortes) *cortes = c ? c->cortes : 0;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+// Con pool_mutex tomado: copia la respuesta del ticket si ya llegó
+static int respuesta_lista(WsConexion *c, long ticket, WsRespuesta *resp) {
+    if (c->respondidos < ticket) return 0;
+    WsPendiente *p = &c->pend[ticket % WS_POOL_PENDIENTES];
+    if (resp) {
+        if (p->ticket == ticket) {
+            *resp = p->r;
+        } else {
+            // Ya se pisó el hueco: llegó, pero no se sabe el detalle
+            memset(resp, 0, sizeof(*resp));
+            resp->resultado = WS_RES_OK;
+        }
+        resp->maquina_id = c->id;
+    }
+    return 1;
+}
+
+WsResultado ws_pool_esperar(int maquina_id, long ticket, int timeout_ms, WsRespuesta *resp) {
+    WsConexion *c = conexion(maquina_id);
+    WsRespuesta local;
+    if (!resp) resp = &local;
+    memset(resp, 0, sizeof(*resp));
+    resp->maquina_id = maquina_id;
+    if (!c || ticket <= 0) {
+        resp->resultado = WS_RES_SIN_CONEXION;
+        return resp->resultado;
+    }
+
+    long deadline = ahora_ms() + timeout_ms;
+    struct timespec ts;
+    deadline_ts(&ts, deadline);
+
+    pthread_mutex_lock(&pool_mutex);
+    while (!respuesta_lista(c, ticket, resp)) {
+        if (pthread_cond_timedwait(&pool_cond, &pool_mutex, &ts) != 0 && ahora_ms() >= deadline) {
+            resp->resultado = WS_RES_TIMEOUT;
+            snprintf(resp->detalle, sizeof(resp->detalle), "timeout");
+            resp->ms = timeout_ms;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return resp->resultado;
+}
+
+int ws_pool_mpos(int maquina_id, float *xyz) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return 0;
+    pthread_mutex_lock(&pool_mutex);
+    int hay = (c->estado == WS_ABIERTA && c->mpos_valida);
+    if (hay && xyz) memcpy(xyz, c->mpos, sizeof(c->mpos));
+    pthread_mutex_unlock(&pool_mutex);
+    return hay;
+}
+
+int ws_pool_conectada(int maquina_id) {
+    WsConexion *c = conexion(maquina_id);
+    if (!c) return 0;
+    pthread_mutex_lock(&pool_mutex);
+    int ok = (c->estado == WS_ABIERTA);
+    pthread_mutex_unlock(&pool_mutex);
+    return ok;
+}
+
+WsResultado ws_pool_comando(int maquina_id, const char *linea, int timeout_ms, WsRespuesta *resp) {
+    WsConexion *c = conexion(maquina_id);
+    if (c && !ws_pool_conectada(maquina_id)) {
+        // Pedir la conexión ya (sin backoff) y esperarla un rato
+        long deadline = ahora_ms() + WS_POOL_CONNECT_MS;
+        struct timespec ts;
+        deadline_ts(&ts, deadline);
+        pthread_mutex_lock(&pool_mutex);
+        c->pedida = 1;
+        while (c->estado != WS_ABIERTA) {
+            if (pthread_cond_timedwait(&pool_cond, &pool_mutex, &ts) != 0 && ahora_ms() >= deadline) break;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+    }
+
+    long ticket = ws_pool_enviar(maquina_id, linea);
+    return ws_pool_esperar(maquina_id, ticket, timeout_ms, resp);
+}
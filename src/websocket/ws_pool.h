@@ -0,0 +1,169 @@
+#ifndef WS_POOL_H
+#define WS_POOL_H
+
+#include <stddef.h>
+#include "../mqtt/mqtt_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- POOL DE CONEXIONES WEBSOCKET PERSISTENTES ---
+// Una conexión abierta por máquina (ws://ip:81) en lugar de un proceso
+// websocat por comando. Un solo hilo de E/S atiende todos los sockets con
+// poll(): reconecta con backoff, responde PING y reparte las líneas que
+// llegan. Ninguna escritura espera al socket (la UI también manda): lo que
+// no entra queda en una cola por conexión que vacía el hilo de E/S.
+// Cada línea enviada recibe un "ticket"; las respuestas ok/error de Grbl
+// llegan en orden, así que la respuesta N corresponde al ticket N.
+// Además sondea el estado de cada máquina con '?' y lo vuelca en
+// global_state, así se ven también las máquinas que no publican por MQTT.
+
+#define WS_POOL_PUERTO          81      // Si la máquina no tiene ws_port en machine_config.json
+#define WS_POOL_TIMEOUT_MS      2000    // Espera por defecto de ok/error
+#define WS_POOL_CONNECT_MS      1500    // Conexión + handshake
+#define WS_POOL_BACKOFF_MIN_MS  1000
+#define WS_POOL_BACKOFF_MAX_MS  30000
+#define WS_POOL_PENDIENTES      128     // Respuestas recordadas por conexión
+#define WS_POOL_RX_GRBL         128     // Buffer RX del controlador (conteo de caracteres al streamear)
+
+// Sondeo de estado ('?'): rápido mientras la máquina se mueve o acaba de
+// recibir órdenes, lento cuando está quieta. Cada '?' son 7 bytes en el aire.
+#define WS_POOL_STATUS_RAPIDO_MS    200
+#define WS_POOL_STATUS_LENTO_MS     2000
+#define WS_POOL_STATUS_ACTIVIDAD_MS 3000    // Sigue rápido este tiempo tras la última línea enviada
+
+// Jog continuo (mantener apretado): segmentos $J cortos en el planner
+#define WS_POOL_JOG_SEGMENTOS       3       // Segmentos sin "ok" a la vez
+#define WS_POOL_JOG_MARGEN_MS       30      // Margen sobre la ida y vuelta medida
+#define WS_POOL_JOG_SEG_MIN_MS      20      // Duración de cada segmento (límites)
+#define WS_POOL_JOG_SEG_MAX_MS      200
+#define WS_POOL_JOG_RTT_INICIAL_MS  50      // Hasta tener la primera medición
+
+typedef enum {
+    WS_RES_OK = 0,
+    WS_RES_ERROR,           // La máquina respondió "error:..."
+    WS_RES_TIMEOUT,         // No llegó respuesta a tiempo
+    WS_RES_SIN_CONEXION     // No había conexión o se cayó esperando
+} WsResultado;
+
+typedef struct {
+    int maquina_id;
+    WsResultado resultado;
+    char detalle[48];       // Línea de respuesta ("ok", "error:20"...)
+    int ms;                 // Tiempo hasta la respuesta
+} WsRespuesta;
+
+/**
+ * @brief Arranca el hilo de E/S del pool (llamar una vez desde main).
+ */
+void* thread_ws_pool_loop(void* arg);
+
+/**
+ * @brief Envía una línea a una máquina sin esperar respuesta.
+ * @return Ticket (> 0) para ws_pool_esperar(), o -1 si la máquina no está conectada.
+ */
+long ws_pool_enviar(int maquina_id, const char *linea);
+
+/**
+ * @brief Espera la respuesta (ok/error) correspondiente a un ticket.
+ * @param resp Si no es NULL, se completa con el detalle.
+ */
+WsResultado ws_pool_esperar(int maquina_id, long ticket, int timeout_ms, WsRespuesta *resp);
+
+/**
+ * @brief Envía y espera. Si la máquina no está conectada, pide la conexión y
+ * espera hasta WS_POOL_CONNECT_MS antes de rendirse.
+ */
+WsResultado ws_pool_comando(int maquina_id, const char *linea, int timeout_ms, WsRespuesta *resp);
+
+/**
+ * @brief Carril prioritario para los comandos de tiempo real de Grbl
+ * ('?', '!', '~', 0x18, 0x85...). Se escriben sin ticket, sin esperar
+ * lugar en el buffer del controlador y sin pasar detrás de las líneas del
+ * streamer. No bloquea: si otro hilo está escribiendo, el byte sale apenas
+ * termina ese frame. Tras un reset (0x18) se descartan las respuestas
+ * pendientes y se cancela el stream, porque el controlador vació su buffer.
+ * @return 0 si se envió o quedó en cola, -1 si no hay conexión.
+ */
+int ws_pool_tiempo_real(int maquina_id, unsigned char byte);
+
+/**
+ * @brief Manda un comando de tiempo real a todas las máquinas conectadas.
+ * @return Cantidad de máquinas a las que se envió.
+ */
+int ws_pool_tiempo_real_todas(unsigned char byte);
+
+/**
+ * @brief Empieza un jog continuo: manda segmentos $J cortos (su largo sale
+ * del feed y de la ida y vuelta medida) mientras no se llame a ws_pool_jog_parar().
+ * Un "error" del controlador (p.ej. límite de recorrido) lo corta solo.
+ * @param eje 'X', 'Y' o 'Z'.
+ * @param sentido +1 o -1.
+ * @param feed mm/min.
+ * @param distancia_max Recorrido máximo en mm (hasta el límite de software); <= 0 = sin tope.
+ * @return 0 si arrancó, -1 si no hay conexión o la máquina está streameando.
+ */
+int ws_pool_jog_iniciar(int maquina_id, char eje, int sentido, int feed, float distancia_max);
+
+/**
+ * @brief Deja de mandar segmentos y manda 0x85 (jog cancel): el controlador
+ * frena y descarta lo que tenía encolado.
+ */
+void ws_pool_jog_parar(int maquina_id);
+
+/**
+ * @brief Streamea un archivo G-code línea por línea con conteo de caracteres
+ * (nunca más de WS_POOL_RX_GRBL bytes sin "ok"). Si el controlador manda "Bf:"
+ * (FluidNC siempre; Grbl con $10), el límite es su RX si es más chico, y se
+ * espera mientras el planner no tenga bloques libres. Un "error" corta el stream.
+ * @return 0 si se aceptó, -1 si no hay conexión o ya hay un stream en curso.
+ */
+int ws_pool_stream_iniciar(int maquina_id, const char *ruta);
+
+/**
+ * @brief Deja de mandar líneas (lo que ya está en el controlador se ejecuta).
+ */
+void ws_pool_stream_cancelar(int maquina_id);
+
+/**
+ * @brief Progreso del stream.
+ * @param linea Última línea del archivo confirmada con "ok".
+ * @param en_vuelo Bytes enviados que todavía no tienen "ok".
+ * @return 1 si hay un stream en curso, 0 si no.
+ */
+int ws_pool_stream_progreso(int maquina_id, int *linea, int *en_vuelo);
+
+/**
+ * @brief Contadores de cómo terminan los programas de una máquina. Crecen
+ * desde el arranque (también entre reconexiones): se comparan contra una
+ * foto tomada al despachar.
+ * @param terminados Programas que terminaron limpios: stream con todos sus
+ * "ok" o "file job succeeded" de la SD.
+ * @param cortes Alarmas, puerta abierta y resets vistos.
+ */
+void ws_pool_eventos(int maquina_id, unsigned int *terminados, unsigned int *cortes);
+
+/**
+ * @brief Última posición de máquina (MPos) del reporte de estado.
+ * @param xyz Salida, 3 floats.
+ * @return 1 si se conoce, 0 si no hay conexión o todavía no llegó un reporte con MPos.
+ */
+int ws_pool_mpos(int maquina_id, float *xyz);
+
+/**
+ * @brief 1 si la conexión con la máquina está abierta.
+ */
+int ws_pool_conectada(int maquina_id);
+
+/**
+ * @brief IP (o nombre) con la que se conecta a una máquina: MQTT primero, si no machine_config.json.
+ * @return 1 si hay IP conocida, 0 si no.
+ */
+int ws_pool_ip(int maquina_id, char *ip, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_POOL_H
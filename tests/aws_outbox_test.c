@@ -0,0 +1,162 @@
+// Prueba del buzón de salida (src/aws/aws_outbox.c): el cursor guardado se
+// valida contra los segmentos que hay en disco al abrir (más nuevo que el
+// último, más viejo que el primero, offset más allá del final) y un commit
+// nunca borra lo que no se envió. También el reenvío de a un registro.
+//   ./aws_outbox_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "aws/aws_outbox.h"
+
+void logger_log(const char *tag, const char *msg) { printf("  [%s] %s\n", tag, msg); }
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[OUTBOX] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static char base[] = "/tmp/outbox_test_XXXXXX";
+static char dir[160];
+static int caso = 0;
+
+// Directorio nuevo con los segmentos y el cursor dados
+static void preparar(const char *cursor, int n_seg, const unsigned int *segs, const char **contenido) {
+    snprintf(dir, sizeof(dir), "%s/%d", base, ++caso);
+    char ruta[200];
+    snprintf(ruta, sizeof(ruta), "mkdir -p %s", dir);
+    if (system(ruta) != 0) return;
+    for (int i = 0; i < n_seg; i++) {
+        snprintf(ruta, sizeof(ruta), "%s/%08u.seg", dir, segs[i]);
+        FILE *f = fopen(ruta, "w");
+        fputs(contenido[i], f);
+        fclose(f);
+    }
+    if (cursor) {
+        snprintf(ruta, sizeof(ruta), "%s/cursor", dir);
+        FILE *f = fopen(ruta, "w");
+        fputs(cursor, f);
+        fclose(f);
+    }
+    outbox_init(dir);
+}
+
+static int existe_segmento(unsigned int seg) {
+    char ruta[200];
+    snprintf(ruta, sizeof(ruta), "%s/%08u.seg", dir, seg);
+    return access(ruta, F_OK) == 0;
+}
+
+// Lee todo lo pendiente, confirmando cada lote; devuelve los registros
+static int drenar(char *todo, size_t cap) {
+    char lote[1024];
+    OutboxCursor sig;
+    int total = 0, n;
+    todo[0] = '\0';
+    for (int vueltas = 0; vueltas < 16; vueltas++) {
+        n = outbox_peek_batch(lote, sizeof(lote), 100, &sig);
+        outbox_commit(&sig);
+        if (n == 0) continue;
+        total += n;
+        strncat(todo, lote, cap - strlen(todo) - 1);
+    }
+    return total;
+}
+
+static const char *dos[] = { "{\"a\":1}\n{\"a\":2}\n", "{\"a\":3}\n" };
+
+static void cursor_adelantado(void) {
+    printf("[OUTBOX] cursor más nuevo que el disco\n");
+    unsigned int segs[] = {1, 2};
+    preparar("7 0\n", 2, segs, dos);
+    // Antes: el cursor 7 se tomaba tal cual y los segmentos 1..6 se perdían
+    OutboxCursor sig;
+    char lote[256];
+    int n = outbox_peek_batch(lote, sizeof(lote), 100, &sig);
+    VERIFICAR(n == 2 && strcmp(lote, "[{\"a\":1},{\"a\":2}]") == 0, "primer lote %d: %s", n, lote);
+
+    // Lo nuevo va a un segmento que el cursor viejo habría dado por enviado
+    outbox_append("{\"a\":4}");
+    VERIFICAR(existe_segmento(1) && existe_segmento(2), "borró segmentos sin enviar");
+    char todo[1024];
+    n = drenar(todo, sizeof(todo));
+    VERIFICAR(n == 4, "se enviaron %d registros, esperado 4 (%s)", n, todo);
+    VERIFICAR(strstr(todo, "\"a\":4") != NULL, "se perdió el registro nuevo");
+}
+
+static void cursor_atrasado(void) {
+    printf("[OUTBOX] cursor más viejo que el primer segmento\n");
+    unsigned int segs[] = {5, 6};
+    preparar("2 40\n", 2, segs, dos);
+    char todo[1024];
+    int n = drenar(todo, sizeof(todo));
+    VERIFICAR(n == 3, "se enviaron %d registros, esperado 3 (%s)", n, todo);
+}
+
+static void offset_pasado(void) {
+    printf("[OUTBOX] offset más allá del final del segmento\n");
+    unsigned int segs[] = {1, 2};
+    preparar("2 9999\n", 2, segs, dos);
+    char todo[1024];
+    int n = drenar(todo, sizeof(todo));
+    VERIFICAR(n == 1 && strstr(todo, "\"a\":3"), "se enviaron %d registros: %s", n, todo);
+}
+
+static void cursor_valido(void) {
+    printf("[OUTBOX] cursor válido a mitad de segmento\n");
+    unsigned int segs[] = {1, 2};
+    preparar("1 8\n", 2, segs, dos);      // Después de {"a":1}\n
+    char todo[1024];
+    int n = drenar(todo, sizeof(todo));
+    VERIFICAR(n == 2 && !strstr(todo, "\"a\":1") && strstr(todo, "\"a\":2"), "se enviaron %d registros: %s", n, todo);
+    VERIFICAR(!existe_segmento(1), "no borró el segmento ya enviado");
+}
+
+static void sin_segmentos(void) {
+    printf("[OUTBOX] cursor sin segmentos en disco\n");
+    preparar("9 120\n", 0, NULL, NULL);
+    outbox_append("{\"a\":1}");
+    char todo[1024];
+    int n = drenar(todo, sizeof(todo));
+    VERIFICAR(n == 1, "se enviaron %d registros, esperado 1", n);
+}
+
+static void de_a_uno(void) {
+    printf("[OUTBOX] reenvío de a un registro\n");
+    unsigned int segs[] = {1, 2};
+    preparar(NULL, 2, segs, dos);
+    char reg[OUTBOX_RECORD_MAX];
+    OutboxCursor sig;
+    VERIFICAR(outbox_peek(reg, sizeof(reg), &sig) && strcmp(reg, "{\"a\":1}") == 0, "primero: %s", reg);
+    // Sin commit se vuelve a leer el mismo (el envío falló)
+    VERIFICAR(outbox_peek(reg, sizeof(reg), &sig) && strcmp(reg, "{\"a\":1}") == 0, "repetido: %s", reg);
+    outbox_commit(&sig);
+    VERIFICAR(outbox_peek(reg, sizeof(reg), &sig) && strcmp(reg, "{\"a\":2}") == 0, "segundo: %s", reg);
+    outbox_commit(&sig);
+    VERIFICAR(outbox_peek(reg, sizeof(reg), &sig) && strcmp(reg, "{\"a\":3}") == 0, "tercero: %s", reg);
+    outbox_commit(&sig);
+    VERIFICAR(!outbox_peek(reg, sizeof(reg), &sig), "quedó algo: %s", reg);
+    VERIFICAR(!existe_segmento(1), "no borró el segmento ya enviado");
+}
+
+int main(void) {
+    if (!mkdtemp(base)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    cursor_adelantado();
+    cursor_atrasado();
+    offset_pasado();
+    cursor_valido();
+    sin_segmentos();
+    de_a_uno();
+
+    char cmd[200];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", base);
+    if (system(cmd) != 0) printf("[OUTBOX] no se pudo borrar %s\n", base);
+    printf("[OUTBOX] %d fallas\n", fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+// Prueba del barrido de descubrimiento (src/discovery/discovery.c) contra
+// servidores falsos en loopback, todos en el mismo puerto:
+//   127.0.0.1  FluidNC falso: 101 + "CURRENT_ID:0" / "ACTIVE_ID:0"
+//   127.0.0.2  Servidor HTTP cualquiera (404): no es FluidNC
+//   127.0.0.3  Acepta y no contesta nunca: tiene que vencer por timeout
+//   resto      Nadie escucha: conexión rechazada
+//   ./discovery_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "discovery/discovery.h"
+
+#define TIMEOUT_MS 300
+
+typedef enum { FALSO_FLUIDNC, FALSO_HTTP, FALSO_MUDO } TipoFalso;
+
+typedef struct {
+    int fd;
+    TipoFalso tipo;
+} Falso;
+
+static int fallas = 0;
+
+// El hilo de descubrimiento anota en global_state (mqtt_service.c); el barrido no
+int maquina_descubierta(const char *ip) { (void)ip; return 0; }
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[DISCOVERY] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static int escuchar(const char *ip, int puerto) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int uno = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)puerto);
+    inet_pton(AF_INET, ip, &a.sin_addr);
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void enviar_texto(int fd, const char *txt) {
+    unsigned char frame[64];
+    size_t n = strlen(txt);
+    frame[0] = 0x81;            // FIN + texto
+    frame[1] = (unsigned char)n;
+    memcpy(frame + 2, txt, n);
+    send(fd, frame, n + 2, MSG_NOSIGNAL);
+}
+
+static void *servidor(void *arg) {
+    Falso *f = arg;
+    while (1) {
+        int c = accept(f->fd, NULL, NULL);
+        if (c < 0) break;
+        char req[1024];
+        int len = 0;
+        ssize_t n;
+        while (len < (int)sizeof(req) - 1 && (n = recv(c, req + len, sizeof(req) - 1 - (size_t)len, 0)) > 0) {
+            len += (int)n;
+            req[len] = '\0';
+            if (strstr(req, "\r\n\r\n")) break;
+        }
+        if (f->tipo == FALSO_FLUIDNC) {
+            const char *r = "HTTP/1.1 101 Switching Protocols\r\n"
+                            "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                            "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n\r\n";
+            send(c, r, strlen(r), MSG_NOSIGNAL);
+            enviar_texto(c, "CURRENT_ID:0");
+            enviar_texto(c, "ACTIVE_ID:0");
+        } else if (f->tipo == FALSO_HTTP) {
+            const char *r = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+            send(c, r, strlen(r), MSG_NOSIGNAL);
+        } else {
+            usleep(3 * TIMEOUT_MS * 1000);  // Mudo: el barrido tiene que cortar antes
+        }
+        close(c);
+    }
+    return NULL;
+}
+
+typedef struct {
+    char ips[8][16];
+    int n;
+} Hallados;
+
+static void anotar(const char *ip, void *ctx) {
+    Hallados *h = ctx;
+    if (h->n < 8) snprintf(h->ips[h->n], sizeof(h->ips[0]), "%s", ip);
+    h->n++;
+}
+
+int main(void) {
+    // Puerto libre en 127.0.0.1 y el mismo para los otros falsos
+    int fd = escuchar("127.0.0.1", 0);
+    if (fd < 0) {
+        fprintf(stderr, "[DISCOVERY] No se pudo escuchar en loopback\n");
+        return 1;
+    }
+    struct sockaddr_in a;
+    socklen_t l = sizeof(a);
+    getsockname(fd, (struct sockaddr *)&a, &l);
+    int puerto = ntohs(a.sin_port);
+
+    static Falso falsos[3];
+    falsos[0] = (Falso){ fd, FALSO_FLUIDNC };
+    falsos[1] = (Falso){ escuchar("127.0.0.2", puerto), FALSO_HTTP };
+    falsos[2] = (Falso){ escuchar("127.0.0.3", puerto), FALSO_MUDO };
+    for (int i = 0; i < 3; i++) {
+        if (falsos[i].fd < 0) {
+            fprintf(stderr, "[DISCOVERY] No se pudo escuchar en 127.0.0.%d:%d\n", i + 1, puerto);
+            return 1;
+        }
+        pthread_t t;
+        pthread_create(&t, NULL, servidor, &falsos[i]);
+        pthread_detach(t);
+    }
+
+    // Un /24 entero: 254 sondas a la vez
+    Hallados h = { .n = 0 };
+    long t0 = ahora_ms();
+    int r = discovery_barrer_cidr("127.0.0.0/24", puerto, TIMEOUT_MS, anotar, &h);
+    long dt = ahora_ms() - t0;
+
+    VERIFICAR(r == 1 && h.n == 1, "se esperaba 1 FluidNC, hubo %d (cb %d)", r, h.n);
+    VERIFICAR(h.n < 1 || strcmp(h.ips[0], "127.0.0.1") == 0, "IP hallada %s", h.ips[0]);
+    // Todas en paralelo: el barrido dura lo que la sonda más lenta (el mudo)
+    VERIFICAR(dt < 3 * TIMEOUT_MS, "el barrido tardó %ld ms", dt);
+
+    // Una sola IP (/32): lo que hace el descubrimiento con un anuncio mDNS
+    Hallados h1 = { .n = 0 };
+    r = discovery_barrer_cidr("127.0.0.1/32", puerto, TIMEOUT_MS, anotar, &h1);
+    VERIFICAR(r == 1 && h1.n == 1, "/32: %d", r);
+    r = discovery_barrer_cidr("127.0.0.2/32", puerto, TIMEOUT_MS, NULL, NULL);
+    VERIFICAR(r == 0, "el 404 no es FluidNC");
+    VERIFICAR(discovery_barrer_cidr("no.es.una.ip/24", puerto, TIMEOUT_MS, NULL, NULL) == -1, "CIDR inválido");
+
+    printf("[DISCOVERY] /24 barrido en %ld ms, %d FluidNC, %d fallas\n", dt, h.n, fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+// Prueba de la posición estimada entre reportes (src/dro/dro.c) y del
+// trayecto por línea (gcode_trayecto_cargar): extrapolación con el feed,
+// topes por intervalo y sin segmento, tope en el fin del segmento, segmento
+// que no es el actual, mezcla hacia la muestra real y máquina quieta. Al
+// final recorre un programa con reportes a 5 Hz y DRO a 60 Hz y compara
+// contra la posición verdadera, con y sin el segmento.
+//   ./dro_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "dro/dro.h"
+#include "scheduler/gcode_estimate.h"
+
+#define REPORTE_MS  200         // 5 Hz
+#define FRAME_MS    16          // 60 Hz
+#define FEED        1500.0f     // mm/min = 0.025 mm/ms
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[DRO] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static int cerca(const float a[3], float x, float y, float z) {
+    return fabsf(a[0] - x) < 1e-3f && fabsf(a[1] - y) < 1e-3f && fabsf(a[2] - z) < 1e-3f;
+}
+
+static void casos_basicos(void) {
+    Dro d;
+    float out[3];
+    dro_reset(&d);
+
+    // Sin muestras: cero, sin extrapolar
+    dro_estimar(&d, 5000, out);
+    VERIFICAR(cerca(out, 0, 0, 0), "sin muestras");
+
+    // Primera muestra en movimiento: no hay dirección todavía
+    float p0[3] = {0, 0, 0}, p1[3] = {5, 0, 0};
+    dro_muestra(&d, p0, 1000, FEED, 1);
+    dro_estimar(&d, 1100, out);
+    VERIFICAR(cerca(out, 0, 0, 0), "primera muestra extrapoló (%.3f)", out[0]);
+
+    // Segunda: dirección medida, rapidez del feed. Sin segmento avanza como
+    // mucho DRO_AVANCE_SIN_FIN del intervalo observado (200 ms), aunque el
+    // reporte se atrase
+    const float tope_sin_fin = 0.025f * DRO_AVANCE_SIN_FIN * 200;
+    dro_muestra(&d, p1, 1200, FEED, 1);
+    dro_estimar(&d, 1200 + DRO_MEZCLA_MS, out);
+    VERIFICAR(cerca(out, 5 + 0.025f * DRO_MEZCLA_MS, 0, 0), "recién mezclado %.3f", out[0]);
+    dro_estimar(&d, 1300, out);
+    VERIFICAR(cerca(out, 5 + tope_sin_fin, 0, 0), "tope sin segmento %.3f", out[0]);
+    dro_estimar(&d, 9000, out);
+    VERIFICAR(cerca(out, 5 + tope_sin_fin, 0, 0), "tope de edad %.3f", out[0]);
+
+    // Llega el dato real: no salta, llega a él en DRO_MEZCLA_MS
+    float p2[3] = {9.5f, 0, 0};
+    dro_muestra(&d, p2, 1400, FEED, 1);
+    dro_estimar(&d, 1400, out);
+    VERIFICAR(cerca(out, 5 + tope_sin_fin, 0, 0), "saltó a la muestra (%.3f)", out[0]);
+    dro_estimar(&d, 1400 + DRO_MEZCLA_MS, out);
+    VERIFICAR(cerca(out, 9.5f + 0.025f * DRO_MEZCLA_MS, 0, 0), "no llegó a la muestra (%.3f)", out[0]);
+
+    // Sobre un segmento del programa: hasta el intervalo entero, sin pasar su fin
+    float ini[3] = {0, 0, 0}, fin[3] = {11, 0, 0};
+    VERIFICAR(dro_segmento(&d, ini, fin), "segmento bajo la posición rechazado");
+    dro_estimar(&d, 1400 + DRO_MEZCLA_MS + 20, out);
+    VERIFICAR(cerca(out, 9.5f + 0.025f * (DRO_MEZCLA_MS + 20), 0, 0), "sobre el segmento %.3f", out[0]);
+    dro_estimar(&d, 1600, out);
+    VERIFICAR(cerca(out, 11, 0, 0), "pasó el fin del segmento (%.3f)", out[0]);
+
+    // Segmento que todavía no empezó (línea adelantada del planificador): se ignora
+    float p3[3] = {14.5f, 0, 0};
+    dro_muestra(&d, p3, 1600, FEED, 1);
+    float otro_ini[3] = {20, 0, 0}, otro_fin[3] = {20, 20, 0};
+    VERIFICAR(!dro_segmento(&d, otro_ini, otro_fin) && !d.tiene_fin, "segmento adelantado aceptado");
+    dro_estimar(&d, 1700, out);
+    VERIFICAR(cerca(out, 14.5f + tope_sin_fin, 0, 0), "sin segmento %.3f", out[0]);
+
+    // Sin feed (la nube): la rapidez es la medida
+    dro_reset(&d);
+    float q0[3] = {0, 0, 0}, q1[3] = {0, 2, 0};
+    dro_muestra(&d, q0, 0 + 1, -1, 1);
+    dro_muestra(&d, q1, 201, -1, 1);
+    dro_estimar(&d, 241, out);
+    VERIFICAR(cerca(out, 0, 2.4f, 0), "rapidez medida %.3f (esperado 2.4)", out[1]);
+
+    // Un salto de más de dos intervalos (reconexión) no se mezcla
+    float lejos[3] = {0, 50, 0};
+    dro_muestra(&d, lejos, 401, -1, 1);
+    dro_estimar(&d, 401, out);
+    VERIFICAR(cerca(out, 0, 50, 0), "mezcló un salto de reconexión (%.3f)", out[1]);
+
+    // Se paró: directo a la posición reportada, aunque pase el tiempo
+    dro_muestra(&d, q1, 601, 0, 0);
+    dro_estimar(&d, 601, out);
+    VERIFICAR(cerca(out, 0, 2, 0), "parada y mezcló");
+    dro_estimar(&d, 800, out);
+    VERIFICAR(cerca(out, 0, 2, 0), "quieta y extrapoló");
+
+    VERIFICAR(dro_estado_mueve("Run") && dro_estado_mueve("Jog") && dro_estado_mueve("TRABAJANDO"), "estados en movimiento");
+    VERIFICAR(!dro_estado_mueve("Idle") && !dro_estado_mueve("Hold:0") && !dro_estado_mueve("Alarm"), "estados quietos");
+}
+
+static void trayecto(const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    fprintf(f, "(prueba)\n"
+               "G21 G90 G0 X10 Y5\n"
+               "G1 Z-1 F300\n"
+               "G91 X5 Y5 ; relativo\n"
+               "G90 G2 X0 Y0 I-5 J0\n"
+               "M3 S1000\n"
+               "G20 G1 X1\n");
+    fclose(f);
+
+    int n = 0;
+    GcodeSegmento *s = gcode_trayecto_cargar(ruta, &n);
+    VERIFICAR(s && n == 7, "trayecto: %d líneas", n);
+    if (!s) return;
+    VERIFICAR(s[0].modo == GCODE_SIN_MOVIMIENTO, "línea de comentario con movimiento");
+    VERIFICAR(s[1].modo == 0 && cerca(s[1].fin, 10, 5, 0), "G0 X10 Y5");
+    VERIFICAR(s[2].modo == 1 && cerca(s[2].fin, 10, 5, -1), "G1 Z-1");
+    VERIFICAR(s[3].modo == 1 && cerca(s[3].fin, 15, 10, -1), "G91 X5 Y5");
+    VERIFICAR(s[4].modo == 2 && cerca(s[4].fin, 0, 0, -1), "G2");
+    VERIFICAR(s[5].modo == GCODE_SIN_MOVIMIENTO, "M3");
+    VERIFICAR(s[6].modo == 1 && cerca(s[6].fin, 25.4f, 0, -1), "G20 X1 = %.3f", s[6].fin[0]);
+    free(s);
+}
+
+// Un cuadrado a FEED: posición verdadera en cada ms y fin del tramo en curso
+#define LADO 41.3f     // Las esquinas no caen justo en un reporte
+static const float esq_x[5] = {0, LADO, LADO, 0, 0}, esq_y[5] = {0, 0, LADO, LADO, 0};
+
+static int verdadera(long t, float out[3]) {
+    float d = fmodf(t * FEED / 60000.0f, 4 * LADO);
+    int tramo = (int)(d / LADO);
+    float r = d - tramo * LADO;
+    out[0] = esq_x[tramo] + (esq_x[tramo + 1] - esq_x[tramo]) * r / LADO;
+    out[1] = esq_y[tramo] + (esq_y[tramo + 1] - esq_y[tramo]) * r / LADO;
+    out[2] = 0;
+    return tramo;
+}
+
+static float dist(const float a[3], const float b[3]) {
+    return sqrtf((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static void recorrido(int con_segmento) {
+    Dro d;
+    dro_reset(&d);
+    float ant[3] = {0, 0, 0}, real[3], est[3];
+    float err_max = 0, salto_max = 0, salto_crudo = 0;
+    double err_suma = 0;
+    int n = 0;
+    for (long t = 1; t <= 30000; t += FRAME_MS) {
+        // Reporte cada REPORTE_MS, con su propio reloj
+        if (t / REPORTE_MS != (t - FRAME_MS) / REPORTE_MS) {
+            long tr = (t / REPORTE_MS) * REPORTE_MS;
+            float p[3];
+            int tramo = verdadera(tr, p);
+            dro_muestra(&d, p, tr, FEED, 1);
+            float ini[3] = {esq_x[tramo], esq_y[tramo], 0};
+            float fin[3] = {esq_x[tramo + 1], esq_y[tramo + 1], 0};
+            if (con_segmento) dro_segmento(&d, ini, fin);
+            salto_crudo = FEED / 60000.0f * REPORTE_MS;
+        }
+        dro_estimar(&d, t, est);
+        verdadera(t, real);
+        float e = dist(est, real);
+        if (t > 2 * REPORTE_MS) {
+            if (e > err_max) err_max = e;
+            err_suma += e;
+            n++;
+        }
+        float s = dist(est, ant);
+        if (t > 2 * REPORTE_MS && s > salto_max) salto_max = s;
+        memcpy(ant, est, sizeof(ant));
+    }
+    // Sin estimar, el DRO salta lo que se mueve en un reporte (5 mm a 1500
+    // mm/min) y va en promedio medio reporte atrás. Con el segmento, solo se
+    // equivoca al doblar en una esquina entre dos reportes. Sin él tiene que
+    // quedarse atrás para no pasarse en las esquinas, pero nunca peor que
+    // sin estimar: ni salta más ni se aleja más.
+    printf("[DRO] cuadrado a %.0f mm/min, reportes a %d ms, frames a %d ms, %s: "
+           "error medio %.3f mm, max %.2f mm, salto max %.2f mm (sin estimar: %.2f mm)\n",
+           FEED, REPORTE_MS, FRAME_MS, con_segmento ? "con segmento" : "solo medido",
+           err_suma / n, err_max, salto_max, salto_crudo);
+    VERIFICAR(err_suma / n < (con_segmento ? 0.1 : 0.4) * salto_crudo, "error medio %.3f mm", err_suma / n);
+    VERIFICAR(salto_max < salto_crudo, "el DRO salta %.2f mm, más que sin estimar", salto_max);
+    VERIFICAR(err_max <= salto_crudo, "error %.2f mm mayor que un reporte", err_max);
+}
+
+int main(void) {
+    casos_basicos();
+
+    char ruta[] = "/tmp/dro_test_XXXXXX";
+    int fd = mkstemp(ruta);
+    if (fd >= 0) {
+        close(fd);
+        trayecto(ruta);
+        unlink(ruta);
+    } else {
+        VERIFICAR(0, "no se pudo crear el archivo temporal");
+    }
+
+    recorrido(0);
+    recorrido(1);
+    printf("[DRO] %d fallas\n", fallas);
+    return fallas ? 1 : 0;
+}
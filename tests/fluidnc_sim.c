@@ -0,0 +1,1033 @@
+// Simulador de controladores FluidNC para pruebas de carga y latencia.
+//
+// Cada máquina simulada tiene su puerto HTTP (POST /upload) y su WebSocket
+// (puerto HTTP + 1, como FluidNC). Todo corre en un solo hilo con epoll, así
+// que cientos de máquinas entran en una laptop.
+//
+// Lo que emula:
+//  - Buffer RX de Grbl con conteo de caracteres (-r bytes): la línea ocupa el
+//    buffer hasta que se ejecuta y sale su "ok". Si el gateway manda de más,
+//    los bytes que no entran se pierden y se cuentan como desborde.
+//  - Planner de SIM_PLANNER bloques: con el planner lleno las líneas esperan
+//    en el RX (y el "ok" se demora), igual que en la máquina real.
+//  - G0/G1/G2/G3 (los arcos como rectas), G90/G91, F, N, $J=, $X, $H y los
+//    bytes de tiempo real: ? ! ~ 0x18 0x85 y overrides de avance 0x90-0x94.
+//  - Reportes "<Run|MPos:..|Bf:..|FS:..|Ln:..>" con WCO cada 10 y "ok"/"error:N".
+//  - Latencia de ida y vuelta (-l) con jitter (-j) en todo lo que se responde,
+//    sin desordenar las respuestas de una conexión.
+//
+//   ./fluidnc_sim -n 200 -p 8080 -l 20 -j 5 -c machine_config.json
+// Máquina i (desde 0): HTTP en 127.0.0.1:8080+2i, WebSocket en 8081+2i.
+// Con -I cada máquina usa una IP de loopback propia (127.0.1.1, 127.0.1.2...)
+// y todas los mismos puertos.
+
+#define _GNU_SOURCE     // strcasestr
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+#include <ctype.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define SIM_MAX_MAQUINAS   1000
+#define SIM_PLANNER        15          // Bloques del planner (Grbl: 15)
+#define SIM_RX_DEFECTO     128         // Buffer RX de Grbl
+#define SIM_RX_MAX         1024
+#define SIM_RAPIDO         5000.0f     // mm/min de G0
+#define SIM_SALIDA_MAX     128         // Respuestas demoradas por conexión
+#define SIM_RED_MAX        8192        // Bytes crudos del socket sin procesar
+#define SIM_TX_MAX         16384
+#define SIM_WCO_CADA       10          // Reportes entre un WCO y el siguiente
+#define SIM_STATS_MS       5000
+
+typedef enum { NODO_ESCUCHA_WS, NODO_ESCUCHA_HTTP, NODO_WS, NODO_HTTP } TipoNodo;
+
+typedef struct {
+    float destino[3];
+    float feed;             // mm/min
+    int jog;
+    long linea;
+} Bloque;
+
+typedef struct Maquina Maquina;
+typedef struct Conexion Conexion;
+
+typedef struct {
+    TipoNodo tipo;          // Primero: epoll guarda un puntero al nodo
+    int fd;
+    Maquina *m;
+} Escucha;
+
+typedef struct {
+    long t_ms;              // Cuándo sale
+    int texto;              // Frame de texto (saludo) o binario (canal Grbl)
+    short len;
+    char dato[160];
+} Salida;
+
+struct Conexion {
+    TipoNodo tipo;
+    int fd;
+    Maquina *m;
+    Conexion *sig;          // Lista de la máquina (WS) o global (HTTP)
+    int abierta;            // WS: handshake hecho
+    int cerrar_al_vaciar;
+
+    unsigned char red[SIM_RED_MAX];     // Lo recibido sin procesar
+    size_t red_len;
+
+    // WS: buffer RX de Grbl y respuestas demoradas
+    char grbl[SIM_RX_MAX];
+    int grbl_len;
+    int desbordes;
+    Salida sal[SIM_SALIDA_MAX];
+    int sal_ini;
+    int sal_n;
+    long sal_ultimo_ms;
+
+    // HTTP
+    int http_cab;           // Cabeceras leídas
+    int http_upload;
+    long http_largo;
+    long http_leidos;
+    long http_inicio_ms;
+    long http_listo_ms;     // Se responde a partir de acá (-u)
+    char archivo[96];
+
+    unsigned char tx[SIM_TX_MAX];
+    size_t tx_len;
+    int esperando_out;
+};
+
+struct Maquina {
+    int id;
+    Escucha escucha_http;
+    Escucha escucha_ws;
+    int puerto_http;
+    char ip[INET_ADDRSTRLEN];
+
+    float mpos[3];
+    Bloque planner[SIM_PLANNER];
+    int pl_ini;
+    int pl_n;
+    long t_ms;              // Último avance de la simulación
+
+    // Estado modal
+    int absoluto;           // G90
+    int rapido;             // G0
+    float feed;
+    long linea;             // N de la última línea ejecutada
+
+    int hold;
+    int alarma;
+    int ov_feed;            // %
+    int reportes;
+    char ultimo_archivo[96];
+    long ultimo_tamano;
+    Conexion *ws;
+};
+
+// --- Opciones ---
+static int n_maquinas = 10;
+static int puerto_base = 8080;
+static char ip_base[INET_ADDRSTRLEN] = "127.0.0.1";
+static int una_ip_por_maquina = 0;
+static int latencia_ms = 0;
+static int jitter_ms = 0;
+static int rx_grbl = SIM_RX_DEFECTO;
+static double tasa_error = 0.0;        // % de líneas G-code que responden error:20
+static int upload_kbps = 0;            // 0 = sin límite
+static const char *archivo_config = NULL;
+
+static Maquina *maquinas;
+static Conexion *http_lista = NULL;
+static int ep;
+static volatile sig_atomic_t salir = 0;
+
+// --- Contadores ---
+static long st_lineas, st_errores, st_reportes, st_desbordes, st_subidos, st_uploads;
+static int st_ws, st_http;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// --------------------------------------------------------------------------
+// SHA-1 + base64 (Sec-WebSocket-Accept)
+// --------------------------------------------------------------------------
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1_bloque(uint32_t h[5], const unsigned char *p) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+               ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+    }
+    for (int i = 16; i < 80; i++) w[i] = ROTL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = ROTL(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = ROTL(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void sha1(const unsigned char *d, size_t n, unsigned char out[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) sha1_bloque(h, d + i);
+
+    unsigned char blk[128] = { 0 };
+    size_t r = n - i;
+    memcpy(blk, d + i, r);
+    blk[r] = 0x80;
+    size_t total = (r < 56) ? 64 : 128;
+    uint64_t bits = (uint64_t)n * 8;
+    for (int k = 0; k < 8; k++) blk[total - 1 - k] = (unsigned char)(bits >> (8 * k));
+    sha1_bloque(h, blk);
+    if (total == 128) sha1_bloque(h, blk + 64);
+
+    for (int k = 0; k < 5; k++) {
+        out[4 * k] = (unsigned char)(h[k] >> 24);
+        out[4 * k + 1] = (unsigned char)(h[k] >> 16);
+        out[4 * k + 2] = (unsigned char)(h[k] >> 8);
+        out[4 * k + 3] = (unsigned char)h[k];
+    }
+}
+
+static void base64(const unsigned char *in, size_t len, char *out) {
+    static const char t[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        unsigned int v = in[i] << 16;
+        if (i + 1 < len) v |= in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[o++] = t[(v >> 18) & 63];
+        out[o++] = t[(v >> 12) & 63];
+        out[o++] = (i + 1 < len) ? t[(v >> 6) & 63] : '=';
+        out[o++] = (i + 2 < len) ? t[v & 63] : '=';
+    }
+    out[o] = '\0';
+}
+
+// --------------------------------------------------------------------------
+// Conexiones
+// --------------------------------------------------------------------------
+static void vigilar(int fd, void *nodo, uint32_t eventos, int op) {
+    struct epoll_event ev = { .events = eventos, .data.ptr = nodo };
+    epoll_ctl(ep, op, fd, &ev);
+}
+
+static void cerrar_conexion(Conexion *c) {
+    Conexion **lista = (c->tipo == NODO_WS) ? &c->m->ws : &http_lista;
+    for (Conexion **p = lista; *p; p = &(*p)->sig) {
+        if (*p == c) {
+            *p = c->sig;
+            break;
+        }
+    }
+    if (c->tipo == NODO_WS) st_ws--;
+    else st_http--;
+    close(c->fd);
+    free(c);
+}
+
+// Devuelve -1 si la conexión se cerró
+static int vaciar_tx(Conexion *c) {
+    while (c->tx_len > 0) {
+        ssize_t n = send(c->fd, c->tx, c->tx_len, MSG_NOSIGNAL);
+        if (n > 0) {
+            memmove(c->tx, c->tx + n, c->tx_len - (size_t)n);
+            c->tx_len -= (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            cerrar_conexion(c);
+            return -1;
+        }
+    }
+    int quiere = c->tx_len > 0;
+    if (quiere != c->esperando_out) {
+        vigilar(c->fd, c, EPOLLIN | EPOLLRDHUP | (quiere ? EPOLLOUT : 0), EPOLL_CTL_MOD);
+        c->esperando_out = quiere;
+    }
+    if (!quiere && c->cerrar_al_vaciar) {
+        cerrar_conexion(c);
+        return -1;
+    }
+    return 0;
+}
+
+static int encolar_tx(Conexion *c, const void *dato, size_t n) {
+    if (c->tx_len + n > SIM_TX_MAX) return -1;     // Cliente que no lee
+    memcpy(c->tx + c->tx_len, dato, n);
+    c->tx_len += n;
+    return 0;
+}
+
+static int encolar_frame(Conexion *c, int opcode, const char *dato, size_t n) {
+    unsigned char cab[4];
+    size_t h = 2;
+    cab[0] = (unsigned char)(0x80 | opcode);
+    if (n < 126) {
+        cab[1] = (unsigned char)n;
+    } else {
+        cab[1] = 126;
+        cab[2] = (unsigned char)(n >> 8);
+        cab[3] = (unsigned char)n;
+        h = 4;
+    }
+    if (c->tx_len + h + n > SIM_TX_MAX) return -1;
+    encolar_tx(c, cab, h);
+    encolar_tx(c, dato, n);
+    return 0;
+}
+
+// Respuesta del canal Grbl: sale después de la latencia, en orden
+static void responder(Conexion *c, const char *txt) {
+    long t = ahora_ms() + latencia_ms;
+    if (jitter_ms > 0) t += (rand() % (2 * jitter_ms + 1)) - jitter_ms;
+    if (t < c->sal_ultimo_ms) t = c->sal_ultimo_ms;
+    c->sal_ultimo_ms = t;
+
+    if (c->sal_n == SIM_SALIDA_MAX) {
+        // Sin lugar para demorarla: sale ya (se pierde la latencia, no la respuesta)
+        encolar_frame(c, 0x2, txt, strlen(txt));
+        return;
+    }
+    Salida *s = &c->sal[(c->sal_ini + c->sal_n) % SIM_SALIDA_MAX];
+    s->t_ms = t;
+    s->texto = 0;
+    s->len = (short)snprintf(s->dato, sizeof(s->dato), "%s", txt);
+    if (s->len >= (short)sizeof(s->dato)) s->len = sizeof(s->dato) - 1;
+    c->sal_n++;
+}
+
+static int despachar_salidas(Conexion *c, long ahora) {
+    int hubo = 0;
+    while (c->sal_n > 0) {
+        Salida *s = &c->sal[c->sal_ini];
+        if (s->t_ms > ahora) break;
+        if (encolar_frame(c, s->texto ? 0x1 : 0x2, s->dato, (size_t)s->len) < 0) break;
+        c->sal_ini = (c->sal_ini + 1) % SIM_SALIDA_MAX;
+        c->sal_n--;
+        hubo = 1;
+    }
+    return hubo ? vaciar_tx(c) : 0;
+}
+
+// --------------------------------------------------------------------------
+// Máquina
+// --------------------------------------------------------------------------
+static const char *texto_estado(const Maquina *m) {
+    if (m->alarma) return "Alarm";
+    if (m->hold) return m->pl_n > 0 ? "Hold:0" : "Idle";
+    if (m->pl_n > 0) return m->planner[m->pl_ini].jog ? "Jog" : "Run";
+    return "Idle";
+}
+
+static void reporte(Maquina *m, Conexion *c) {
+    char r[160];
+    float feed = m->pl_n > 0 && !m->hold ? m->planner[m->pl_ini].feed * m->ov_feed / 100.0f : 0.0f;
+    int n = snprintf(r, sizeof(r), "<%s|MPos:%.3f,%.3f,%.3f|Bf:%d,%d|FS:%.0f,0",
+                     texto_estado(m), m->mpos[0], m->mpos[1], m->mpos[2],
+                     SIM_PLANNER - m->pl_n, rx_grbl - c->grbl_len, feed);
+    if (m->linea > 0) n += snprintf(r + n, sizeof(r) - (size_t)n, "|Ln:%ld", m->linea);
+    if (m->reportes++ % SIM_WCO_CADA == 0) {
+        n += snprintf(r + n, sizeof(r) - (size_t)n, "|WCO:0.000,0.000,0.000|Ov:%d,100,100", m->ov_feed);
+    }
+    snprintf(r + n, sizeof(r) - (size_t)n, ">\r\n");
+    responder(c, r);
+    st_reportes++;
+}
+
+// Avanza los ejes a velocidad constante (sin aceleración)
+static void mover(Maquina *m, long ahora) {
+    float ms = (float)(ahora - m->t_ms);
+    m->t_ms = ahora;
+    if (m->hold || m->alarma) return;
+
+    while (ms > 0.0f && m->pl_n > 0) {
+        Bloque *b = &m->planner[m->pl_ini];
+        float d[3], dist = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            d[i] = b->destino[i] - m->mpos[i];
+            dist += d[i] * d[i];
+        }
+        dist = sqrtf(dist);
+        float vel = b->feed * (float)m->ov_feed / 100.0f / 60000.0f;    // mm/ms
+        if (vel <= 0.0f) vel = 1e-6f;
+
+        if (dist <= vel * ms) {
+            memcpy(m->mpos, b->destino, sizeof(m->mpos));
+            ms -= dist / vel;
+            m->pl_ini = (m->pl_ini + 1) % SIM_PLANNER;
+            m->pl_n--;
+        } else {
+            float k = vel * ms / dist;
+            for (int i = 0; i < 3; i++) m->mpos[i] += d[i] * k;
+            ms = 0.0f;
+        }
+    }
+}
+
+static void vaciar_planner(Maquina *m, int solo_jog) {
+    if (!solo_jog) {
+        m->pl_n = 0;
+        return;
+    }
+    // Jog cancel: los bloques $J son siempre los últimos encolados
+    while (m->pl_n > 0 && m->planner[(m->pl_ini + m->pl_n - 1) % SIM_PLANNER].jog) m->pl_n--;
+}
+
+typedef struct {
+    int error;
+    int mueve;
+    Bloque b;
+    int absoluto, rapido;
+    float feed;
+    long linea;
+    int desbloquear, homing;
+} Interpretacion;
+
+// Interpreta sin tocar la máquina: si el planner está lleno, la línea se
+// vuelve a interpretar más tarde.
+static void interpretar(const Maquina *m, const char *linea, Interpretacion *r) {
+    memset(r, 0, sizeof(*r));
+    r->absoluto = m->absoluto;
+    r->rapido = m->rapido;
+    r->feed = m->feed;
+    r->linea = -1;
+    memcpy(r->b.destino, m->mpos, sizeof(r->b.destino));
+    // Destino desde el final de lo encolado, no desde la posición actual
+    if (m->pl_n > 0) {
+        memcpy(r->b.destino, m->planner[(m->pl_ini + m->pl_n - 1) % SIM_PLANNER].destino, sizeof(r->b.destino));
+    }
+
+    const char *p = linea;
+    int jog = 0;
+    if (*p == '$') {
+        if (strncmp(p, "$J=", 3) == 0) {
+            jog = 1;
+            p += 3;
+            r->absoluto = 1;    // $J no hereda G91: hay que pedirlo en la línea
+        } else {
+            if (strcmp(p, "$X") == 0) r->desbloquear = 1;
+            else if (strcmp(p, "$H") == 0) r->homing = 1;
+            return;             // Resto de $: ok
+        }
+    }
+
+    float eje[3];
+    int hay_eje[3] = { 0, 0, 0 };
+    int hay_feed = 0;
+    while (*p) {
+        char letra = *p++;
+        if (letra == ' ') continue;
+        if (!isalpha((unsigned char)letra)) {
+            r->error = 1;       // Expected command letter
+            return;
+        }
+        char *fin;
+        float v = strtof(p, &fin);
+        if (fin == p) {
+            r->error = 2;       // Bad number format
+            return;
+        }
+        p = fin;
+        switch (letra) {
+        case 'G':
+            if (v == 0.0f) r->rapido = 1;
+            else if (v == 1.0f || v == 2.0f || v == 3.0f) r->rapido = 0;
+            else if (v == 90.0f) r->absoluto = 1;
+            else if (v == 91.0f) r->absoluto = 0;
+            break;
+        case 'X': case 'Y': case 'Z': {
+            int i = letra - 'X';
+            eje[i] = v;
+            hay_eje[i] = 1;
+            break;
+        }
+        case 'F':
+            r->feed = v;
+            hay_feed = 1;
+            break;
+        case 'N':
+            r->linea = (long)v;
+            break;
+        default:
+            break;              // M, S, T, I, J, K, P...: se aceptan sin efecto
+        }
+    }
+
+    int hay_destino = hay_eje[0] || hay_eje[1] || hay_eje[2];
+    if (jog) {
+        if (!hay_feed) { r->error = 22; return; }          // Undefined feed rate
+        if (!hay_destino) { r->error = 3; return; }
+    }
+    if (!hay_destino) return;      // G0/G1 sin ejes: solo cambia el modal
+
+    // Ejes sin G: se mueve con el modo modal (G0 o G1), como Grbl
+    for (int i = 0; i < 3; i++) {
+        if (hay_eje[i]) r->b.destino[i] = r->absoluto ? eje[i] : r->b.destino[i] + eje[i];
+    }
+    r->b.jog = jog;
+    r->b.feed = (r->rapido && !jog) ? SIM_RAPIDO : r->feed;
+    if (!jog && !r->rapido && r->feed <= 0.0f) { r->error = 22; return; }
+    r->mueve = 1;
+    if (jog) {
+        // El modal del programa no cambia con un jog
+        r->absoluto = m->absoluto;
+        r->rapido = m->rapido;
+        r->feed = m->feed;
+    }
+}
+
+// Ejecuta las líneas completas del RX mientras el planner tenga lugar
+static void procesar_rx(Conexion *c) {
+    Maquina *m = c->m;
+    while (c->grbl_len > 0) {
+        char *nl = memchr(c->grbl, '\n', (size_t)c->grbl_len);
+        if (!nl) {
+            if (c->grbl_len >= rx_grbl) c->grbl_len = 0;   // Línea más larga que el buffer
+            return;
+        }
+        int largo = (int)(nl - c->grbl) + 1;
+
+        char linea[SIM_RX_MAX + 1];
+        int n = 0;
+        for (int i = 0; i < largo; i++) {
+            char ch = c->grbl[i];
+            if (ch == '(') {
+                while (i < largo && c->grbl[i] != ')') i++;
+                continue;
+            }
+            if (ch == ';') break;
+            if (ch == '\r' || ch == '\n' || ch == ' ' || ch == '\t') continue;
+            linea[n++] = (char)toupper((unsigned char)ch);
+        }
+        linea[n] = '\0';
+
+        Interpretacion r;
+        interpretar(m, linea, &r);
+        if (!r.error && r.mueve) {
+            if (m->alarma) r.error = 9;                                 // Locked out
+            else if (r.b.jog && m->pl_n > 0 && !m->planner[(m->pl_ini + m->pl_n - 1) % SIM_PLANNER].jog) r.error = 8;
+            else if (m->pl_n >= SIM_PLANNER) return;                   // Planner lleno: sigue en el RX
+        }
+        if (!r.error && linea[0] && linea[0] != '$' && tasa_error > 0.0 &&
+            rand() < (int)(tasa_error / 100.0 * RAND_MAX)) {
+            r.error = 20;                                               // Unsupported command
+        }
+
+        if (r.error) {
+            char e[24];
+            snprintf(e, sizeof(e), "error:%d\r\n", r.error);
+            responder(c, e);
+            st_errores++;
+        } else {
+            m->absoluto = r.absoluto;
+            m->rapido = r.rapido;
+            m->feed = r.feed;
+            if (r.linea >= 0) m->linea = r.linea;
+            if (r.desbloquear) m->alarma = 0;
+            if (r.homing) {
+                vaciar_planner(m, 0);
+                memset(m->mpos, 0, sizeof(m->mpos));
+                m->alarma = 0;
+            }
+            if (r.mueve) {
+                r.b.linea = m->linea;
+                m->planner[(m->pl_ini + m->pl_n) % SIM_PLANNER] = r.b;
+                m->pl_n++;
+            }
+            responder(c, "ok\r\n");
+            st_lineas++;
+        }
+
+        // La línea libera su lugar en el RX recién ahora (conteo de caracteres)
+        memmove(c->grbl, c->grbl + largo, (size_t)(c->grbl_len - largo));
+        c->grbl_len -= largo;
+    }
+}
+
+// Bytes de datos de un frame: tiempo real al toque, el resto al RX
+static void recibir_bytes(Conexion *c, const unsigned char *p, size_t n) {
+    Maquina *m = c->m;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char b = p[i];
+        switch (b) {
+        case '?':  reporte(m, c); continue;
+        case '!':  if (m->pl_n > 0) m->hold = 1; continue;
+        case '~':  m->hold = 0; continue;
+        case 0x18:
+            vaciar_planner(m, 0);
+            c->grbl_len = 0;
+            m->hold = 0;
+            m->ov_feed = 100;
+            responder(c, "\r\nGrbl 3.7 [FluidNC v3.7.0 (sim) '$' for help]\r\n");
+            continue;
+        case 0x85: vaciar_planner(m, 1); continue;
+        case 0x90: m->ov_feed = 100; continue;
+        case 0x91: m->ov_feed += 10; break;
+        case 0x92: m->ov_feed -= 10; break;
+        case 0x93: m->ov_feed += 1; break;
+        case 0x94: m->ov_feed -= 1; break;
+        default:
+            if (b >= 0x80) continue;
+            if (c->grbl_len < rx_grbl) {
+                c->grbl[c->grbl_len++] = (char)b;
+            } else {
+                // El gateway mandó más de lo que entra: en la máquina real esto se pierde
+                if (c->desbordes++ == 0) {
+                    printf("[SIM] M%d: desborde del RX (%d bytes): el conteo de caracteres no cierra\n",
+                           m->id, rx_grbl);
+                }
+                st_desbordes++;
+            }
+            continue;
+        }
+        // Overrides de avance: 10..200 %
+        if (m->ov_feed < 10) m->ov_feed = 10;
+        if (m->ov_feed > 200) m->ov_feed = 200;
+    }
+    procesar_rx(c);
+}
+
+// --------------------------------------------------------------------------
+// WebSocket
+// --------------------------------------------------------------------------
+static int handshake_ws(Conexion *c) {
+    c->red[c->red_len < SIM_RED_MAX ? c->red_len : SIM_RED_MAX - 1] = '\0';
+    char *fin = strstr((char *)c->red, "\r\n\r\n");
+    if (!fin) return c->red_len >= SIM_RED_MAX - 1 ? -1 : 0;
+
+    char *k = strcasestr((char *)c->red, "Sec-WebSocket-Key:");
+    if (!k || k > fin) return -1;
+    k += 18;
+    while (*k == ' ') k++;
+    char clave[96];
+    int n = 0;
+    while (k[n] && k[n] != '\r' && n < 60) {
+        clave[n] = k[n];
+        n++;
+    }
+    memcpy(clave + n, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", 36);
+
+    unsigned char h[20];
+    char acepta[32];
+    sha1((unsigned char *)clave, (size_t)n + 36, h);
+    base64(h, sizeof(h), acepta);
+
+    char r[256];
+    int len = snprintf(r, sizeof(r),
+                       "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n\r\n", acepta);
+    encolar_tx(c, r, (size_t)len);
+    // Saludo de FluidNC (texto, sin demora: lo usa el descubrimiento)
+    encolar_frame(c, 0x1, "CURRENT_ID:0", 12);
+    encolar_frame(c, 0x1, "ACTIVE_ID:0", 11);
+
+    size_t usados = (size_t)(fin + 4 - (char *)c->red);
+    memmove(c->red, c->red + usados, c->red_len - usados);
+    c->red_len -= usados;
+    c->abierta = 1;
+    return 1;
+}
+
+// Frames del cliente (siempre enmascarados). -1 = cerrar.
+static int frames_ws(Conexion *c) {
+    size_t pos = 0;
+    while (c->red_len - pos >= 2) {
+        unsigned char *f = c->red + pos;
+        size_t disp = c->red_len - pos;
+        int op = f[0] & 0x0F;
+        int mascara = (f[1] & 0x80) != 0;
+        size_t len = f[1] & 0x7F, h = 2;
+        if (len == 126) {
+            if (disp < 4) break;
+            len = ((size_t)f[2] << 8) | f[3];
+            h = 4;
+        } else if (len == 127) {
+            return -1;          // Nadie le manda 64 KB de una vez a una FluidNC
+        }
+        if (mascara) h += 4;
+        if (h + len > SIM_RED_MAX) return -1;
+        if (disp < h + len) break;
+
+        unsigned char *dato = f + h;
+        if (mascara) {
+            for (size_t i = 0; i < len; i++) dato[i] ^= f[h - 4 + (i & 3)];
+        }
+        pos += h + len;
+
+        if (op == 0x1 || op == 0x2 || op == 0x0) {
+            recibir_bytes(c, dato, len);
+        } else if (op == 0x8) {
+            encolar_frame(c, 0x8, (const char *)dato, len > 2 ? 2 : len);
+            c->cerrar_al_vaciar = 1;
+            break;
+        } else if (op == 0x9) {
+            encolar_frame(c, 0xA, (const char *)dato, len);
+        }
+    }
+    memmove(c->red, c->red + pos, c->red_len - pos);
+    c->red_len -= pos;
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+// HTTP (/upload)
+// --------------------------------------------------------------------------
+static void responder_http(Conexion *c, int codigo, const char *motivo, const char *cuerpo) {
+    char r[512];
+    int n = snprintf(r, sizeof(r),
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: application/json\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Connection: close\r\n\r\n%s",
+                     codigo, motivo, strlen(cuerpo), cuerpo);
+    encolar_tx(c, r, (size_t)n);
+    c->cerrar_al_vaciar = 1;
+}
+
+static void terminar_upload(Conexion *c) {
+    Maquina *m = c->m;
+    snprintf(m->ultimo_archivo, sizeof(m->ultimo_archivo), "%s", c->archivo[0] ? c->archivo : "sin_nombre");
+    m->ultimo_tamano = c->http_leidos;
+    st_uploads++;
+
+    char cuerpo[400];
+    snprintf(cuerpo, sizeof(cuerpo),
+             "{\"files\":[{\"name\":\"%s\",\"shortname\":\"%s\",\"size\":\"%ld\",\"datetime\":\"\"}],"
+             "\"path\":\"/\",\"total\":\"4 MB\",\"used\":\"%ld B\",\"occupation\":\"0\",\"status\":\"Ok\"}",
+             m->ultimo_archivo, m->ultimo_archivo, m->ultimo_tamano, m->ultimo_tamano);
+    responder_http(c, 200, "OK", cuerpo);
+}
+
+// Cuerpo multipart: solo interesa el filename de la primera parte
+static void cuerpo_http(Conexion *c, const unsigned char *p, size_t n) {
+    if (c->archivo[0] == '\0' && c->http_leidos < 1024) {
+        char muestra[1025];
+        size_t k = n < 1024 ? n : 1024;
+        memcpy(muestra, p, k);
+        muestra[k] = '\0';
+        char *f = strstr(muestra, "filename=\"");
+        if (f) {
+            f += 10;
+            char *fin = strchr(f, '"');
+            if (fin) snprintf(c->archivo, sizeof(c->archivo), "%.*s", (int)(fin - f), f);
+        }
+    }
+    c->http_leidos += (long)n;
+    st_subidos += (long)n;
+}
+
+static int leer_http(Conexion *c) {
+    if (!c->http_cab) {
+        c->red[c->red_len < SIM_RED_MAX ? c->red_len : SIM_RED_MAX - 1] = '\0';
+        char *fin = strstr((char *)c->red, "\r\n\r\n");
+        if (!fin) return c->red_len >= SIM_RED_MAX - 1 ? -1 : 0;
+        c->http_cab = 1;
+        c->http_inicio_ms = ahora_ms();
+
+        char *cl = strcasestr((char *)c->red, "Content-Length:");
+        c->http_largo = (cl && cl < fin) ? atol(cl + 15) : 0;
+        c->http_upload = strncmp((char *)c->red, "POST /upload", 12) == 0;
+
+        if (!c->http_upload) {
+            if (strncmp((char *)c->red, "GET / ", 6) == 0) responder_http(c, 200, "OK", "{\"sim\":\"FluidNC\"}");
+            else responder_http(c, 404, "Not Found", "{\"status\":\"not found\"}");
+            return 0;
+        }
+        if (!cl || cl > fin) {
+            responder_http(c, 411, "Length Required", "{\"status\":\"length required\"}");
+            return 0;
+        }
+        char *ex = strcasestr((char *)c->red, "Expect: 100-continue");
+        if (ex && ex < fin) encolar_tx(c, "HTTP/1.1 100 Continue\r\n\r\n", 25);
+
+        size_t usados = (size_t)(fin + 4 - (char *)c->red);
+        if (c->red_len > usados) cuerpo_http(c, c->red + usados, c->red_len - usados);
+    } else {
+        cuerpo_http(c, c->red, c->red_len);
+    }
+    c->red_len = 0;
+
+    if (c->http_leidos >= c->http_largo && c->http_listo_ms == 0) {
+        // Con -u la respuesta espera lo que habría tardado la ESP32 en grabar
+        long dur = upload_kbps > 0 ? c->http_leidos * 1000L / ((long)upload_kbps * 1024L) : 0;
+        c->http_listo_ms = c->http_inicio_ms + dur;
+        if (c->http_listo_ms <= ahora_ms()) terminar_upload(c);
+    }
+    return 0;
+}
+
+// --------------------------------------------------------------------------
+// Eventos
+// --------------------------------------------------------------------------
+static void aceptar(Escucha *e) {
+    while (1) {
+        int fd = accept4(e->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        Conexion *c = calloc(1, sizeof(Conexion));
+        if (!c) {
+            close(fd);
+            return;
+        }
+        int uno = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+        c->fd = fd;
+        c->m = e->m;
+        if (e->tipo == NODO_ESCUCHA_WS) {
+            c->tipo = NODO_WS;
+            c->sig = e->m->ws;
+            e->m->ws = c;
+            st_ws++;
+        } else {
+            c->tipo = NODO_HTTP;
+            c->sig = http_lista;
+            http_lista = c;
+            st_http++;
+        }
+        vigilar(fd, c, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+    }
+}
+
+static void atender(Conexion *c, uint32_t eventos) {
+    if (eventos & EPOLLOUT) {
+        if (vaciar_tx(c) < 0) return;
+    }
+    if (!(eventos & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) return;
+
+    while (1) {
+        if (c->red_len >= SIM_RED_MAX) {
+            cerrar_conexion(c);
+            return;
+        }
+        ssize_t n = recv(c->fd, c->red + c->red_len, SIM_RED_MAX - c->red_len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) {
+            cerrar_conexion(c);
+            return;
+        }
+        c->red_len += (size_t)n;
+
+        int r = 0;
+        if (c->tipo == NODO_HTTP) {
+            r = leer_http(c);
+        } else {
+            if (!c->abierta) r = handshake_ws(c);
+            if (r >= 0 && c->abierta) r = frames_ws(c);
+        }
+        if (r < 0) {
+            cerrar_conexion(c);
+            return;
+        }
+    }
+    vaciar_tx(c);
+}
+
+static int escuchar(Escucha *e, TipoNodo tipo, Maquina *m, const char *ip, int puerto) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int uno = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)puerto);
+    inet_pton(AF_INET, ip, &a.sin_addr);
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(fd, 64) < 0) {
+        fprintf(stderr, "[SIM] No se pudo escuchar en %s:%d: %s\n", ip, puerto, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    e->tipo = tipo;
+    e->fd = fd;
+    e->m = m;
+    vigilar(fd, e, EPOLLIN, EPOLL_CTL_ADD);
+    return 0;
+}
+
+// machine_config.json para apuntar el gateway a las máquinas simuladas
+static void escribir_config(const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        fprintf(stderr, "[SIM] No se pudo escribir %s\n", ruta);
+        return;
+    }
+    int n = n_maquinas < 10 ? n_maquinas : 10;     // MAX_MACHINES del gateway
+    fprintf(f, "{\n  \"machines\": [\n");
+    for (int i = 0; i < n; i++) {
+        Maquina *m = &maquinas[i];
+        fprintf(f, "    { \"id\": %d, \"name\": \"SIM %02d\", \"host\": \"%s:%d\", \"ws_port\": %d }%s\n",
+                m->id, m->id, m->ip, m->puerto_http, m->puerto_http + 1, i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("[SIM] %s escrito (%d maquinas)\n", ruta, n);
+}
+
+static void al_salir(int sig) {
+    (void)sig;
+    salir = 1;
+}
+
+static void uso(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [-n maquinas] [-a ip] [-p puerto] [-I] [-l ms] [-j ms] [-r bytes]\n"
+            "          [-e %%error] [-u KB/s] [-s semilla] [-c machine_config.json]\n"
+            "  -n  Máquinas simuladas (hasta %d, defecto 10)\n"
+            "  -a  IP donde escuchar (defecto 127.0.0.1)\n"
+            "  -p  Puerto HTTP de la primera máquina; WebSocket = HTTP + 1 (defecto 8080)\n"
+            "  -I  Una IP por máquina a partir de -a, todas con los mismos puertos\n"
+            "  -l  Latencia de ida y vuelta de las respuestas (ms)\n"
+            "  -j  Jitter de la latencia (+/- ms)\n"
+            "  -r  Buffer RX de Grbl (defecto %d bytes)\n"
+            "  -e  Porcentaje de líneas G-code que responden error:20\n"
+            "  -u  Velocidad de grabación de /upload (KB/s, 0 = sin límite)\n"
+            "  -c  Escribe un machine_config.json que apunta a las simuladas\n",
+            prog, SIM_MAX_MAQUINAS, SIM_RX_DEFECTO);
+}
+
+int main(int argc, char **argv) {
+    unsigned int semilla = (unsigned int)time(NULL);
+    int opt;
+    while ((opt = getopt(argc, argv, "n:a:p:Il:j:r:e:u:s:c:h")) != -1) {
+        switch (opt) {
+        case 'n': n_maquinas = atoi(optarg); break;
+        case 'a': snprintf(ip_base, sizeof(ip_base), "%s", optarg); break;
+        case 'p': puerto_base = atoi(optarg); break;
+        case 'I': una_ip_por_maquina = 1; break;
+        case 'l': latencia_ms = atoi(optarg); break;
+        case 'j': jitter_ms = atoi(optarg); break;
+        case 'r': rx_grbl = atoi(optarg); break;
+        case 'e': tasa_error = atof(optarg); break;
+        case 'u': upload_kbps = atoi(optarg); break;
+        case 's': semilla = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case 'c': archivo_config = optarg; break;
+        default: uso(argv[0]); return 1;
+        }
+    }
+    if (n_maquinas < 1 || n_maquinas > SIM_MAX_MAQUINAS || rx_grbl < 16 || rx_grbl > SIM_RX_MAX ||
+        latencia_ms < 0 || jitter_ms < 0 || (!una_ip_por_maquina && puerto_base + 2 * n_maquinas > 65535)) {
+        uso(argv[0]);
+        return 1;
+    }
+    srand(semilla);
+    setvbuf(stdout, NULL, _IOLBF, 0);      // Se suele mirar con tee o redirigido
+    signal(SIGINT, al_salir);
+    signal(SIGTERM, al_salir);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Dos sockets de escucha por máquina más sus conexiones
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    ep = epoll_create1(EPOLL_CLOEXEC);
+    maquinas = calloc((size_t)n_maquinas, sizeof(Maquina));
+    if (ep < 0 || !maquinas) return 1;
+
+    struct in_addr base;
+    if (inet_pton(AF_INET, ip_base, &base) != 1) {
+        uso(argv[0]);
+        return 1;
+    }
+    long t0 = ahora_ms();
+    for (int i = 0; i < n_maquinas; i++) {
+        Maquina *m = &maquinas[i];
+        m->id = i + 1;
+        m->absoluto = 1;
+        m->ov_feed = 100;
+        m->t_ms = t0;
+        struct in_addr a = base;
+        if (una_ip_por_maquina) a.s_addr = htonl(ntohl(base.s_addr) + (uint32_t)i);
+        inet_ntop(AF_INET, &a, m->ip, sizeof(m->ip));
+        m->puerto_http = una_ip_por_maquina ? puerto_base : puerto_base + 2 * i;
+        if (escuchar(&m->escucha_http, NODO_ESCUCHA_HTTP, m, m->ip, m->puerto_http) < 0 ||
+            escuchar(&m->escucha_ws, NODO_ESCUCHA_WS, m, m->ip, m->puerto_http + 1) < 0) {
+            return 1;
+        }
+    }
+    printf("[SIM] %d maquinas FluidNC en %s:%d%s (latencia %d+/-%d ms, RX %d, error %.2f%%)\n",
+           n_maquinas, ip_base, puerto_base, una_ip_por_maquina ? " (una IP por maquina)" : "",
+           latencia_ms, jitter_ms, rx_grbl, tasa_error);
+    if (archivo_config) escribir_config(archivo_config);
+
+    long ultimo_stats = t0;
+    long lineas_antes = 0, reportes_antes = 0, subidos_antes = 0;
+    struct epoll_event ev[256];
+    while (!salir) {
+        // 1 ms alcanza para que la latencia simulada sea pareja
+        int n = epoll_wait(ep, ev, 256, 1);
+        for (int i = 0; i < n; i++) {
+            TipoNodo tipo = *(TipoNodo *)ev[i].data.ptr;
+            if (tipo == NODO_ESCUCHA_WS || tipo == NODO_ESCUCHA_HTTP) aceptar(ev[i].data.ptr);
+            else atender(ev[i].data.ptr, ev[i].events);
+        }
+
+        long ahora = ahora_ms();
+        for (int i = 0; i < n_maquinas; i++) {
+            Maquina *m = &maquinas[i];
+            mover(m, ahora);
+            Conexion *c = m->ws;
+            while (c) {
+                Conexion *sig = c->sig;
+                procesar_rx(c);             // El planner pudo haber hecho lugar
+                despachar_salidas(c, ahora);
+                c = sig;
+            }
+        }
+        Conexion *c = http_lista;
+        while (c) {
+            Conexion *sig = c->sig;
+            if (c->http_listo_ms > 0 && !c->cerrar_al_vaciar && ahora >= c->http_listo_ms) {
+                terminar_upload(c);
+                vaciar_tx(c);
+            }
+            c = sig;
+        }
+
+        if (ahora - ultimo_stats >= SIM_STATS_MS) {
+            double s = (ahora - ultimo_stats) / 1000.0;
+            printf("[SIM] ws %d, http %d | %.0f lineas/s, %.0f reportes/s, %.1f KB/s subidos | "
+                   "%ld errores, %ld uploads, %ld desbordes RX\n",
+                   st_ws, st_http, (st_lineas - lineas_antes) / s, (st_reportes - reportes_antes) / s,
+                   (st_subidos - subidos_antes) / 1024.0 / s, st_errores, st_uploads, st_desbordes);
+            fflush(stdout);
+            lineas_antes = st_lineas;
+            reportes_antes = st_reportes;
+            subidos_antes = st_subidos;
+            ultimo_stats = ahora;
+        }
+    }
+
+    printf("[SIM] Fin: %ld lineas, %ld reportes, %ld uploads (%.1f KB), %ld desbordes RX\n",
+           st_lineas, st_reportes, st_uploads, st_subidos / 1024.0, st_desbordes);
+    return 0;
+}
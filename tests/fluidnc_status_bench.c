@@ -0,0 +1,62 @@
+// Rendimiento del parser de reportes de estado contra el parseo anterior
+// (strstr + sscanf, que solo sacaba MPos).
+//   ./fluidnc_status_bench [reportes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "websocket/fluidnc_status.h"
+
+static const char *reportes[] = {
+    "<Idle|MPos:0.000,0.000,0.000|FS:0,0|WCO:0.000,0.000,0.000>",
+    "<Run|MPos:152.340,-20.125,-3.250|Bf:15,128|FS:1500,18000|Ov:100,100,100>",
+    "<Run|MPos:152.870,-20.125,-3.250|Bf:12,97|FS:1500,18000|Ln:4312>",
+    "<Hold:1|MPos:153.001,-20.125,-3.250|Bf:14,128|FS:320,18000|Pn:P|A:SF>",
+    "<Jog|MPos:10.500,250.000,0.000|Bf:14,127|FS:7000,0>",
+};
+#define N_REPORTES ((int)(sizeof(reportes) / sizeof(reportes[0])))
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Lo que hacía fluidnc_parse_mpos antes, como referencia
+static int parse_anterior(const char *r, float *x, float *y, float *z) {
+    const char *p = strstr(r, "MPos:");
+    return p && sscanf(p + 5, "%f,%f,%f", x, y, z) == 3;
+}
+
+int main(int argc, char **argv) {
+    long n = (argc > 1) ? atol(argv[1]) : 2000000;
+    size_t bytes = 0;
+    for (long i = 0; i < n; i++) bytes += strlen(reportes[i % N_REPORTES]);
+
+    FluidncStatus st;
+    FluidncWcoCache cache = { 0 };
+    volatile float sumidero = 0;
+    long validos = 0;
+
+    double t0 = ahora_s();
+    for (long i = 0; i < n; i++) {
+        validos += fluidnc_parse_status(reportes[i % N_REPORTES], &st, &cache);
+        sumidero += st.mpos[0];
+    }
+    double t_nuevo = ahora_s() - t0;
+
+    t0 = ahora_s();
+    for (long i = 0; i < n; i++) {
+        float x, y, z;
+        if (parse_anterior(reportes[i % N_REPORTES], &x, &y, &z)) sumidero += x;
+    }
+    double t_anterior = ahora_s() - t0;
+
+    printf("[BENCH] %ld reportes (%ld validos), %.1f MB\n", n, validos, bytes / 1e6);
+    printf("[BENCH] fluidnc_parse_status: %6.1f ns/reporte  %7.1f MB/s  (todos los campos)\n",
+           t_nuevo * 1e9 / n, bytes / 1e6 / t_nuevo);
+    printf("[BENCH] strstr + sscanf:      %6.1f ns/reporte  %7.1f MB/s  (solo MPos)\n",
+           t_anterior * 1e9 / n, bytes / 1e6 / t_anterior);
+    return validos == n ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Fuzz del parser de reportes de estado (src/websocket/fluidnc_status.c).
+//
+// Con libFuzzer:
+//   clang -g -O1 -fsanitize=fuzzer,address,undefined -DFUZZ_LIBFUZZER -Isrc
+//         tests/fluidnc_status_fuzz.c src/websocket/fluidnc_status.c
+// Sin libFuzzer (ctest): muta un corpus de reportes reales con un PRNG fijo.
+//   ./fluidnc_status_fuzz [iteraciones]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "websocket/fluidnc_status.h"
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[FUZZ] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+// Invariantes que tienen que valer para cualquier entrada
+static void probar(const uint8_t *data, size_t size, FluidncWcoCache *cache) {
+    // Copia exacta terminada en '\0': ASan detecta cualquier lectura de más
+    char *linea = malloc(size + 1);
+    if (!linea) return;
+    memcpy(linea, data, size);
+    linea[size] = '\0';
+
+    FluidncStatus st;
+    int r = fluidnc_parse_status(linea, &st, cache);
+    VERIFICAR(r == 0 || r == 1, "retorno %d", r);
+    if (r == 1) {
+        VERIFICAR(memchr(st.estado, '\0', sizeof(st.estado)) != NULL, "estado sin terminar");
+        VERIFICAR(st.ejes >= 0 && st.ejes <= FLUIDNC_MAX_EJES, "ejes %d", st.ejes);
+        VERIFICAR(st.linea >= 0, "linea %ld", st.linea);
+        VERIFICAR(st.bf_planner >= 0 && st.bf_rx >= 0, "bf %d,%d", st.bf_planner, st.bf_rx);
+        VERIFICAR(st.subestado >= -1, "subestado %d", st.subestado);
+        fluidnc_estado_en_movimiento(&st);
+    }
+    if (cache) {
+        VERIFICAR(cache->ejes >= 0 && cache->ejes <= FLUIDNC_MAX_EJES, "cache ejes %d", cache->ejes);
+    }
+    free(linea);
+}
+
+#ifdef FUZZ_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static FluidncWcoCache cache;
+    probar(data, size, &cache);
+    return 0;
+}
+#else
+
+static const char *corpus[] = {
+    "<Idle|MPos:0.000,0.000,0.000|FS:0,0>",
+    "<Run|MPos:10.000,20.000,-3.250|Bf:15,128|FS:500,8000|Ov:100,100,100|WCO:1.000,2.000,-5.000>",
+    "<Hold:1|WPos:9.000,18.000,1.750|Bf:2,40|FS:0,0|Pn:XZP|A:SF>",
+    "<Jog|MPos:1.5,2.5,3.5,4.5,5.5,6.5|F:3000|Ln:1234>",
+    "<Alarm|MPos:0.000,0.000,0.000|Pn:XYZ>",
+    "<Door:2|WPos:-1.000,-2.000,-3.000|Ov:120,50,80|A:CM>",
+    "<Check|MPos:0,0,0|Ln:99999999999999999999>",
+    "<Sleep>",
+    "<Idle|WCO:0.000,0.000,0.000>",
+    "<|MPos:1,2,3>",
+    "<Run|MPos:1,2>",
+    "<Run|MPos:,,,|FS:,|Ov:a,b,c|Bf:-1,-2>",
+};
+
+// Generador fijo: la misma corrida siempre prueba las mismas entradas
+static uint32_t semilla = 0x2545F491u;
+static uint32_t azar(void) {
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 17;
+    semilla ^= semilla << 5;
+    return semilla;
+}
+
+static const char alfabeto[] = "<>|:,.-+0123456789MPosWCOFSOvPnBfLnAXYZHRDIdleRunHoldJog \t\r\n\xff\x80";
+
+static size_t mutar(uint8_t *buf, size_t len, size_t cap) {
+    int cambios = 1 + (int)(azar() % 6);
+    for (int k = 0; k < cambios; k++) {
+        size_t pos = len ? azar() % len : 0;
+        switch (azar() % 6) {
+        case 0:     // Cambiar un byte por uno "interesante"
+            if (len) buf[pos] = (uint8_t)alfabeto[azar() % (sizeof(alfabeto) - 1)];
+            break;
+        case 1:     // Byte cualquiera
+            if (len) buf[pos] = (uint8_t)azar();
+            break;
+        case 2:     // Insertar
+            if (len < cap) {
+                memmove(buf + pos + 1, buf + pos, len - pos);
+                buf[pos] = (uint8_t)alfabeto[azar() % (sizeof(alfabeto) - 1)];
+                len++;
+            }
+            break;
+        case 3:     // Borrar
+            if (len) {
+                memmove(buf + pos, buf + pos + 1, len - pos - 1);
+                len--;
+            }
+            break;
+        case 4:     // Cortar
+            len = pos;
+            break;
+        default: {  // Pegar un pedazo de otro reporte del corpus
+            const char *otro = corpus[azar() % (sizeof(corpus) / sizeof(corpus[0]))];
+            size_t n = strlen(otro);
+            size_t desde = azar() % n;
+            size_t cuanto = 1 + azar() % (n - desde);
+            if (pos + cuanto > cap) cuanto = cap - pos;
+            memcpy(buf + pos, otro + desde, cuanto);
+            if (pos + cuanto > len) len = pos + cuanto;
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+// Resultados conocidos de los reportes del corpus
+static void casos_conocidos(void) {
+    FluidncStatus st;
+    FluidncWcoCache cache = { 0 };
+
+    VERIFICAR(fluidnc_parse_status(corpus[1], &st, &cache) == 1, "corpus[1]");
+    VERIFICAR(st.codigo == FLUIDNC_RUN && st.subestado == -1, "Run");
+    VERIFICAR(st.ejes == 3 && fabsf(st.mpos[2] + 3.25f) < 1e-4f, "MPos");
+    VERIFICAR(fabsf(st.wpos[0] - 9.0f) < 1e-4f && fabsf(st.wpos[2] - 1.75f) < 1e-4f, "WPos reconstruida");
+    VERIFICAR(st.bf_planner == 15 && st.bf_rx == 128, "Bf");
+    VERIFICAR(st.feed == 500.0f && st.spindle == 8000.0f, "FS");
+    VERIFICAR(st.ov_feed == 100 && st.ov_rapid == 100 && st.ov_spindle == 100, "Ov");
+    VERIFICAR(cache.valido && cache.ejes == 3, "cache WCO");
+
+    // Sin WCO en el reporte: se usa el recordado
+    VERIFICAR(fluidnc_parse_status(corpus[2], &st, &cache) == 1, "corpus[2]");
+    VERIFICAR(st.codigo == FLUIDNC_HOLD && st.subestado == 1, "Hold:1");
+    VERIFICAR(strcmp(st.estado, "Hold:1") == 0, "estado texto");
+    VERIFICAR((st.campos & FLUIDNC_CAMPO_MPOS) && fabsf(st.mpos[0] - 10.0f) < 1e-4f, "MPos reconstruida");
+    VERIFICAR(st.pines == (FLUIDNC_PIN_X | FLUIDNC_PIN_Z | FLUIDNC_PIN_PROBE), "Pn");
+    VERIFICAR(st.accesorios == (FLUIDNC_ACC_SPINDLE_CW | FLUIDNC_ACC_FLOOD), "A");
+    VERIFICAR(fluidnc_estado_en_movimiento(&st), "Hold:1 se mueve");
+
+    VERIFICAR(fluidnc_parse_status(corpus[3], &st, NULL) == 1 && st.ejes == 6, "6 ejes");
+    VERIFICAR(st.linea == 1234 && st.feed == 3000.0f, "Ln/F");
+    VERIFICAR(!(st.campos & FLUIDNC_CAMPO_WPOS), "sin WCO no hay WPos");
+
+    VERIFICAR(fluidnc_parse_status(corpus[7], &st, NULL) == 1 && st.codigo == FLUIDNC_SLEEP, "Sleep");
+    VERIFICAR(fluidnc_parse_status(corpus[9], &st, NULL) == 0, "estado vacío");
+    VERIFICAR(fluidnc_parse_status("<Idle|MPos:1,2,3", &st, NULL) == 0, "sin '>'");
+    VERIFICAR(fluidnc_parse_status("ok", &st, NULL) == 0, "no es reporte");
+}
+
+int main(int argc, char **argv) {
+    long iteraciones = (argc > 1) ? atol(argv[1]) : 200000;
+    casos_conocidos();
+
+    uint8_t buf[512];
+    FluidncWcoCache cache = { 0 };
+    for (long i = 0; i < iteraciones; i++) {
+        const char *base = corpus[azar() % (sizeof(corpus) / sizeof(corpus[0]))];
+        size_t len = strlen(base);
+        memcpy(buf, base, len);
+        len = mutar(buf, len, sizeof(buf));
+        probar(buf, len, (i & 1) ? &cache : NULL);
+    }
+
+    printf("[FUZZ] %ld entradas, %d fallas\n", iteraciones, fallas);
+    return fallas ? 1 : 0;
+}
+#endif
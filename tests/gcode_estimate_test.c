@@ -0,0 +1,165 @@
+// Prueba del programa de reanudación (gcode_crear_reanudacion): modos que
+// vuelven a escribirse antes de la cola (G2 modal, G18, G93, G91.1) y
+// numeración con líneas más largas que cualquier buffer fijo.
+//   ./gcode_estimate_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "scheduler/gcode_estimate.h"
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[GCODE] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static char origen[] = "/tmp/gcode_test_XXXXXX";
+static char destino[] = "/tmp/gcode_test_out_XXXXXX";
+
+static void escribir(const char *texto) {
+    FILE *f = fopen(origen, "w");
+    fputs(texto, f);
+    fclose(f);
+}
+
+// Lee el archivo generado entero (liberar con free)
+static char *leer_salida(void) {
+    FILE *f = fopen(destino, "r");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *s = malloc(n + 1);
+    s[fread(s, 1, n, f)] = '\0';
+    fclose(f);
+    return s;
+}
+
+// Línea 'n' (desde 1) del texto, sin el '\n'
+static void linea_de(const char *texto, int n, char *out, size_t cap) {
+    const char *p = texto;
+    for (int i = 1; i < n && p; i++) {
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+    out[0] = '\0';
+    if (!p) return;
+    size_t len = strcspn(p, "\n");
+    if (len >= cap) len = cap - 1;
+    memcpy(out, p, len);
+    out[len] = '\0';
+}
+
+// Arco en XZ: la cola sigue con "X.. Z.. I.. K.." sin repetir G2 ni G18
+static void arco_modal(void) {
+    printf("[GCODE] G18 G2 modal\n");
+    escribir("G21 G90\n"
+             "G18 G91.1\n"
+             "G0 X0 Z0\n"
+             "G1 Z-1 F300\n"
+             "G2 X10 Z-1 I5 K0 F200\n"
+             "X20 Z-1 I5 K0\n"
+             "X30 Z-1 I5 K0\n");
+    int pre = gcode_crear_reanudacion(origen, 6, destino);
+    VERIFICAR(pre > 0, "no se generó (%d)", pre);
+    char *out = leer_salida();
+    if (!out) return;
+
+    char modos[128], primera[128];
+    linea_de(out, pre, modos, sizeof(modos));
+    linea_de(out, pre + 1, primera, sizeof(primera));
+    VERIFICAR(strstr(modos, "G18") != NULL, "falta el plano: \"%s\"", modos);
+    VERIFICAR(strstr(modos, "G91.1") != NULL, "falta G91.1: \"%s\"", modos);
+    VERIFICAR(strstr(modos, "F200.0") != NULL, "falta el feed: \"%s\"", modos);
+    // El modo de movimiento va último: una palabra G1 después lo pisaría
+    size_t len = strlen(modos);
+    VERIFICAR(len >= 3 && strcmp(modos + len - 3, " G2") == 0, "no termina en G2: \"%s\"", modos);
+    VERIFICAR(strcmp(primera, "X20 Z-1 I5 K0") == 0, "la cola empieza con \"%s\"", primera);
+    VERIFICAR(strstr(out, "G0 X10.000 Y0.000") != NULL, "no va al punto del retome");
+    VERIFICAR(strstr(out, "G90 G91") == NULL, "G91.1 se tomó como G91");
+    free(out);
+}
+
+// Tiempo inverso: el preámbulo baja en G94 y recién después se pone G93
+static void tiempo_inverso(void) {
+    printf("[GCODE] G93\n");
+    escribir("G21 G90\n"
+             "G93 G1 X5 Y5 F10\n"
+             "X6 Y6 F12\n");
+    int pre = gcode_crear_reanudacion(origen, 3, destino);
+    char *out = leer_salida();
+    if (!out) {
+        VERIFICAR(0, "no se generó");
+        return;
+    }
+    char modos[128];
+    linea_de(out, pre, modos, sizeof(modos));
+    VERIFICAR(strstr(modos, "G93") != NULL && strstr(modos, " F") == NULL,
+              "modos con G93: \"%s\"", modos);
+    VERIFICAR(strstr(out, "G21 G90 G94") != NULL, "el preámbulo no baja en G94");
+    VERIFICAR(strstr(out, "F10.0") == NULL, "tomó el F de tiempo inverso como feed");
+    free(out);
+}
+
+// Un comentario de 600 caracteres sigue siendo una sola línea
+static void lineas_largas(void) {
+    printf("[GCODE] líneas largas\n");
+    char *texto = malloc(2048);
+    char comentario[601];
+    memset(comentario, 'x', 600);
+    comentario[600] = '\0';
+    snprintf(texto, 2048,
+             "G21 G90\n"
+             "(%s)\n"
+             "G1 X1 F100 ; %s\n"
+             "G1 X2\n"
+             "G1 X3\n", comentario, comentario);
+    escribir(texto);
+    free(texto);
+
+    int lineas = 0;
+    gcode_estimar_segundos(origen, &lineas);
+    VERIFICAR(lineas == 5, "estimación: %d líneas, esperado 5", lineas);
+
+    int n = 0;
+    GcodeSegmento *s = gcode_trayecto_cargar(origen, &n);
+    VERIFICAR(s && n == 5, "trayecto: %d líneas, esperado 5", n);
+    if (s) VERIFICAR(s[3].modo == 1 && s[3].fin[0] == 2.0f, "línea 4 mal ubicada");
+    free(s);
+
+    int pre = gcode_crear_reanudacion(origen, 4, destino);
+    char *out = leer_salida();
+    if (!out) {
+        VERIFICAR(0, "no se generó");
+        return;
+    }
+    char primera[128];
+    linea_de(out, pre + 1, primera, sizeof(primera));
+    VERIFICAR(strcmp(primera, "G1 X2") == 0, "la cola empieza con \"%s\"", primera);
+    VERIFICAR(strstr(out, "G0 X1.000") != NULL, "no quedó en X1");
+    free(out);
+
+    VERIFICAR(gcode_crear_reanudacion(origen, 7, destino) == -1, "retomó más allá del final");
+}
+
+int main(void) {
+    int fd1 = mkstemp(origen);
+    int fd2 = mkstemp(destino);
+    if (fd1 < 0 || fd2 < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd1);
+    close(fd2);
+
+    arco_modal();
+    tiempo_inverso();
+    lineas_largas();
+
+    unlink(origen);
+    unlink(destino);
+    printf("[GCODE] %d fallas\n", fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+// Prueba del heap de LVGL (src/mem/heap_pool.c): alineación, bloques que no
+// se pisan, realloc entre clases y hacia la arena, vuelta a cero de la
+// telemetría, slabs devueltos al vaciarse y costo contra malloc con la
+// mezcla de tamaños de una UI (muchos de 16-128, alguno grande).
+//   ./heap_pool_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "mem/heap_pool.h"
+
+#define N_BLOQUES   20000
+#define VUELTAS     2000000
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[HEAP] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned semilla = 12345;
+static unsigned azar(void) {
+    semilla = semilla * 1103515245u + 12345u;
+    return semilla >> 8;
+}
+
+// Mezcla de tamaños típica de LVGL: objetos y estilos chicos, buffers grandes
+static size_t tam_azar(void) {
+    unsigned r = azar() % 100;
+    if (r < 60) return 8 + azar() % 56;
+    if (r < 90) return 64 + azar() % 200;
+    if (r < 98) return 256 + azar() % 256;
+    return 600 + azar() % 8000;
+}
+
+static void *bloques[N_BLOQUES];
+static size_t tams[N_BLOQUES];
+
+int main(void) {
+    HeapStats s;
+
+    // Alineación y contenido: cada bloque lleno con su propio patrón
+    for (int i = 0; i < N_BLOQUES; i++) {
+        tams[i] = tam_azar();
+        bloques[i] = heap_alloc(tams[i]);
+        VERIFICAR(bloques[i] != NULL, "alloc %zu", tams[i]);
+        VERIFICAR(((uintptr_t)bloques[i] % sizeof(void *)) == 0, "alineación %p", bloques[i]);
+        memset(bloques[i], i & 0xFF, tams[i]);
+    }
+    heap_stats(&s);
+    VERIFICAR(s.allocs == N_BLOQUES, "allocs %lu", s.allocs);
+    VERIFICAR(s.slabs > 0 && s.arena > 0, "slabs %d arena %zu", s.slabs, s.arena);
+    VERIFICAR(s.pico == s.usado, "pico %zu usado %zu", s.pico, s.usado);
+    printf("[HEAP] %d bloques: usado %zu KB, reservado %zu KB (%d slabs), frag %d%%\n",
+           N_BLOQUES, s.usado / 1024, s.reservado / 1024, s.slabs, s.frag_pct);
+
+    // Liberar la mitad salteada y verificar que la otra mitad quedó intacta
+    for (int i = 0; i < N_BLOQUES; i += 2) heap_free(bloques[i]);
+    for (int i = 1; i < N_BLOQUES; i += 2) {
+        const unsigned char *b = bloques[i];
+        int ok = 1;
+        for (size_t k = 0; k < tams[i]; k++) ok &= (b[k] == (i & 0xFF));
+        VERIFICAR(ok, "bloque %d pisado", i);
+    }
+
+    // Realloc: crece de clase, pasa a la arena y vuelve, sin perder datos
+    char *p = heap_alloc(20);
+    strcpy(p, "posicion X12.500");
+    p = heap_realloc(p, 100);
+    VERIFICAR(strcmp(p, "posicion X12.500") == 0, "realloc 20->100");
+    p = heap_realloc(p, 5000);
+    VERIFICAR(strcmp(p, "posicion X12.500") == 0, "realloc 100->5000");
+    p = heap_realloc(p, 9000);
+    VERIFICAR(strcmp(p, "posicion X12.500") == 0, "realloc arena->arena");
+    p = heap_realloc(p, 24);
+    VERIFICAR(strcmp(p, "posicion X12.500") == 0, "realloc 9000->24");
+    void *q = heap_realloc(p, 30);
+    VERIFICAR(q == p, "realloc dentro de la misma clase no mueve");
+    heap_free(q);
+
+    // Todo liberado: la telemetría vuelve a cero y los slabs vacíos se sueltan
+    for (int i = 1; i < N_BLOQUES; i += 2) heap_free(bloques[i]);
+    heap_stats(&s);
+    VERIFICAR(s.usado == 0 && s.arena == 0, "usado %zu arena %zu", s.usado, s.arena);
+    VERIFICAR(s.allocs == s.frees, "allocs %lu frees %lu", s.allocs, s.frees);
+    VERIFICAR(s.slabs <= HEAP_CLASES, "quedan %d slabs (máximo uno por clase)", s.slabs);
+    for (int c = 0; c < HEAP_CLASES; c++) VERIFICAR(s.bloques[c] == 0, "clase %zu: %lu vivos", heap_clase_tam(c), s.bloques[c]);
+
+    // Conteo por frame
+    heap_frame_marcar();
+    for (int i = 0; i < 7; i++) heap_free(heap_alloc(40));
+    heap_frame_marcar();
+    heap_stats(&s);
+    VERIFICAR(s.allocs_frame == 7, "allocs_frame %lu", s.allocs_frame);
+
+    // Costo: pares alloc/free al azar sobre un conjunto vivo, contra malloc
+    static void *vivos[1024];
+    memset(vivos, 0, sizeof(vivos));
+    semilla = 777;
+    double t0 = ahora_s();
+    for (int i = 0; i < VUELTAS; i++) {
+        int k = azar() % 1024;
+        heap_free(vivos[k]);
+        vivos[k] = heap_alloc(tam_azar());
+    }
+    double t_heap = ahora_s() - t0;
+    for (int k = 0; k < 1024; k++) heap_free(vivos[k]);
+
+    memset(vivos, 0, sizeof(vivos));
+    semilla = 777;
+    t0 = ahora_s();
+    for (int i = 0; i < VUELTAS; i++) {
+        int k = azar() % 1024;
+        free(vivos[k]);
+        vivos[k] = malloc(tam_azar());
+    }
+    double t_malloc = ahora_s() - t0;
+    for (int k = 0; k < 1024; k++) free(vivos[k]);
+
+    printf("[HEAP] alloc+free: heap_pool %.0f ns, malloc %.0f ns, %d fallas\n",
+           t_heap * 1e9 / VUELTAS, t_malloc * 1e9 / VUELTAS, fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+// Prueba del planificador (src/scheduler/job_scheduler.c): secuencias de
+// estado de una máquina con un trabajo despachado, tick por tick (OFFLINE,
+// alarmas, resets y fines limpios). Incluye el
+// .c para llegar a tick(); el pool, la nube y la configuración son stubs, el
+// almacén de trabajos es el de verdad (en un directorio temporal).
+//   ./job_scheduler_test
+
+#include "scheduler/job_scheduler.c"
+
+SystemState global_state;
+pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int despachos = 0;
+static unsigned int ev_terminados = 0, ev_cortes = 0;     // Lo que contaría el pool
+
+// --- Stubs ---
+void logger_log(const char *tag, const char *msg) { printf("  [%s] %s\n", tag, msg); }
+void logger_log_maquina(const char *tag, int maquina, const char *msg) { (void)maquina; logger_log(tag, msg); }
+void order_sync_get(OrdenesSnapshot *out) { memset(out, 0, sizeof(*out)); }
+unsigned int order_sync_version(void) { return 0; }
+const MachinesConfigList *config_acquire(void) { return NULL; }
+void config_release(const MachinesConfigList *c) { (void)c; }
+const MachineConfig *config_find(const MachinesConfigList *c, int id) { (void)c; (void)id; return NULL; }
+int upload_file_to_sd(const char *ip, const char *local, const char *sd) { (void)ip; (void)local; (void)sd; return 0; }
+int ws_pool_conectada(int id) { (void)id; return 1; }
+int ws_pool_stream_iniciar(int id, const char *ruta) { (void)id; (void)ruta; despachos++; return 0; }
+int ws_pool_stream_progreso(int id, int *linea, int *en_vuelo) { (void)id; (void)linea; (void)en_vuelo; return 0; }
+void ws_pool_eventos(int id, unsigned int *terminados, unsigned int *cortes) {
+    (void)id;
+    *terminados = ev_terminados;
+    *cortes = ev_cortes;
+}
+int ws_pool_ip(int id, char *ip, size_t cap) { snprintf(ip, cap, "10.0.0.%d", id); return 1; }
+WsResultado ws_pool_comando(int id, const char *linea, int timeout_ms, WsRespuesta *r) {
+    (void)id; (void)linea; (void)timeout_ms;
+    memset(r, 0, sizeof(*r));
+    despachos++;
+    return WS_RES_OK;
+}
+
+// --- Ayudas ---
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[SCHED] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static void reporta(int id, int activa, const char *estado) {
+    MaquinaData *m = &global_state.maquinas[id - 1];
+    m->id = id;
+    m->activa = activa;
+    snprintf(m->estado, sizeof(m->estado), "%s", estado);
+    tick();
+}
+
+static Job *job(int job_id) {
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) if (jobs[i].id == job_id) return &jobs[i];
+    return NULL;
+}
+
+static void limpiar(void) {
+    memset(jobs, 0, sizeof(jobs));
+    memset(&global_state, 0, sizeof(global_state));
+    for (int i = 0; i < MAX_MAQUINAS; i++) {
+        memset(&maq[i], 0, sizeof(maq[i]));
+        maq[i].job_idx = -1;
+    }
+    despachos = 0;
+    ev_terminados = ev_cortes = 0;
+}
+
+// Run -> OFFLINE -> Idle: se cortó la luz a mitad de pieza, no se acredita
+static void offline_y_vuelve_quieta(void) {
+    printf("[SCHED] Run -> OFFLINE -> Idle\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 2, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->estado == JOB_CORRIENDO && despachos == 1, "no se despachó");
+    global_state.maquinas[0].linea = 120;
+    reporta(1, 1, "Run");
+    reporta(1, 0, "OFFLINE");
+    reporta(1, 0, "OFFLINE");
+    VERIFICAR(job(id)->estado == JOB_CORRIENDO, "OFFLINE cambió el trabajo (%d)", job(id)->estado);
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->completadas == 0, "acreditó %d piezas", job(id)->completadas);
+    VERIFICAR(job(id)->estado == JOB_INTERRUMPIDO, "estado %d, esperado interrumpido", job(id)->estado);
+    VERIFICAR(job(id)->linea == 120, "perdió la línea (%d)", job(id)->linea);
+    reporta(1, 1, "Idle");
+    VERIFICAR(despachos == 1, "mandó la pieza siguiente");
+}
+
+// Run -> OFFLINE -> Run -> Idle: solo se perdió el Wi-Fi, la pieza cuenta
+static void offline_y_sigue(void) {
+    printf("[SCHED] Run -> OFFLINE -> Run -> Idle\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 2, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    reporta(1, 1, "Run");
+    reporta(1, 0, "OFFLINE");
+    reporta(1, 1, "Run");
+    ev_terminados++;            // "file job succeeded"
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->completadas == 1, "completadas %d, esperado 1", job(id)->completadas);
+    VERIFICAR(despachos == 2, "no mandó la pieza siguiente (%d)", despachos);
+}
+
+// Despachado y OFFLINE antes de arrancar: el plazo de arranque sigue corriendo
+static void offline_sin_arrancar(void) {
+    printf("[SCHED] despacho -> OFFLINE sin arrancar\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 1, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    reporta(1, 0, "OFFLINE");
+    VERIFICAR(!maq[0].visto_trabajando, "OFFLINE contó como trabajando");
+    maq[0].t_despacho -= SCHED_TIMEOUT_ARRANQUE + 1;
+    reporta(1, 0, "OFFLINE");
+    VERIFICAR(job(id)->estado == JOB_EN_COLA, "estado %d, esperado en cola", job(id)->estado);
+    VERIFICAR(job(id)->completadas == 0, "acreditó una pieza");
+}
+
+// Run -> Alarm -> $X -> Idle: la alarma cortó la pieza, no se acredita
+static void alarma_y_desbloqueo(void) {
+    printf("[SCHED] Run -> Alarm -> Idle\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 2, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    reporta(1, 1, "Run");
+    ev_cortes++;
+    reporta(1, 1, "Alarm");
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->completadas == 0, "acreditó %d piezas", job(id)->completadas);
+    VERIFICAR(job(id)->estado == JOB_INTERRUMPIDO, "estado %d, esperado interrumpido", job(id)->estado);
+    VERIFICAR(despachos == 1, "mandó la pieza siguiente");
+}
+
+// La alarma pasó entre dos ticks: solo la vio el pool
+static void alarma_entre_ticks(void) {
+    printf("[SCHED] Run -> (Alarm sin tick) -> Idle\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 1, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    reporta(1, 1, "Run");
+    ev_cortes++;
+    ev_terminados++;            // Aunque después se haya visto un fin
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->estado == JOB_INTERRUMPIDO && job(id)->completadas == 0, "acreditó tras una alarma");
+}
+
+// Reset a mitad de stream: Idle sin aviso de fin
+static void idle_sin_fin(void) {
+    printf("[SCHED] Run -> Idle sin fin de programa\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 1, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    reporta(1, 1, "Run");
+    reporta(1, 1, "Idle");
+    VERIFICAR(job(id)->estado == JOB_INTERRUMPIDO && job(id)->completadas == 0, "acreditó sin fin de programa");
+}
+
+// Camino feliz: dos piezas limpias y el trabajo termina
+static void dos_piezas(void) {
+    printf("[SCHED] dos piezas limpias\n");
+    limpiar();
+    reporta(1, 1, "Idle");
+    int id = sched_encolar("pieza.nc", 2, SCHED_PRIORIDAD_NORMAL, 1, 0);
+    reporta(1, 1, "Idle");
+    for (int k = 0; k < 2; k++) {
+        reporta(1, 1, "Run");
+        ev_terminados++;
+        reporta(1, 1, "Idle");
+    }
+    VERIFICAR(job(id)->completadas == 2 && job(id)->estado == JOB_TERMINADO,
+              "completadas %d estado %d", job(id)->completadas, job(id)->estado);
+}
+
+// Un ID de máquina fuera de rango no indexa el arreglo de máquinas
+static void backlog_fuera_de_rango(void) {
+    printf("[SCHED] backlog con ID fuera de rango\n");
+    limpiar();
+    VERIFICAR(sched_backlog_segundos(0) == 0 && sched_backlog_segundos(-1) == 0 &&
+              sched_backlog_segundos(MAX_MAQUINAS + 1) == 0, "backlog distinto de 0");
+}
+
+int main(void) {
+    char dir[] = "/tmp/sched_test_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        perror("mkdtemp");
+        return 1;
+    }
+    restaurar_estado();
+
+    offline_y_vuelve_quieta();
+    offline_y_sigue();
+    offline_sin_arrancar();
+    alarma_y_desbloqueo();
+    alarma_entre_ticks();
+    idle_sin_fin();
+    dos_piezas();
+    backlog_fuera_de_rango();
+
+    printf("[SCHED] %d fallas\n", fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+// Prueba del anillo de la consola (src/logger/log_ring.c): vuelta completa
+// del anillo, filtro por máquina, anclaje con log_ring_mover y costo de
+// agregar (tiene que ser el mismo con el anillo vacío que lleno).
+//   ./log_ring_test
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "logger/log_ring.h"
+
+static int fallas = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { fprintf(stderr, "[LOGRING] FALLA: " __VA_ARGS__); fprintf(stderr, "\n"); fallas++; } \
+} while (0)
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    LogLinea v[16];
+    VERIFICAR(log_ring_leer(0, 0, v, 16) == 0, "anillo vacío");
+    VERIFICAR(log_ring_mover(0, 0, -3) == 0, "mover en vacío");
+
+    // Más de una vuelta: máquina 1..3 en rueda, una de cada 10 es error
+    char txt[64];
+    int total = 3 * LOG_RING_CAP + 7;
+    for (int i = 1; i <= total; i++) {
+        snprintf(txt, sizeof(txt), "linea %d\nesto no entra", i);
+        log_ring_agregar(i % 10 == 0 ? LOG_ERROR : LOG_INFO, 1 + i % 3, txt);
+    }
+    VERIFICAR(log_ring_ultimo() == (unsigned long)total, "ultimo %lu", log_ring_ultimo());
+
+    // Las últimas 16, en orden, cortadas en el '\n'
+    int n = log_ring_leer(0, 0, v, 16);
+    VERIFICAR(n == 16, "leídas %d", n);
+    for (int i = 0; i < n; i++) {
+        unsigned long s = (unsigned long)(total - 15 + i);
+        snprintf(txt, sizeof(txt), "linea %lu", s);
+        VERIFICAR(v[i].seq == s && strcmp(v[i].texto, txt) == 0, "#%d: seq %lu '%s'", i, v[i].seq, v[i].texto);
+    }
+
+    // Filtro: solo máquina 2, terminando en una secuencia anclada
+    n = log_ring_leer(2, (unsigned long)total - 100, v, 16);
+    VERIFICAR(n == 16, "filtradas %d", n);
+    for (int i = 0; i < n; i++) {
+        VERIFICAR(v[i].maquina == 2 && v[i].seq <= (unsigned long)total - 100, "filtro: seq %lu M%d", v[i].seq, v[i].maquina);
+        if (i > 0) VERIFICAR(v[i].seq == v[i - 1].seq + 3, "salto %lu -> %lu", v[i - 1].seq, v[i].seq);
+    }
+
+    // Mover: 5 líneas de la máquina 3 hacia atrás son 15 secuencias
+    unsigned long a = log_ring_mover(3, 0, 0);
+    VERIFICAR(a > 0 && (1 + a % 3) == 3, "ancla en M3: %lu", a);
+    unsigned long b = log_ring_mover(3, a, -5);
+    VERIFICAR(b == a - 15, "mover -5: %lu -> %lu", a, b);
+    VERIFICAR(log_ring_mover(3, b, 5) == a, "mover +5 vuelve");
+    // Topes: no sale del anillo
+    unsigned long viejo = log_ring_mover(0, 0, -100000);
+    VERIFICAR(viejo == (unsigned long)total - LOG_RING_CAP + 1, "tope viejo %lu", viejo);
+    VERIFICAR(log_ring_mover(0, viejo, 100000) == (unsigned long)total, "tope nuevo");
+    VERIFICAR(log_ring_mover(7, 0, 0) == 0, "máquina sin líneas");
+
+    // Costo de agregar: un millón de líneas sobre el anillo lleno
+    const int N = 1000000;
+    double t0 = ahora_s();
+    for (int i = 0; i < N; i++) log_ring_agregar(LOG_INFO, 1, "G1 X10.000 Y20.000 F1500 -> ok");
+    double ns = (ahora_s() - t0) * 1e9 / N;
+    VERIFICAR(ns < 2000, "agregar tarda %.0f ns", ns);
+
+    printf("[LOGRING] %d lineas, agregar %.0f ns, %d fallas\n", total + N, ns, fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+// Prueba de la rueda de timers (src/timer/timer_wheel.c): plazos de 0 ms a
+// varios segundos (cruzan los niveles 0, 1 y 2), refrescos y cancelaciones.
+// Ninguno puede vencer antes de lo pedido ni mucho después.
+//   ./timer_wheel_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "timer/timer_wheel.h"
+
+#define N_TIMERS   400
+#define TOLERANCIA 3 * TIMER_TICK_MS    // Tick de redondeo + despertar del hilo
+
+typedef struct {
+    TimerNodo t;
+    long armado_ms;
+    int plazo_ms;
+    long vencio_ms;
+    int veces;
+    int cancelado;
+} Caso;
+
+static Caso casos[N_TIMERS];
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static long ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void vencio(void *ctx) {
+    Caso *c = ctx;
+    pthread_mutex_lock(&mutex);
+    c->vencio_ms = ahora_ms();
+    c->veces++;
+    pthread_mutex_unlock(&mutex);
+}
+
+int main(void) {
+    pthread_t hilo;
+    pthread_create(&hilo, NULL, thread_timer_loop, NULL);
+    pthread_detach(hilo);
+    usleep(50000);
+
+    srand(1234);
+    for (int i = 0; i < N_TIMERS; i++) {
+        Caso *c = &casos[i];
+        timer_init(&c->t, vencio, c);
+        // Mitad cortos (nivel 0), mitad largos (niveles 1 y 2: > 640 ms)
+        c->plazo_ms = (i % 2) ? rand() % 600 : 700 + rand() % 2500;
+        pthread_mutex_lock(&mutex);
+        c->armado_ms = ahora_ms();
+        pthread_mutex_unlock(&mutex);
+        timer_armar(&c->t, c->plazo_ms);
+    }
+
+    // Refrescos (como un latido) y cancelaciones a mitad de camino
+    usleep(300000);
+    for (int i = 0; i < N_TIMERS; i += 4) {
+        Caso *c = &casos[i];
+        pthread_mutex_lock(&mutex);
+        int ya = c->veces;
+        pthread_mutex_unlock(&mutex);
+        if (ya) continue;
+        if (i % 8 == 0) {
+            timer_cancelar(&c->t);
+            c->cancelado = 1;
+        } else {
+            pthread_mutex_lock(&mutex);
+            c->armado_ms = ahora_ms();
+            pthread_mutex_unlock(&mutex);
+            timer_armar(&c->t, c->plazo_ms);
+        }
+    }
+
+    sleep(4);
+
+    int fallas = 0;
+    long peor = 0;
+    pthread_mutex_lock(&mutex);
+    for (int i = 0; i < N_TIMERS; i++) {
+        Caso *c = &casos[i];
+        if (c->cancelado) {
+            if (c->veces != 0) { fprintf(stderr, "[TIMER] FALLA: #%d cancelado y vencio\n", i); fallas++; }
+            continue;
+        }
+        long atraso = c->vencio_ms - (c->armado_ms + c->plazo_ms);
+        if (c->veces != 1) { fprintf(stderr, "[TIMER] FALLA: #%d vencio %d veces\n", i, c->veces); fallas++; }
+        else if (atraso < 0) { fprintf(stderr, "[TIMER] FALLA: #%d vencio %ld ms antes\n", i, -atraso); fallas++; }
+        else if (atraso > TOLERANCIA) { fprintf(stderr, "[TIMER] FALLA: #%d vencio %ld ms tarde\n", i, atraso); fallas++; }
+        if (atraso > peor) peor = atraso;
+        if (timer_pendiente(&c->t)) { fprintf(stderr, "[TIMER] FALLA: #%d sigue pendiente\n", i); fallas++; }
+    }
+    pthread_mutex_unlock(&mutex);
+
+    printf("[TIMER] %d timers, peor atraso %ld ms, %d fallas\n", N_TIMERS, peor, fallas);
+    return fallas ? 1 : 0;
+}
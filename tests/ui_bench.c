@@ -0,0 +1,266 @@
+// Tiempo por frame de la UI sin pantalla: backend offscreen (src/hal) con
+// tick manual y entrada por guion. Tres escenarios: navegación entre
+// pantallas, ráfaga de líneas en la consola y telemetría de 50 máquinas.
+// Por escenario informa render y flush (promedio, p95, máximo), píxeles y
+// bytes invalidados y allocs del heap de LVGL por frame. Para comparar 32 bpp
+// con RGB565, correrlo en un build de cada perfil (cmake -DCNC_COLOR_16=ON).
+//   ./ui_bench [-f frames] [-l limite_p95_ms]
+// Con -l sale con 1 si el p95 de algún escenario (render + flush) lo supera.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include "lvgl.h"
+#include "hal/hal.h"
+#include "mem/heap_pool.h"
+#include "mqtt/mqtt_service.h"
+#include "ui/ui.h"
+#include "ui/ui_logic.h"
+#include "ui/ui_flota.h"
+#include "ui/ui_consola.h"
+#include "ui/ui_pantallas.h"
+
+#define BENCH_FRAME_MS      33          // >= período de refresco e indev de LVGL: cada vuelta dibuja
+#define BENCH_FRAMES_MAX    20000
+#define BENCH_MAQUINAS      50
+#define BENCH_LINEAS_FRAME  200
+
+// Lo que en la aplicación define main.c
+SystemState global_state;
+pthread_mutex_t state_mutex;
+
+extern int maquina_activa_id;
+extern void ActualizarRollerMaquinas(void);
+
+typedef struct {
+    const char *nombre;
+    int n;
+    double total_ms[BENCH_FRAMES_MAX];
+    double render_ms[BENCH_FRAMES_MAX];
+    double flush_ms[BENCH_FRAMES_MAX];
+    double px;
+    unsigned long allocs;
+} Escenario;
+
+static Escenario esc;
+static int fallas = 0;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Una vuelta del loop de la UI, medida
+static void frame(void) {
+    lv_tick_inc(BENCH_FRAME_MS);
+    double t0 = ahora_ms();
+    lv_timer_handler();
+    double dt = ahora_ms() - t0;
+
+    HalFrame f;
+    hal_frame_tomar(&f);
+    HeapStats h;
+    heap_frame_marcar();
+    heap_stats(&h);
+    if (esc.n >= BENCH_FRAMES_MAX) return;
+    esc.allocs += h.allocs_frame;
+    esc.total_ms[esc.n] = dt;
+    esc.flush_ms[esc.n] = f.flush_ms;
+    esc.render_ms[esc.n] = dt - f.flush_ms;
+    esc.px += f.px_invalidados;
+    esc.n++;
+}
+
+static void escenario_empezar(const char *nombre) {
+    // Lo pendiente del escenario anterior no cuenta
+    lv_tick_inc(BENCH_FRAME_MS);
+    lv_timer_handler();
+    HalFrame f;
+    hal_frame_tomar(&f);
+    heap_frame_marcar();
+    esc.nombre = nombre;
+    esc.n = 0;
+    esc.px = 0;
+    esc.allocs = 0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void stats(double *v, int n, double *prom, double *p95, double *max) {
+    double s = 0;
+    for (int i = 0; i < n; i++) s += v[i];
+    qsort(v, n, sizeof(double), cmp_double);
+    *prom = n ? s / n : 0;
+    *p95 = n ? v[(int)(n * 0.95) < n ? (int)(n * 0.95) : n - 1] : 0;
+    *max = n ? v[n - 1] : 0;
+}
+
+static void escenario_informar(double limite) {
+    double r_prom, r_p95, r_max, f_prom, f_p95, f_max, t_prom, t_p95, t_max;
+    stats(esc.render_ms, esc.n, &r_prom, &r_p95, &r_max);
+    stats(esc.flush_ms, esc.n, &f_prom, &f_p95, &f_max);
+    stats(esc.total_ms, esc.n, &t_prom, &t_p95, &t_max);
+    double px_frame = esc.n ? esc.px / esc.n : 0;
+
+    printf("[BENCH] %-11s %5d frames | render %6.2f / %6.2f / %6.2f ms | flush %5.2f / %5.2f / %5.2f ms | %7.0f px/frame (%4.1f%%, %6.1f KB)\n",
+           esc.nombre, esc.n, r_prom, r_p95, r_max, f_prom, f_p95, f_max,
+           px_frame, 100.0 * px_frame / (HAL_HOR_RES * HAL_VER_RES),
+           px_frame * sizeof(lv_color_t) / 1024.0);
+    HeapStats h;
+    heap_stats(&h);
+    printf("[BENCH] %-11s heap: %.1f allocs/frame, usado %zu KB, pico %zu KB, frag %d%%\n",
+           "", esc.n ? (double)esc.allocs / esc.n : 0.0, h.usado / 1024, h.pico / 1024, h.frag_pct);
+    if (limite > 0 && t_p95 > limite) {
+        printf("[BENCH] FALLA: %s p95 %.2f ms > %.2f ms\n", esc.nombre, t_p95, limite);
+        fallas++;
+    }
+}
+
+// --------------------------------------------------------------------------
+// Escenarios
+// --------------------------------------------------------------------------
+static void tocar(lv_obj_t *obj) {
+    lv_area_t a;
+    lv_obj_get_coords(obj, &a);
+    lv_coord_t x = (a.x1 + a.x2) / 2, y = (a.y1 + a.y2) / 2;
+    HalPaso pasos[] = {
+        { x, y, 0, BENCH_FRAME_MS },
+        { x, y, 1, 3 * BENCH_FRAME_MS },
+        { x, y, 0, BENCH_FRAME_MS },
+    };
+    hal_guion_cargar(pasos, 3);
+    while (!hal_guion_terminado()) frame();
+}
+
+static void esperar(int frames) {
+    for (int i = 0; i < frames; i++) frame();
+}
+
+// Ida y vuelta a tareas con toques reales (indev) y a flota por el gestor
+static void escenario_pantallas(int frames) {
+    escenario_empezar("pantallas");
+    while (esc.n < frames) {
+        tocar(ui_agregarTareas);
+        if (lv_scr_act() != ui_seleccionarTarea) {
+            printf("[BENCH] FALLA: el toque en 'agregar tarea' no cambió de pantalla\n");
+            fallas++;
+            return;
+        }
+        esperar(3);
+        tocar(ui_btnAtras);
+        esperar(8);         // Fundido de 200 ms
+        ui_pantalla_ir(PANTALLA_FLOTA, LV_SCR_LOAD_ANIM_NONE, 0);
+        esperar(3);
+        ui_pantalla_ir(PANTALLA_MAIN, LV_SCR_LOAD_ANIM_FADE_ON, 200);
+        esperar(8);
+    }
+}
+
+static void escenario_consola(int frames) {
+    ui_pantalla_ir(PANTALLA_MAIN, LV_SCR_LOAD_ANIM_NONE, 0);
+    escenario_empezar("consola");
+    char linea[64];
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < BENCH_LINEAS_FRAME; i++) {
+            int maquina = 1 + (i % BENCH_MAQUINAS);
+            snprintf(linea, sizeof(linea), "M%d > G1 X%d.%03d Y%d F1500", maquina, f, i, i);
+            ui_log(maquina, (i % 50) ? LOG_INFO : LOG_AVISO, linea);
+        }
+        ui_consola_refrescar();
+        frame();
+    }
+}
+
+static void mover_maquinas(int f) {
+    pthread_mutex_lock(&state_mutex);
+    for (int id = 1; id <= BENCH_MAQUINAS; id++) {
+        MaquinaData *m = &global_state.maquinas[id - 1];
+        if (!m->activa) {
+            m->id = id;
+            m->activa = 1;
+            snprintf(m->ip, sizeof(m->ip), "10.0.0.%d", id);
+            global_state.lista_cambio = 1;
+        }
+        snprintf(m->estado, sizeof(m->estado), (f / 60 + id) % 7 ? "Run" : "Hold:0");
+        m->pos_x = 100.0f + id + f * 0.05f;
+        m->pos_y = 50.0f - f * 0.03f;
+        m->pos_z = -2.0f;
+        m->linea = f * 3;
+        m->version++;
+    }
+    if (global_state.lista_cambio) {
+        ActualizarRollerMaquinas();
+        ui_flota_lista();
+        global_state.lista_cambio = 0;
+    }
+    pthread_mutex_unlock(&state_mutex);
+}
+
+// Como el loop de main.c: la seleccionada en ui_main y las tarjetas de flota
+static void escenario_telemetria(int frames, PantallaId pantalla, const char *nombre) {
+    ui_pantalla_ir(pantalla, LV_SCR_LOAD_ANIM_NONE, 0);
+    escenario_empezar(nombre);
+    maquina_activa_id = 1;
+    for (int f = 0; f < frames; f++) {
+        mover_maquinas(f);
+
+        MaquinaData vista;
+        pthread_mutex_lock(&state_mutex);
+        vista = global_state.maquinas[maquina_activa_id - 1];
+        pthread_mutex_unlock(&state_mutex);
+        ui_update_maquina(&vista);
+        ui_flota_refrescar();
+        ui_consola_refrescar();
+        frame();
+    }
+}
+
+int main(int argc, char **argv) {
+    int frames = 300;
+    double limite = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:l:")) != -1) {
+        if (opt == 'f') frames = atoi(optarg);
+        else if (opt == 'l') limite = atof(optarg);
+        else {
+            fprintf(stderr, "uso: %s [-f frames] [-l limite_p95_ms]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames < 1) frames = 1;
+    if (frames > BENCH_FRAMES_MAX) frames = BENCH_FRAMES_MAX;
+
+    pthread_mutex_init(&state_mutex, NULL);
+    memset(&global_state, 0, sizeof(SystemState));
+
+    lv_init();
+    hal_init(HAL_OFFSCREEN, 0);
+    ui_init();
+    ui_init_custom_label();
+    ui_flota_acceso_init();
+    InicializarListaMaquinas();
+    ui_consola_init();
+    ui_pantallas_init();
+    esperar(2);             // Primer dibujo completo, fuera de la medición
+
+    printf("[BENCH] %dx%d a %d bpp%s, frame de %d ms; render / flush: promedio / p95 / max\n",
+           HAL_HOR_RES, HAL_VER_RES, LV_COLOR_DEPTH,
+           (LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP) ? " (swap)" : "", BENCH_FRAME_MS);
+    escenario_pantallas(frames);
+    escenario_informar(limite);
+    escenario_consola(frames);
+    escenario_informar(limite);
+    escenario_telemetria(frames, PANTALLA_MAIN, "telem-main");
+    escenario_informar(limite);
+    escenario_telemetria(frames, PANTALLA_FLOTA, "telem-flota");
+    escenario_informar(limite);
+
+    return fallas ? 1 : 0;
+}
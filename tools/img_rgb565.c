@@ -0,0 +1,126 @@
+// Convierte una imagen exportada por SquareLine (C array de 32 bpp) al
+// formato de LVGL con LV_COLOR_DEPTH 16: TRUE_COLOR_ALPHA pasa de B,G,R,A a
+// RGB565 + A (3 bytes) y TRUE_COLOR de B,G,R,X a RGB565 (2 bytes). Lo usa
+// CMake con -DCNC_COLOR_16=ON; los .c de src/ui/images no se tocan.
+//   ./img_rgb565 entrada.c salida.c [--swap]
+// --swap: bytes del color invertidos (LV_COLOR_16_SWAP, paneles SPI).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BYTES_POR_LINEA 24
+
+static char *leer_todo(const char *ruta) {
+    FILE *f = fopen(ruta, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *s = malloc(n + 1);
+    if (s && fread(s, 1, n, f) != (size_t)n) {
+        free(s);
+        s = NULL;
+    }
+    if (s) s[n] = '\0';
+    fclose(f);
+    return s;
+}
+
+static int emitir(FILE *out, int *col, unsigned b) {
+    if (*col == 0) fputs("    ", out);
+    fprintf(out, "0x%02X,", b & 0xFF);
+    if (++*col == BYTES_POR_LINEA) {
+        fputc('\n', out);
+        *col = 0;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "uso: %s entrada.c salida.c [--swap]\n", argv[0]);
+        return 2;
+    }
+    int swap = (argc > 3 && strcmp(argv[3], "--swap") == 0);
+
+    char *src = leer_todo(argv[1]);
+    if (!src) {
+        fprintf(stderr, "[IMG] No se pudo leer %s\n", argv[1]);
+        return 1;
+    }
+
+    int alfa;
+    if (strstr(src, "LV_IMG_CF_TRUE_COLOR_ALPHA")) alfa = 1;
+    else if (strstr(src, "LV_IMG_CF_TRUE_COLOR,")) alfa = 0;
+    else {
+        fprintf(stderr, "[IMG] %s: formato no soportado (solo TRUE_COLOR de 32 bpp)\n", argv[1]);
+        return 1;
+    }
+
+    char *datos = strstr(src, "_data[] = {");
+    char *fin = datos ? strstr(datos, "};") : NULL;
+    if (!fin) {
+        fprintf(stderr, "[IMG] %s: no se encontró el arreglo de datos\n", argv[1]);
+        return 1;
+    }
+    datos = strchr(datos, '{') + 1;
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "[IMG] No se pudo escribir %s\n", argv[2]);
+        return 1;
+    }
+
+    // Encabezado: el .c generado vive fuera de src/ui/images
+    const char *nombre = strrchr(argv[1], '/');
+    fprintf(out, "// Generado por tools/img_rgb565 desde %s: no editar\n", nombre ? nombre + 1 : argv[1]);
+    for (char *p = src; p < datos; ) {
+        char *nl = strchr(p, '\n');
+        size_t len = (nl && nl < datos) ? (size_t)(nl - p + 1) : (size_t)(datos - p);
+        if (strncmp(p, "#include \"../ui.h\"", 18) == 0) fputs("#include \"ui.h\"\n", out);
+        else fwrite(p, 1, len, out);
+        p += len;
+    }
+    fputc('\n', out);
+
+    unsigned px[4];
+    int k = 0, col = 0;
+    long pixeles = 0;
+    for (char *p = datos; p < fin; ) {
+        char *sig;
+        unsigned long v = strtoul(p, &sig, 16);
+        if (sig == p) {
+            p++;
+            continue;
+        }
+        p = sig;
+        px[k++] = (unsigned)v;
+        if (k < 4) continue;
+        k = 0;
+
+        unsigned b = px[0], g = px[1], r = px[2];
+        unsigned c = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+        if (swap) {
+            emitir(out, &col, c >> 8);
+            emitir(out, &col, c);
+        } else {
+            emitir(out, &col, c);
+            emitir(out, &col, c >> 8);
+        }
+        if (alfa) emitir(out, &col, px[3]);
+        pixeles++;
+    }
+    if (k != 0) {
+        fprintf(stderr, "[IMG] %s: el arreglo no es múltiplo de 4 bytes\n", argv[1]);
+        fclose(out);
+        return 1;
+    }
+    if (col) fputc('\n', out);
+    fputs(fin, out);
+    fclose(out);
+
+    printf("[IMG] %s: %ld px -> RGB565%s%s\n", argv[2], pixeles, alfa ? "+A" : "", swap ? " (swap)" : "");
+    free(src);
+    return 0;
+}